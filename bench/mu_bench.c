@@ -0,0 +1,101 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_bench.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// =============================================================================
+// private types and definitions
+
+#define LINE_LENGTH 128
+
+typedef struct {
+  mu_bench_counter_fn counter;
+  const char *unit;
+  mu_bench_output_fn output;
+} mu_bench_t;
+
+// =============================================================================
+// private declarations
+
+// =============================================================================
+// local storage
+
+static mu_bench_t s_bench;
+
+// =============================================================================
+// public code
+
+void mu_bench_init(mu_bench_counter_fn counter,
+                   const char *unit,
+                   mu_bench_output_fn output) {
+  s_bench.counter = counter;
+  s_bench.unit = unit;
+  s_bench.output = output;
+}
+
+uint32_t mu_bench_run(const char *name,
+                      size_t n,
+                      size_t ops,
+                      mu_bench_setup_fn setup,
+                      mu_bench_body_fn body) {
+  uint32_t best = UINT32_MAX;
+
+  for (int i = 0; i < MU_BENCH_REPEATS; i++) {
+    if (setup != NULL) {
+      setup(n);
+    }
+    uint32_t start = s_bench.counter();
+    body(n);
+    uint32_t elapsed = s_bench.counter() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  mu_bench_report(name, n, ops, best);
+  return best;
+}
+
+void mu_bench_report(const char *name, size_t n, size_t ops, uint32_t ticks) {
+  char line[LINE_LENGTH];
+
+  snprintf(line,
+           sizeof(line),
+           "{\"bench\":\"%s\",\"n\":%lu,\"ops\":%lu,\"ticks\":%lu,"
+           "\"unit\":\"%s\"}",
+           name,
+           (unsigned long)n,
+           (unsigned long)ops,
+           (unsigned long)ticks,
+           s_bench.unit);
+  s_bench.output(line);
+}
+
+// =============================================================================
+// private code
@@ -0,0 +1,128 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Minimal benchmark harness for mulib hot paths.
+ *
+ * The harness is driven by a pluggable tick counter, so the same benchmarks
+ * run on a host (with a nanosecond clock) and on a target (with a cycle
+ * counter such as the Cortex-M DWT_CYCCNT).  Each benchmark is run
+ * MU_BENCH_REPEATS times and the fastest run is reported, one result per line
+ * in JSON Lines form, e.g.:
+ *
+ *     {"bench":"cirq_write_read_8","n":255,"ops":16320,"ticks":40211,"unit":"ns"}
+ *
+ * so results can be collected from a serial console and compared between
+ * releases with a few lines of script.
+ */
+
+#ifndef _MU_BENCH_H_
+#define _MU_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+#ifndef MU_BENCH_REPEATS
+#define MU_BENCH_REPEATS 5
+#endif
+
+/**
+ * @brief Return a free-running tick count.  Differences are taken modulo 2^32,
+ * so a single benchmark run must complete within one counter period.
+ */
+typedef uint32_t (*mu_bench_counter_fn)(void);
+
+/**
+ * @brief Emit one line of output (without a trailing newline).
+ */
+typedef void (*mu_bench_output_fn)(const char *line);
+
+/**
+ * @brief Prepare for a run.  Called before each timed repetition and not
+ * included in the timing.
+ */
+typedef void (*mu_bench_setup_fn)(size_t n);
+
+/**
+ * @brief The code being timed.
+ */
+typedef void (*mu_bench_body_fn)(size_t n);
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set up the harness.
+ *
+ * @param counter The tick source.
+ * @param unit The name of one tick as it should appear in results, e.g. "ns"
+ *        or "cycles".
+ * @param output Where results are written.
+ */
+void mu_bench_init(mu_bench_counter_fn counter,
+                   const char *unit,
+                   mu_bench_output_fn output);
+
+/**
+ * @brief Time body MU_BENCH_REPEATS times and report the fastest run.
+ *
+ * @param name The benchmark name.
+ * @param n The problem size, passed to setup and body.
+ * @param ops The number of operations body performs, so that ticks per
+ *        operation can be derived from the result.
+ * @param setup Untimed preparation before each run, or NULL.
+ * @param body The code to time.
+ * @return The fastest run in ticks.
+ */
+uint32_t mu_bench_run(const char *name,
+                      size_t n,
+                      size_t ops,
+                      mu_bench_setup_fn setup,
+                      mu_bench_body_fn body);
+
+/**
+ * @brief Emit a result in the harness's output format.
+ */
+void mu_bench_report(const char *name, size_t n, size_t ops, uint32_t ticks);
+
+/**
+ * @brief Run every benchmark in the suite (see mu_bench_suite.c).
+ */
+void mu_bench_run_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_BENCH_H_
@@ -0,0 +1,329 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief The mulib benchmark suite.  See mu_bench.h for the output format.
+ */
+
+// Host build: with the host port that provides mu_config.h, mu_time.h and
+// mu_platform.h on the include path, e.g.
+//
+//     cc -O2 -DMU_BENCH_HOST -I. -Icore -I<port> -o mu_bench
+//        bench/*.c core/*.c extras/*.c mulib.c <port>/*.c
+//     ./mu_bench > results.jsonl
+//
+// Target build: compile bench/mu_bench.c and bench/mu_bench_suite.c with the
+// application, then call mu_bench_init() with a cycle counter and an output
+// function (e.g. one that writes to a UART), followed by mu_bench_run_all().
+// Define MU_BENCH_MAX_TASKS to bound the RAM used by the scheduler
+// benchmarks.
+
+// =============================================================================
+// includes
+
+#include "mu_bench.h"
+#include "mulib.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef MU_BENCH_HOST
+#include <stdio.h>
+#include <time.h>
+#endif
+
+// =============================================================================
+// private types and definitions
+
+#ifndef MU_BENCH_MAX_TASKS
+#define MU_BENCH_MAX_TASKS 10000
+#endif
+
+#define QUEUE_ELEMENTS 256  // power of two, for mu_cirq and mu_spsc
+#define QUEUE_PASSES 64     // fill / drain cycles per queue benchmark
+#define SORT_MAX_ITEMS 1000
+#define BVEC_BITS 4096
+#define PRINTF_CALLS 100
+
+// =============================================================================
+// private declarations
+
+static void bench_sched(void);
+static void bench_queues(void);
+static void bench_sort(void);
+static void bench_bvec(void);
+static void bench_printf(void);
+
+static uint32_t next_random(void);
+static mu_time_t bench_clock(void);
+static void null_task_fn(void *ctx, void *arg);
+static int compare_ints(void *e1, void *e2);
+static int compare_items(void *item1, void *item2);
+
+static void sched_setup(size_t n);
+static void sched_task_in_body(size_t n);
+static void sched_step_setup(size_t n);
+static void sched_step_body(size_t n);
+static void cirq_body(size_t n);
+static void spsc_body(size_t n);
+static void spsc_n_body(size_t n);
+static void sort_setup(size_t n);
+static void vect_sort_body(size_t n);
+static void pstore_sort_body(size_t n);
+static void bvec_setup(size_t n);
+static void bvec_count_body(size_t n);
+static void bvec_scan_body(size_t n);
+static void printf_body(size_t n);
+
+// =============================================================================
+// local storage
+
+static uint32_t s_random;
+
+static mu_sched_t s_sched;
+static mu_time_t s_now;
+static mu_task_t s_tasks[MU_BENCH_MAX_TASKS];
+
+static uint8_t s_bytes[QUEUE_ELEMENTS];      // data passed through s_cirq
+static uint8_t s_cirq_store[QUEUE_ELEMENTS]; // s_cirq backing store
+static mu_cirq_t s_cirq;
+static mu_spsc_item_t s_items[QUEUE_ELEMENTS];
+static mu_spsc_item_t s_spsc_store[QUEUE_ELEMENTS];
+static mu_spsc_t s_spsc;
+
+static int s_ints[SORT_MAX_ITEMS];
+static mu_vect_t s_vect;
+static mu_pstore_item_t s_pstore_items[SORT_MAX_ITEMS];
+static mu_pstore_t s_pstore;
+
+static mu_bvec_t s_bvec[BVEC_BITS / 8];
+
+static uint8_t s_text[64];
+
+// Results are accumulated here so the compiler cannot discard the work.
+static volatile size_t s_sink;
+
+// =============================================================================
+// public code
+
+void mu_bench_run_all(void) {
+  bench_sched();
+  bench_queues();
+  bench_sort();
+  bench_bvec();
+  bench_printf();
+}
+
+#ifdef MU_BENCH_HOST
+
+static uint32_t host_counter(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+static void host_output(const char *line) {
+  puts(line);
+}
+
+int main(void) {
+  mu_bench_init(host_counter, "ns", host_output);
+  mu_bench_run_all();
+  return 0;
+}
+
+#endif // #ifdef MU_BENCH_HOST
+
+// =============================================================================
+// private code
+
+static void bench_sched(void) {
+  for (size_t n = 10; n <= MU_BENCH_MAX_TASKS; n *= 10) {
+    mu_bench_run("sched_task_in", n, n, sched_setup, sched_task_in_body);
+    mu_bench_run("sched_step", n, n, sched_step_setup, sched_step_body);
+  }
+}
+
+static void bench_queues(void) {
+  size_t ops = (QUEUE_ELEMENTS - 1) * QUEUE_PASSES;
+
+  mu_cirq_init(&s_cirq, s_cirq_store, QUEUE_ELEMENTS);
+  mu_bench_run("cirq_write_read_8", QUEUE_ELEMENTS - 1, ops, NULL, cirq_body);
+  mu_spsc_init(&s_spsc, s_spsc_store, QUEUE_ELEMENTS);
+  mu_bench_run("spsc_put_get", QUEUE_ELEMENTS - 1, ops, NULL, spsc_body);
+  mu_bench_run("spsc_put_get_n", QUEUE_ELEMENTS - 1, ops, NULL, spsc_n_body);
+}
+
+static void bench_sort(void) {
+  for (size_t n = 10; n <= SORT_MAX_ITEMS; n *= 10) {
+    mu_bench_run("vect_sort", n, n, sort_setup, vect_sort_body);
+    mu_bench_run("pstore_sort", n, n, sort_setup, pstore_sort_body);
+  }
+}
+
+static void bench_bvec(void) {
+  mu_bench_run("bvec_count_ones", BVEC_BITS, BVEC_BITS, bvec_setup,
+                bvec_count_body);
+  mu_bench_run("bvec_find_next_one", BVEC_BITS, BVEC_BITS, bvec_setup,
+                bvec_scan_body);
+}
+
+static void bench_printf(void) {
+  mu_bench_run("str_printf", PRINTF_CALLS, PRINTF_CALLS, NULL, printf_body);
+}
+
+// Deterministic, so runs are comparable between builds.
+static uint32_t next_random(void) {
+  s_random = s_random * 1664525u + 1013904223u;
+  return s_random >> 8;
+}
+
+static mu_time_t bench_clock(void) { return s_now; }
+
+static void null_task_fn(void *ctx, void *arg) {
+  (void)ctx;
+  (void)arg;
+}
+
+static int compare_ints(void *e1, void *e2) {
+  int a = *(int *)e1;
+  int b = *(int *)e2;
+  return (a > b) - (a < b);
+}
+
+static int compare_items(void *item1, void *item2) {
+  uintptr_t a = (uintptr_t)item1;
+  uintptr_t b = (uintptr_t)item2;
+  return (a > b) - (a < b);
+}
+
+static void sched_setup(size_t n) {
+  mu_sched_inst_init(&s_sched);
+  mu_sched_inst_set_clock_source(&s_sched, bench_clock);
+  s_now = 0;
+  s_random = 1;
+  for (size_t i = 0; i < n; i++) {
+    mu_task_init(&s_tasks[i], null_task_fn, NULL, "bench");
+  }
+}
+
+static void sched_task_in_body(size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    mu_sched_inst_task_in(&s_sched, &s_tasks[i], next_random() % 1000);
+  }
+}
+
+static void sched_step_setup(size_t n) {
+  sched_setup(n);
+  sched_task_in_body(n);
+  s_now = 1000; // every task is now runnable
+}
+
+static void sched_step_body(size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    mu_sched_inst_step(&s_sched);
+  }
+}
+
+static void cirq_body(size_t n) {
+  for (int pass = 0; pass < QUEUE_PASSES; pass++) {
+    mu_cirq_write_8(&s_cirq, s_bytes, n);
+    s_sink += mu_cirq_read_8(&s_cirq, s_bytes, n);
+  }
+}
+
+static void spsc_body(size_t n) {
+  mu_spsc_item_t item = NULL;
+
+  for (int pass = 0; pass < QUEUE_PASSES; pass++) {
+    for (size_t i = 0; i < n; i++) {
+      mu_spsc_put(&s_spsc, item);
+    }
+    while (mu_spsc_get(&s_spsc, &item) == MU_SPSC_ERR_NONE) {
+      s_sink += 1;
+    }
+  }
+}
+
+static void spsc_n_body(size_t n) {
+  for (int pass = 0; pass < QUEUE_PASSES; pass++) {
+    mu_spsc_put_n(&s_spsc, s_items, n);
+    s_sink += mu_spsc_get_n(&s_spsc, s_items, n);
+  }
+}
+
+static void sort_setup(size_t n) {
+  s_random = 1;
+  mu_vect_init(&s_vect, s_ints, SORT_MAX_ITEMS, sizeof(int));
+  mu_pstore_init(&s_pstore, s_pstore_items, SORT_MAX_ITEMS);
+  for (size_t i = 0; i < n; i++) {
+    int v = (int)next_random();
+    mu_vect_push(&s_vect, &v);
+    mu_pstore_push(&s_pstore, (mu_pstore_item_t)(uintptr_t)v);
+  }
+}
+
+static void vect_sort_body(size_t n) {
+  (void)n;
+  mu_vect_sort(&s_vect, compare_ints);
+}
+
+static void pstore_sort_body(size_t n) {
+  (void)n;
+  mu_pstore_sort(&s_pstore, compare_items);
+}
+
+static void bvec_setup(size_t n) {
+  s_random = 1;
+  mu_bvec_clear_all(n, s_bvec);
+  // sparse: roughly one bit in 64 set
+  for (size_t i = 0; i < n / 64; i++) {
+    mu_bvec_set(next_random() % n, s_bvec);
+  }
+}
+
+static void bvec_count_body(size_t n) {
+  s_sink += mu_bvec_count_ones(n, s_bvec);
+}
+
+static void bvec_scan_body(size_t n) {
+  size_t i = mu_bvec_find_first_one(n, s_bvec);
+
+  while (i < n) {
+    s_sink += i;
+    i = mu_bvec_find_next_one(i + 1, n, s_bvec);
+  }
+}
+
+static void printf_body(size_t n) {
+  mu_strbuf_t buf;
+  mu_str_t str;
+
+  mu_strbuf_init_wr(&buf, s_text, sizeof(s_text));
+  for (size_t i = 0; i < n; i++) {
+    mu_str_init_for_write(&str, &buf);
+    s_sink += mu_str_printf(&str, "%d %s 0x%08x", (int)i, "bench", 0xdeadbeef);
+  }
+}
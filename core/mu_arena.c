@@ -0,0 +1,104 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_arena.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// private types and definitions
+
+// =============================================================================
+// private declarations
+
+#define IS_POWER_OF_TWO(n) (((n) & ((n)-1)) == 0)
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+mu_arena_t *mu_arena_init(mu_arena_t *arena, void *store, size_t capacity) {
+  arena->store = (uint8_t *)store;
+  arena->capacity = capacity;
+  arena->high_water = 0;
+  return mu_arena_reset(arena);
+}
+
+mu_arena_t *mu_arena_reset(mu_arena_t *arena) {
+  arena->used = 0;
+  return arena;
+}
+
+void *mu_arena_alloc(mu_arena_t *arena, size_t size) {
+  return mu_arena_alloc_aligned(arena, size, MU_ARENA_ALIGNMENT);
+}
+
+void *mu_arena_alloc_aligned(mu_arena_t *arena, size_t size, size_t alignment) {
+  if ((alignment == 0) || !IS_POWER_OF_TWO(alignment)) {
+    return NULL;
+  }
+  // Align the absolute address, not the offset, so the result is correctly
+  // aligned regardless of how the region itself is aligned.
+  uintptr_t base = (uintptr_t)arena->store;
+  uintptr_t next = base + arena->used;
+  size_t padding = (size_t)(-next & (alignment - 1));
+  size_t available = arena->capacity - arena->used;
+
+  if ((padding > available) || (size > available - padding)) {
+    return NULL;
+  }
+  void *p = arena->store + arena->used + padding;
+  arena->used += padding + size;
+  if (arena->used > arena->high_water) {
+    arena->high_water = arena->used;
+  }
+  return p;
+}
+
+mu_arena_mark_t mu_arena_mark(mu_arena_t *arena) { return arena->used; }
+
+mu_arena_t *mu_arena_rewind(mu_arena_t *arena, mu_arena_mark_t mark) {
+  if (mark < arena->used) {
+    arena->used = mark;
+  }
+  return arena;
+}
+
+size_t mu_arena_capacity(mu_arena_t *arena) { return arena->capacity; }
+
+size_t mu_arena_used(mu_arena_t *arena) { return arena->used; }
+
+size_t mu_arena_available(mu_arena_t *arena) {
+  return arena->capacity - arena->used;
+}
+
+size_t mu_arena_high_water(mu_arena_t *arena) { return arena->high_water; }
+
+// =============================================================================
+// private code
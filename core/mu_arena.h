@@ -0,0 +1,148 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Bump allocator with mark / rewind over a caller-supplied region.
+ *
+ * mu_arena hands out storage by advancing an offset into a fixed region, so
+ * allocation is a few arithmetic operations and there is no per-allocation
+ * bookkeeping.  Individual allocations are never freed; instead, the caller
+ * records a mark before a burst of related allocations (for example, all the
+ * scratch needed to parse one incoming frame) and rewinds to it afterwards,
+ * reclaiming everything allocated since the mark in constant time:
+ *
+ *     mu_arena_mark_t mark = mu_arena_mark(&s_scratch);
+ *     ... allocate mu_strbuf_t storage, temporary tables, etc ...
+ *     mu_arena_rewind(&s_scratch, mark);
+ *
+ * Marks nest naturally: rewinding to an outer mark also discards anything
+ * allocated after an inner one.  mu_arena_reset() rewinds to the start.
+ *
+ * mu_arena is not interrupt safe.
+ */
+
+#ifndef _MU_ARENA_H_
+#define _MU_ARENA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+/**
+ * @brief Alignment used by mu_arena_alloc().  Must be a power of two.
+ */
+#ifndef MU_ARENA_ALIGNMENT
+#define MU_ARENA_ALIGNMENT sizeof(void *)
+#endif
+
+typedef struct {
+  uint8_t *store;    // start of the caller-supplied region
+  size_t capacity;   // size of the region in bytes
+  size_t used;       // offset of the first unallocated byte
+  size_t high_water; // largest value of used since init
+} mu_arena_t;
+
+/**
+ * @brief An opaque position within an arena, as returned by mu_arena_mark().
+ */
+typedef size_t mu_arena_mark_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize an arena over a caller-supplied region.
+ */
+mu_arena_t *mu_arena_init(mu_arena_t *arena, void *store, size_t capacity);
+
+/**
+ * @brief Release every allocation made from the arena.
+ */
+mu_arena_t *mu_arena_reset(mu_arena_t *arena);
+
+/**
+ * @brief Allocate size bytes aligned to MU_ARENA_ALIGNMENT.
+ *
+ * @return A pointer to the storage, or NULL if the arena cannot satisfy the
+ *         request (in which case the arena is unchanged).
+ */
+void *mu_arena_alloc(mu_arena_t *arena, size_t size);
+
+/**
+ * @brief Allocate size bytes aligned to the given alignment.
+ *
+ * @param alignment A power of two.  Use 1 for byte buffers.
+ * @return A pointer to the storage, or NULL if the arena cannot satisfy the
+ *         request or alignment is not a power of two.
+ */
+void *mu_arena_alloc_aligned(mu_arena_t *arena, size_t size, size_t alignment);
+
+/**
+ * @brief Return a mark recording the arena's current position.
+ */
+mu_arena_mark_t mu_arena_mark(mu_arena_t *arena);
+
+/**
+ * @brief Release every allocation made since mark was taken.
+ *
+ * A mark that lies beyond the current position (i.e. one taken before an
+ * earlier rewind past it) is ignored.
+ */
+mu_arena_t *mu_arena_rewind(mu_arena_t *arena, mu_arena_mark_t mark);
+
+/**
+ * @brief Return the size of the arena's region in bytes.
+ */
+size_t mu_arena_capacity(mu_arena_t *arena);
+
+/**
+ * @brief Return the number of bytes currently allocated, including padding.
+ */
+size_t mu_arena_used(mu_arena_t *arena);
+
+/**
+ * @brief Return the number of bytes not yet allocated.
+ */
+size_t mu_arena_available(mu_arena_t *arena);
+
+/**
+ * @brief Return the largest number of bytes in use at any one time since the
+ * arena was initialized.
+ */
+size_t mu_arena_high_water(mu_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_ARENA_H_
@@ -0,0 +1,182 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_atomic.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// =============================================================================
+// private types and definitions
+
+// Keep the compiler from moving memory accesses across a load or store.
+#define COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+
+// =============================================================================
+// private declarations
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+#if (MU_ATOMIC_USE_CRITICAL_SECTION)
+
+uint8_t mu_atomic_load_u8(volatile uint8_t *p) {
+  uint8_t value = *p;
+  COMPILER_BARRIER();
+  return value;
+}
+
+void mu_atomic_store_u8(volatile uint8_t *p, uint8_t value) {
+  COMPILER_BARRIER();
+  *p = value;
+}
+
+uint16_t mu_atomic_load_u16(volatile uint16_t *p) {
+  uint16_t value = *p;
+  COMPILER_BARRIER();
+  return value;
+}
+
+void mu_atomic_store_u16(volatile uint16_t *p, uint16_t value) {
+  COMPILER_BARRIER();
+  *p = value;
+}
+
+bool mu_atomic_cas_u16(volatile uint16_t *p,
+                       uint16_t *expected,
+                       uint16_t desired) {
+  bool swapped;
+
+  MU_CRITICAL_ENTER();
+  if (*p == *expected) {
+    *p = desired;
+    swapped = true;
+  } else {
+    *expected = *p;
+    swapped = false;
+  }
+  MU_CRITICAL_EXIT();
+  return swapped;
+}
+
+bool mu_atomic_test_and_set(volatile uint8_t *flag) {
+  bool was_set;
+
+  MU_CRITICAL_ENTER();
+  was_set = (*flag != 0);
+  *flag = 1;
+  MU_CRITICAL_EXIT();
+  return was_set;
+}
+
+void mu_atomic_clear(volatile uint8_t *flag) {
+  COMPILER_BARRIER();
+  *flag = 0;
+}
+
+void mu_atomic_fence(void) {
+  // On a single core, interrupts see accesses in program order: only the
+  // compiler needs to be held back.
+  COMPILER_BARRIER();
+}
+
+uint32_t mu_atomic_load_u32(volatile uint32_t *p) {
+  uint32_t value = *p;
+  COMPILER_BARRIER();
+  return value;
+}
+
+void mu_atomic_store_u32(volatile uint32_t *p, uint32_t value) {
+  COMPILER_BARRIER();
+  *p = value;
+}
+
+uint32_t mu_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t value) {
+  uint32_t prev;
+
+  MU_CRITICAL_ENTER();
+  prev = *p;
+  *p = prev + value;
+  MU_CRITICAL_EXIT();
+  return prev;
+}
+
+#else
+
+uint8_t mu_atomic_load_u8(volatile uint8_t *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void mu_atomic_store_u8(volatile uint8_t *p, uint8_t value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+uint16_t mu_atomic_load_u16(volatile uint16_t *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void mu_atomic_store_u16(volatile uint16_t *p, uint16_t value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+bool mu_atomic_cas_u16(volatile uint16_t *p,
+                       uint16_t *expected,
+                       uint16_t desired) {
+  return __atomic_compare_exchange_n(
+      p, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+bool mu_atomic_test_and_set(volatile uint8_t *flag) {
+  return __atomic_test_and_set(flag, __ATOMIC_ACQ_REL);
+}
+
+void mu_atomic_clear(volatile uint8_t *flag) {
+  __atomic_clear(flag, __ATOMIC_RELEASE);
+}
+
+void mu_atomic_fence(void) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+uint32_t mu_atomic_load_u32(volatile uint32_t *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void mu_atomic_store_u32(volatile uint32_t *p, uint32_t value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+uint32_t mu_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t value) {
+  return __atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+}
+
+#endif // #if (MU_ATOMIC_USE_CRITICAL_SECTION)
+
+// =============================================================================
+// private code
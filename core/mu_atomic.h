@@ -0,0 +1,124 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file Minimal atomic operations for lock-free queues.
+ *
+ * By default these map onto the compiler's __atomic builtins, which compile to
+ * LDREX/STREX loops (or equivalent) on targets that have them.  On targets
+ * without exclusive access instructions (e.g. Cortex-M0), define
+ * MU_ATOMIC_USE_CRITICAL_SECTION as 1 in mu_config.h: each operation is then
+ * performed between MU_CRITICAL_ENTER() and MU_CRITICAL_EXIT().
+ */
+
+#ifndef _MU_ATOMIC_H_
+#define _MU_ATOMIC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+#ifndef MU_ATOMIC_USE_CRITICAL_SECTION
+#define MU_ATOMIC_USE_CRITICAL_SECTION 0
+#endif
+
+// MU_CRITICAL_ENTER() and MU_CRITICAL_EXIT() bracket code that must not be
+// interrupted, typically by saving and disabling interrupts.  A port defines
+// them in mu_config.h.  The defaults do nothing, which is only correct when
+// there is a single execution context (e.g. host builds).
+#ifndef MU_CRITICAL_ENTER
+#define MU_CRITICAL_ENTER() do {} while (0)
+#endif
+
+#ifndef MU_CRITICAL_EXIT
+#define MU_CRITICAL_EXIT() do {} while (0)
+#endif
+
+// =============================================================================
+// declarations
+
+uint8_t mu_atomic_load_u8(volatile uint8_t *p);
+
+void mu_atomic_store_u8(volatile uint8_t *p, uint8_t value);
+
+/**
+ * @brief Read *p with acquire semantics: later accesses are not moved before
+ * the read.
+ */
+uint16_t mu_atomic_load_u16(volatile uint16_t *p);
+
+/**
+ * @brief Write *p with release semantics: earlier accesses are not moved after
+ * the write.
+ */
+void mu_atomic_store_u16(volatile uint16_t *p, uint16_t value);
+
+/**
+ * @brief If *p equals *expected, set *p to desired and return true.
+ * Otherwise copy the current value of *p to *expected and return false.
+ */
+bool mu_atomic_cas_u16(volatile uint16_t *p,
+                       uint16_t *expected,
+                       uint16_t desired);
+
+/**
+ * @brief Set *flag and return true if it was already set.
+ */
+bool mu_atomic_test_and_set(volatile uint8_t *flag);
+
+/**
+ * @brief Clear *flag (with release semantics).
+ */
+void mu_atomic_clear(volatile uint8_t *flag);
+
+/**
+ * @brief Full memory barrier: no access is moved across the fence in either
+ * direction.
+ */
+void mu_atomic_fence(void);
+
+uint32_t mu_atomic_load_u32(volatile uint32_t *p);
+
+void mu_atomic_store_u32(volatile uint32_t *p, uint32_t value);
+
+/**
+ * @brief Add value to *p, returning the previous value of *p.
+ */
+uint32_t mu_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_ATOMIC_H_
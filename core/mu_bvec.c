@@ -34,6 +34,34 @@
 // =============================================================================
 // local types and definitions
 
+// Bulk operations (counting, searching, testing) work a machine word at a time
+// on the aligned middle of a vector and a byte at a time on the unaligned head
+// and tail.  Results are identical to a byte-at-a-time scan.
+typedef unsigned long word_t;
+
+#define WORD_BYTES sizeof(word_t)
+
+#define IS_WORD_ALIGNED(_p) (((uintptr_t)(_p) & (WORD_BYTES - 1)) == 0)
+
+// Use compiler builtins for population count and count trailing zeros where
+// available (these map onto POPCNT, RBIT + CLZ etc. where the target has them).
+#ifndef MU_BVEC_USE_BUILTINS
+#if defined(__GNUC__)
+#define MU_BVEC_USE_BUILTINS 1
+#else
+#define MU_BVEC_USE_BUILTINS 0
+#endif
+#endif
+
+// Bit 0 of a vector is bit 0 of byte 0.  On a big-endian target, a word loaded
+// from memory must be byte swapped so that bit n of the word is bit n of the
+// vector; on a little-endian target this is a no-op.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define WORD_TO_LE(_w) word_swap_bytes(_w)
+#else
+#define WORD_TO_LE(_w) (_w)
+#endif
+
 // =============================================================================
 // local (forward) declarations
 
@@ -49,6 +77,42 @@ static uint8_t count_one_bits(uint8_t v);
  */
 static uint8_t find_first_one(uint8_t v);
 
+/**
+ * @brief Return the index of the first bit at or after from (and before
+ * bit_count) whose value is one after being xor'd with flip, or SIZE_MAX if
+ * none.  flip is 0x00 to search for a one, 0xff to search for a zero.
+ */
+static size_t find_next(size_t from,
+                        size_t bit_count,
+                        const mu_bvec_t *store,
+                        uint8_t flip);
+
+/**
+ * @brief Set (value = true) or clear the bits from index `from` up to but not
+ * including index `to`.
+ */
+static void write_range(size_t from, size_t to, mu_bvec_t *store, bool value);
+
+/**
+ * @brief Load an aligned word from the store.
+ */
+static word_t load_word(const mu_bvec_t *p);
+
+/**
+ * @brief Return the number of one bits in the word w.
+ */
+static size_t word_count_ones(word_t w);
+
+/**
+ * @brief Return the index of the lowest one bit in w, which must be non-zero
+ * and in vector (little-endian) bit order.
+ */
+static size_t word_find_first_one(word_t w);
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+static word_t word_swap_bytes(word_t w);
+#endif
+
 // =============================================================================
 // local storage
 
@@ -130,10 +194,21 @@ bool mu_bvec_read(size_t bit_index, mu_bvec_t *store) {
 
 // Queries for bit vectors
 bool mu_bvec_is_all_ones(size_t bit_count, mu_bvec_t *store) {
-  size_t byte_index;
-  size_t bits_remain;
-  for (byte_index = 0, bits_remain = bit_count; bits_remain >= 8;
-       byte_index += 1, bits_remain -= 8) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t bits_remain = bit_count & 0x07;
+  size_t byte_index = 0;
+
+  while ((byte_index < byte_count) && !IS_WORD_ALIGNED(&store[byte_index])) {
+    if (store[byte_index++] != 0xff) {
+      return false;
+    }
+  }
+  for (; byte_index + WORD_BYTES <= byte_count; byte_index += WORD_BYTES) {
+    if (load_word(&store[byte_index]) != (word_t)~0UL) {
+      return false;
+    }
+  }
+  for (; byte_index < byte_count; byte_index++) {
     if (store[byte_index] != 0xff) {
       return false;
     }
@@ -148,10 +223,21 @@ bool mu_bvec_is_all_ones(size_t bit_count, mu_bvec_t *store) {
 }
 
 bool mu_bvec_is_all_zeros(size_t bit_count, mu_bvec_t *store) {
-  size_t byte_index;
-  size_t bits_remain;
-  for (byte_index = 0, bits_remain = bit_count; bits_remain >= 8;
-       byte_index += 1, bits_remain -= 8) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t bits_remain = bit_count & 0x07;
+  size_t byte_index = 0;
+
+  while ((byte_index < byte_count) && !IS_WORD_ALIGNED(&store[byte_index])) {
+    if (store[byte_index++] != 0x00) {
+      return false;
+    }
+  }
+  for (; byte_index + WORD_BYTES <= byte_count; byte_index += WORD_BYTES) {
+    if (load_word(&store[byte_index]) != 0) {
+      return false;
+    }
+  }
+  for (; byte_index < byte_count; byte_index++) {
     if (store[byte_index] != 0x00) {
       return false;
     }
@@ -167,10 +253,17 @@ bool mu_bvec_is_all_zeros(size_t bit_count, mu_bvec_t *store) {
 
 size_t mu_bvec_count_ones(size_t bit_count, mu_bvec_t *store) {
   size_t count = 0;
-  size_t byte_index;
-  size_t bits_remain;
-  for (byte_index = 0, bits_remain = bit_count; bits_remain >= 8;
-       byte_index += 1, bits_remain -= 8) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t bits_remain = bit_count & 0x07;
+  size_t byte_index = 0;
+
+  while ((byte_index < byte_count) && !IS_WORD_ALIGNED(&store[byte_index])) {
+    count += count_one_bits(store[byte_index++]);
+  }
+  for (; byte_index + WORD_BYTES <= byte_count; byte_index += WORD_BYTES) {
+    count += word_count_ones(load_word(&store[byte_index]));
+  }
+  for (; byte_index < byte_count; byte_index++) {
     count += count_one_bits(store[byte_index]);
   }
   // 0 <= bits_remain < 8
@@ -187,55 +280,40 @@ size_t mu_bvec_count_zeros(size_t bit_count, mu_bvec_t *store) {
 
 // Returns SIZE_MAX if not found
 size_t mu_bvec_find_first_one(size_t bit_count, mu_bvec_t *store) {
-  size_t position = 0;
-  size_t byte_index;
-  size_t bits_remain;
-  for (byte_index = 0, bits_remain = bit_count; bits_remain >= 8;
-       byte_index += 1, bits_remain -= 8) {
-    uint8_t v = store[byte_index];
-    uint8_t p = find_first_one(v);
-    // p = 8 if no one bit found
-    position += p;
-    if (p != 8) {
-      return position;
-    }
-  }
-  // 0 <= bits_remain < 8
-  if (bits_remain > 0) {
-    uint8_t rmask = s_byte_rmasks[bits_remain];
-    uint8_t v = store[byte_index] & rmask;
-    uint8_t p = find_first_one(v & rmask);
-    position += p;
-    if (p != 8) {
-      return position;
-    }
-  }
-  return SIZE_MAX;
+  return find_next(0, bit_count, store, 0x00);
 }
 
 size_t mu_bvec_find_first_zero(size_t bit_count, mu_bvec_t *store) {
-  size_t position = 0;
-  size_t byte_index;
-  size_t bits_remain;
-  for (byte_index = 0, bits_remain = bit_count; bits_remain >= 8;
-       byte_index += 1, bits_remain -= 8) {
-    uint8_t v = store[byte_index];
-    uint8_t p = find_first_one(~v);
-    // p = 8 if no one bit found
-    position += p;
-    if (p != 8) {
-      return position;
-    }
+  return find_next(0, bit_count, store, 0xff);
+}
+
+size_t mu_bvec_find_next_one(size_t from, size_t bit_count, mu_bvec_t *store) {
+  return find_next(from, bit_count, store, 0x00);
+}
+
+size_t mu_bvec_find_next_zero(size_t from, size_t bit_count, mu_bvec_t *store) {
+  return find_next(from, bit_count, store, 0xff);
+}
+
+size_t mu_bvec_find_first_zero_run(size_t run_length,
+                                   size_t bit_count,
+                                   mu_bvec_t *store) {
+  size_t from = 0;
+  size_t start;
+
+  if (run_length == 0) {
+    return 0;
   }
-  // 0 <= bits_remain < 8
-  if (bits_remain > 0) {
-    uint8_t rmask = s_byte_rmasks[bits_remain];
-    uint8_t v = store[byte_index] & rmask;
-    uint8_t p = find_first_one(~v & rmask);
-    position += p;
-    if (p != 8) {
-      return position;
+  while ((start = find_next(from, bit_count, store, 0xff)) != SIZE_MAX) {
+    if (start + run_length > bit_count) {
+      break; // not enough bits left for a run of this length
+    }
+    // look for a one bit that interrupts the run
+    size_t stop = find_next(start, start + run_length, store, 0x00);
+    if (stop == SIZE_MAX) {
+      return start;
     }
+    from = stop + 1;
   }
   return SIZE_MAX;
 }
@@ -245,14 +323,18 @@ void mu_bvec_set_all(size_t bit_count, mu_bvec_t *store) {
   size_t byte_count = mu_bvec_byte_index(bit_count);
   size_t remainder = bit_count & 0x07;
   memset(store, 0xff, byte_count);
-  store[byte_count] |= s_byte_rmasks[remainder];
+  if (remainder > 0) {
+    store[byte_count] |= s_byte_rmasks[remainder];
+  }
 }
 
 void mu_bvec_clear_all(size_t bit_count, mu_bvec_t *store) {
   size_t byte_count = mu_bvec_byte_index(bit_count);
   size_t remainder = bit_count & 0x07;
   memset(store, 0, byte_count);
-  store[byte_count] &= ~s_byte_rmasks[remainder];
+  if (remainder > 0) {
+    store[byte_count] &= ~s_byte_rmasks[remainder];
+  }
 }
 
 void mu_bvec_invert_all(size_t bit_count, mu_bvec_t *store) {
@@ -277,6 +359,61 @@ void mu_bvec_write_all(size_t bit_count, mu_bvec_t *store, bool value) {
   }
 }
 
+// modify a range of bits in a bit vector
+void mu_bvec_set_range(size_t from, size_t to, mu_bvec_t *store) {
+  write_range(from, to, store, true);
+}
+
+void mu_bvec_clear_range(size_t from, size_t to, mu_bvec_t *store) {
+  write_range(from, to, store, false);
+}
+
+// combine two bit vectors.  These are written as simple loops over the bytes
+// so that the compiler can vectorize them.
+void mu_bvec_and(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t remainder = bit_count & 0x07;
+  for (size_t i = 0; i < byte_count; i++) {
+    dst[i] &= src[i];
+  }
+  if (remainder > 0) {
+    dst[byte_count] &= src[byte_count] | ~s_byte_rmasks[remainder];
+  }
+}
+
+void mu_bvec_or(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t remainder = bit_count & 0x07;
+  for (size_t i = 0; i < byte_count; i++) {
+    dst[i] |= src[i];
+  }
+  if (remainder > 0) {
+    dst[byte_count] |= src[byte_count] & s_byte_rmasks[remainder];
+  }
+}
+
+void mu_bvec_xor(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t remainder = bit_count & 0x07;
+  for (size_t i = 0; i < byte_count; i++) {
+    dst[i] ^= src[i];
+  }
+  if (remainder > 0) {
+    dst[byte_count] ^= src[byte_count] & s_byte_rmasks[remainder];
+  }
+}
+
+void mu_bvec_andnot(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t remainder = bit_count & 0x07;
+  for (size_t i = 0; i < byte_count; i++) {
+    dst[i] &= ~src[i];
+  }
+  if (remainder > 0) {
+    dst[byte_count] &= ~(src[byte_count] & s_byte_rmasks[remainder]);
+  }
+}
+
 // =============================================================================
 // local (static) code
 
@@ -308,6 +445,7 @@ static uint8_t find_first_one(uint8_t v) {
     return 8;
   } else {
     uint8_t c = 7;
+    v &= -v; // isolate the lowest one bit so the masks below see only it
     if (v & 0x0f) {
       c -= 4;
     }
@@ -320,3 +458,127 @@ static uint8_t find_first_one(uint8_t v) {
     return c;
   }
 }
+
+static size_t find_next(size_t from,
+                        size_t bit_count,
+                        const mu_bvec_t *store,
+                        uint8_t flip) {
+  size_t byte_count = mu_bvec_byte_index(bit_count);
+  size_t bits_remain = bit_count & 0x07;
+  size_t byte_index = mu_bvec_byte_index(from);
+  word_t word_flip = flip ? (word_t)~0UL : 0;
+  uint8_t v;
+
+  if (from >= bit_count) {
+    return SIZE_MAX;
+  }
+  // first byte: ignore the bits below from
+  v = (store[byte_index] ^ flip) & ~s_byte_rmasks[from & 0x07];
+  if (byte_index == byte_count) {
+    // ...and beyond bit_count
+    v &= s_byte_rmasks[bits_remain];
+  }
+  if (v != 0) {
+    return byte_index * 8 + find_first_one(v);
+  }
+  byte_index += 1;
+
+  while ((byte_index < byte_count) && !IS_WORD_ALIGNED(&store[byte_index])) {
+    v = store[byte_index] ^ flip;
+    if (v != 0) {
+      return byte_index * 8 + find_first_one(v);
+    }
+    byte_index += 1;
+  }
+  for (; byte_index + WORD_BYTES <= byte_count; byte_index += WORD_BYTES) {
+    word_t w = load_word(&store[byte_index]) ^ word_flip;
+    if (w != 0) {
+      return byte_index * 8 + word_find_first_one(WORD_TO_LE(w));
+    }
+  }
+  for (; byte_index < byte_count; byte_index++) {
+    v = store[byte_index] ^ flip;
+    if (v != 0) {
+      return byte_index * 8 + find_first_one(v);
+    }
+  }
+  // 0 <= bits_remain < 8
+  if ((bits_remain > 0) && (byte_index == byte_count)) {
+    v = (store[byte_index] ^ flip) & s_byte_rmasks[bits_remain];
+    if (v != 0) {
+      return byte_index * 8 + find_first_one(v);
+    }
+  }
+  return SIZE_MAX;
+}
+
+static void write_range(size_t from, size_t to, mu_bvec_t *store, bool value) {
+  if (from >= to) {
+    return;
+  }
+  size_t first_byte = mu_bvec_byte_index(from);
+  size_t last_byte = mu_bvec_byte_index(to); // byte holding bit `to`
+  // bits at and above from in the first byte, below to in the last byte
+  uint8_t first_mask = ~s_byte_rmasks[from & 0x07];
+  uint8_t last_mask = s_byte_rmasks[to & 0x07];
+
+  if (first_byte == last_byte) {
+    mu_bvec_write_(first_byte, first_mask & last_mask, store, value);
+    return;
+  }
+  mu_bvec_write_(first_byte, first_mask, store, value);
+  memset(&store[first_byte + 1], value ? 0xff : 0x00, last_byte - first_byte - 1);
+  if (last_mask != 0) {
+    mu_bvec_write_(last_byte, last_mask, store, value);
+  }
+}
+
+static word_t load_word(const mu_bvec_t *p) {
+  word_t w;
+  // memcpy sidesteps strict aliasing; it compiles to a single load.
+  memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+#if (MU_BVEC_USE_BUILTINS)
+
+static size_t word_count_ones(word_t w) {
+  return __builtin_popcountl(w);
+}
+
+static size_t word_find_first_one(word_t w) {
+  return __builtin_ctzl(w);
+}
+
+#else
+
+static size_t word_count_ones(word_t w) {
+  size_t count = 0;
+  while (w != 0) {
+    count += count_one_bits((uint8_t)w);
+    w >>= 8;
+  }
+  return count;
+}
+
+static size_t word_find_first_one(word_t w) {
+  size_t position = 0;
+  while ((w & 0xff) == 0) {
+    w >>= 8;
+    position += 8;
+  }
+  return position + find_first_one((uint8_t)w);
+}
+
+#endif // #if (MU_BVEC_USE_BUILTINS)
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+static word_t word_swap_bytes(word_t w) {
+  word_t swapped = 0;
+  for (size_t i = 0; i < WORD_BYTES; i++) {
+    swapped = (swapped << 8) | (w & 0xff);
+    w >>= 8;
+  }
+  return swapped;
+}
+#endif
@@ -86,6 +86,23 @@ size_t mu_bvec_count_zeros(size_t bit_count, mu_bvec_t *store);
 // Returns SIZE_MAX if not found
 size_t mu_bvec_find_first_one(size_t bit_count, mu_bvec_t *store);
 size_t mu_bvec_find_first_zero(size_t bit_count, mu_bvec_t *store);
+
+// Find the first one (or zero) bit at or after index from.  To visit each one
+// bit in turn:
+//
+//    for (size_t i = mu_bvec_find_next_one(0, n, v); i != SIZE_MAX;
+//         i = mu_bvec_find_next_one(i + 1, n, v)) { ... }
+//
+// Returns SIZE_MAX if not found
+size_t mu_bvec_find_next_one(size_t from, size_t bit_count, mu_bvec_t *store);
+size_t mu_bvec_find_next_zero(size_t from, size_t bit_count, mu_bvec_t *store);
+
+// Return the index of the first run of run_length contiguous zero bits, e.g.
+// to allocate run_length consecutive blocks from an allocation map.
+// Returns SIZE_MAX if not found
+size_t mu_bvec_find_first_zero_run(size_t run_length,
+                                   size_t bit_count,
+                                   mu_bvec_t *store);
 // size_t mu_bvec_find_last_one(size_t bit_count, mu_bvec_t *store);
 // size_t mu_bvec_find_last_zero(size_t bit_count, mu_bvec_t *store);
 
@@ -95,9 +112,20 @@ void mu_bvec_clear_all(size_t bit_count, mu_bvec_t *store);
 void mu_bvec_invert_all(size_t bit_count, mu_bvec_t *store);
 void mu_bvec_write_all(size_t bit_count, mu_bvec_t *store, bool value);
 
+// modify the bits from index `from` up to (but not including) index `to`
+void mu_bvec_set_range(size_t from, size_t to, mu_bvec_t *store);
+void mu_bvec_clear_range(size_t from, size_t to, mu_bvec_t *store);
+
+// combine bit vectors of the same length: dst = dst <op> src.  andnot clears
+// the bits of dst that are set in src.  Bits of dst beyond bit_count are not
+// modified.  dst and src may be the same vector.
+void mu_bvec_and(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src);
+void mu_bvec_or(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src);
+void mu_bvec_xor(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src);
+void mu_bvec_andnot(size_t bit_count, mu_bvec_t *dst, const mu_bvec_t *src);
+
 // Consider
 // rotate and shift operations
-// operations on sub-ranges
 
 #ifdef __cplusplus
 }
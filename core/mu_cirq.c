@@ -30,6 +30,7 @@
 // includes
 
 #include "mulib.h"
+#include "mu_atomic.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
@@ -41,10 +42,50 @@
 // =============================================================================
 // local (forward) declarations
 
+#define IS_POWER_OF_TWO(n) (((n) & ((n)-1)) == 0)
+
+// Largest mask representable by mu_cirq_index_t
+#define CIRQ_MAX_MASK ((mu_cirq_index_t)~(mu_cirq_index_t)0)
+
+// Acquire / release access to an index of the configured width.
+#if (MU_CIRQ_INDEX_BITS == 8)
+#define LOAD_INDEX(p) mu_atomic_load_u8(p)
+#define STORE_INDEX(p, v) mu_atomic_store_u8((p), (v))
+#elif (MU_CIRQ_INDEX_BITS == 16)
+#define LOAD_INDEX(p) mu_atomic_load_u16(p)
+#define STORE_INDEX(p, v) mu_atomic_store_u16((p), (v))
+#else
+#define LOAD_INDEX(p) mu_atomic_load_u32(p)
+#define STORE_INDEX(p, v) mu_atomic_store_u32((p), (v))
+#endif
+
+/**
+ * Return the number of free elements, given the producer's putr.
+ */
+static size_t write_available(mu_cirq_t *cirq, mu_cirq_index_t putr);
+
+/**
+ * Return the number of filled elements, given the consumer's takr.
+ */
+static size_t read_available(mu_cirq_t *cirq, mu_cirq_index_t takr);
+
+/**
+ * Copy up to count elements from src into the queue, returning the number
+ * copied.  Producer side only.
+ */
+static mu_cirq_index_t cirq_write(mu_cirq_t *cirq,
+                                  const void *src,
+                                  size_t count,
+                                  size_t element_size);
+
 /**
- * Return the highest power of two that is less than or equal to n.
+ * Copy up to count elements from the queue into dst, returning the number
+ * copied.  Consumer side only.
  */
-static int hpo2leqn(int n);
+static mu_cirq_index_t cirq_read(mu_cirq_t *cirq,
+                                 void *dst,
+                                 size_t count,
+                                 size_t element_size);
 
 // =============================================================================
 // local storage
@@ -52,9 +93,13 @@ static int hpo2leqn(int n);
 // =============================================================================
 // public code
 
-mu_cirq_t *mu_cirq_init(mu_cirq_t *cirq, void *store, uint8_t n_elements) {
+mu_cirq_t *mu_cirq_init(mu_cirq_t *cirq, void *store, size_t n_elements) {
+  if ((n_elements < 2) || !IS_POWER_OF_TWO(n_elements) ||
+      (n_elements - 1 > CIRQ_MAX_MASK)) {
+    return NULL;
+  }
   cirq->store = store;
-  cirq->mask = hpo2leqn(n_elements) - 1;
+  cirq->mask = (mu_cirq_index_t)(n_elements - 1);
   return mu_cirq_reset(cirq);
 }
 
@@ -64,7 +109,7 @@ mu_cirq_t *mu_cirq_reset(mu_cirq_t *cirq) {
   return cirq;
 }
 
-uint8_t mu_cirq_capacity(mu_cirq_t *cirq) {
+mu_cirq_index_t mu_cirq_capacity(mu_cirq_t *cirq) {
   return cirq->mask;
 }
 
@@ -76,126 +121,148 @@ bool mu_cirq_is_full(mu_cirq_t *cirq) {
   return ((cirq->putr + 1) & cirq->mask) == cirq->takr;
 }
 
-uint8_t mu_cirq_write_8(mu_cirq_t *cirq, const uint8_t *src, size_t count) {
-  uint8_t written = 0;
-  uint8_t *dst = (uint8_t *)cirq->store;
-  while (count-- > 0) {
-    // reserve space by incrementing putr before writing the item
-    uint8_t i1 = cirq->putr;              // where the item will be written
-    uint8_t i2 = (i1 + 1) & cirq->mask;   // post-write value of cirq->putr
-    if (i2 == cirq->takr) break;          // queue was full -- don't write
-    cirq->putr = i2;                      // increment putr
-    dst[i1] = *src++;                     // copy element
-    written += 1;
-  }
-  return written;
+mu_cirq_index_t mu_cirq_write_8(mu_cirq_t *cirq, const uint8_t *src, size_t count) {
+  return cirq_write(cirq, src, count, sizeof(uint8_t));
 }
 
-uint8_t mu_cirq_read_8(mu_cirq_t *cirq, uint8_t *dst, size_t count) {
-  uint8_t read = 0;
-  const uint8_t *src = (const uint8_t *)cirq->store;
-  while (count-- > 0 && !mu_cirq_is_empty(cirq)) {
-    // read the item before incrementing takr so it is always protected
-    *dst++ = src[cirq->takr++];
-    cirq->takr &= cirq->mask;
-    read += 1;
-  }
-  return read;
-}
-
-uint8_t mu_cirq_write_16(mu_cirq_t *cirq, const uint16_t *src, size_t count) {
-  uint8_t written = 0;
-  uint16_t *dst = (uint16_t *)cirq->store;
-  while (count-- > 0) {
-    // reserve space by incrementing putr before writing the item
-    uint8_t i1 = cirq->putr;              // where the item will be written
-    uint8_t i2 = (i1 + 1) & cirq->mask;   // post-write value of cirq->putr
-    if (i2 == cirq->takr) break;          // queue was full -- don't write
-    cirq->putr = i2;                      // increment putr
-    dst[i1] = *src++;                     // copy element
-    written += 1;
-  }
-  return written;
+mu_cirq_index_t mu_cirq_read_8(mu_cirq_t *cirq, uint8_t *dst, size_t count) {
+  return cirq_read(cirq, dst, count, sizeof(uint8_t));
 }
 
-uint8_t mu_cirq_read_16(mu_cirq_t *cirq, uint16_t *dst, size_t count) {
-  uint8_t read = 0;
-  const uint16_t *src = (const uint16_t *)cirq->store;
-  while (count-- > 0 && !mu_cirq_is_empty(cirq)) {
-    // read the item before incrementing takr so it is always protected
-    *dst++ = src[cirq->takr++];
-    cirq->takr &= cirq->mask;
-    read += 1;
-  }
-  return read;
-}
-
-uint8_t mu_cirq_write_32(mu_cirq_t *cirq, const uint32_t *src, size_t count) {
-  uint8_t written = 0;
-  uint32_t *dst = (uint32_t *)cirq->store;
-  while (count-- > 0) {
-    // reserve space by incrementing putr before writing the item
-    uint8_t i1 = cirq->putr;              // where the item will be written
-    uint8_t i2 = (i1 + 1) & cirq->mask;   // post-write value of cirq->putr
-    if (i2 == cirq->takr) break;          // queue was full -- don't write
-    cirq->putr = i2;                      // increment putr
-    dst[i1] = *src++;                     // copy element
-    written += 1;
-  }
-  return written;
+mu_cirq_index_t mu_cirq_write_16(mu_cirq_t *cirq, const uint16_t *src, size_t count) {
+  return cirq_write(cirq, src, count, sizeof(uint16_t));
 }
 
-uint8_t mu_cirq_read_32(mu_cirq_t *cirq, uint32_t *dst, size_t count) {
-  uint8_t read = 0;
-  const uint32_t *src = (const uint32_t *)cirq->store;
-  while (count-- > 0 && !mu_cirq_is_empty(cirq)) {
-    // read the item before incrementing takr so it is always protected
-    *dst++ = src[cirq->takr++];
-    cirq->takr &= cirq->mask;
-    read += 1;
-  }
-  return read;
-}
-
-uint8_t mu_cirq_write_n(mu_cirq_t *cirq, const void *src, size_t count, uint8_t element_size) {
-  const uint8_t *s2 = (const uint8_t *)src;
-  uint8_t *dst = (uint8_t *)cirq->store;
-
-  uint8_t written = 0;
-  while (count-- > 0) {
-    // reserve space by incrementing putr before writing the item
-    uint8_t i1 = cirq->putr;              // where the item will be written
-    uint8_t i2 = (i1 + 1) & cirq->mask;   // post-write value of cirq->putr
-    if (i2 == cirq->takr) break;          // queue was full -- don't write
-    cirq->putr = i2;                      // increment putr
-    memcpy(&dst[i1 * element_size], &s2[written * element_size], element_size);
-    written += 1;
+mu_cirq_index_t mu_cirq_read_16(mu_cirq_t *cirq, uint16_t *dst, size_t count) {
+  return cirq_read(cirq, dst, count, sizeof(uint16_t));
+}
+
+mu_cirq_index_t mu_cirq_write_32(mu_cirq_t *cirq, const uint32_t *src, size_t count) {
+  return cirq_write(cirq, src, count, sizeof(uint32_t));
+}
+
+mu_cirq_index_t mu_cirq_read_32(mu_cirq_t *cirq, uint32_t *dst, size_t count) {
+  return cirq_read(cirq, dst, count, sizeof(uint32_t));
+}
+
+mu_cirq_index_t mu_cirq_write_n(mu_cirq_t *cirq, const void *src, size_t count, uint8_t element_size) {
+  return cirq_write(cirq, src, count, element_size);
+}
+
+mu_cirq_index_t mu_cirq_read_n(mu_cirq_t *cirq, void *dst, size_t count, uint8_t element_size) {
+  return cirq_read(cirq, dst, count, element_size);
+}
+
+void mu_cirq_write_reserve(mu_cirq_t *cirq,
+                           void **ptr,
+                           size_t *len,
+                           uint8_t element_size) {
+  mu_cirq_index_t putr = cirq->putr;
+  size_t available = write_available(cirq, putr);
+  size_t contiguous = (size_t)cirq->mask + 1 - putr;
+
+  *ptr = (uint8_t *)cirq->store + putr * element_size;
+  *len = (available < contiguous) ? available : contiguous;
+}
+
+void mu_cirq_write_commit(mu_cirq_t *cirq, size_t n) {
+  mu_cirq_index_t putr = cirq->putr;
+  size_t available = write_available(cirq, putr);
+
+  if (n > available) {
+    n = available;
   }
-  return written;
+  STORE_INDEX(&cirq->putr, (putr + n) & cirq->mask);
+}
+
+void mu_cirq_read_peek(mu_cirq_t *cirq,
+                       const void **ptr,
+                       size_t *len,
+                       uint8_t element_size) {
+  mu_cirq_index_t takr = cirq->takr;
+  size_t available = read_available(cirq, takr);
+  size_t contiguous = (size_t)cirq->mask + 1 - takr;
+
+  *ptr = (const uint8_t *)cirq->store + takr * element_size;
+  *len = (available < contiguous) ? available : contiguous;
 }
 
-uint8_t mu_cirq_read_n(mu_cirq_t *cirq, void *dst, size_t count, uint8_t element_size) {
-  uint8_t *d2 = (uint8_t *)dst;
-  const uint8_t *src = (const uint8_t *)cirq->store;
+void mu_cirq_read_release(mu_cirq_t *cirq, size_t n) {
+  mu_cirq_index_t takr = cirq->takr;
+  size_t available = read_available(cirq, takr);
 
-  uint8_t read = 0;
-  while (count-- > 0 && !mu_cirq_is_empty(cirq)) {
-    // read the item before incrementing takr so it is always protected
-    memcpy(&d2[read * element_size], &src[cirq->takr++ * element_size], element_size);
-    cirq->takr &= cirq->mask;
-    read += 1;
+  if (n > available) {
+    n = available;
   }
-  return read;
+  STORE_INDEX(&cirq->takr, (takr + n) & cirq->mask);
 }
 
 // =============================================================================
 // local code
 
-static int hpo2leqn(int n) {
-  int p = 1;
-  while (n > 0) {
-    n >>= 1;
-    p <<= 1;
+static size_t write_available(mu_cirq_t *cirq, mu_cirq_index_t putr) {
+  // putr belongs to the producer; takr may be advanced concurrently by the
+  // consumer, but only ever frees more space, so a stale value is safe.
+  mu_cirq_index_t takr = LOAD_INDEX(&cirq->takr);
+  return (takr - putr - 1) & cirq->mask;
+}
+
+static size_t read_available(mu_cirq_t *cirq, mu_cirq_index_t takr) {
+  // takr belongs to the consumer; putr may be advanced concurrently by the
+  // producer, but only ever adds items, so a stale value is safe.
+  mu_cirq_index_t putr = LOAD_INDEX(&cirq->putr);
+  return (putr - takr) & cirq->mask;
+}
+
+static mu_cirq_index_t cirq_write(mu_cirq_t *cirq,
+                                  const void *src,
+                                  size_t count,
+                                  size_t element_size) {
+  mu_cirq_index_t putr = cirq->putr;
+  size_t available = write_available(cirq, putr);
+  size_t n_elements = (size_t)cirq->mask + 1;
+  uint8_t *store = (uint8_t *)cirq->store;
+  size_t first;
+
+  if (count > available) {
+    count = available;
+  }
+  // Copy up to the end of the store, then wrap around to the start.
+  first = n_elements - putr;
+  if (first > count) {
+    first = count;
+  }
+  memcpy(&store[putr * element_size], src, first * element_size);
+  memcpy(store,
+         (const uint8_t *)src + first * element_size,
+         (count - first) * element_size);
+  // Publish the new items only after they have been copied.
+  STORE_INDEX(&cirq->putr, (putr + count) & cirq->mask);
+  return count;
+}
+
+static mu_cirq_index_t cirq_read(mu_cirq_t *cirq,
+                                 void *dst,
+                                 size_t count,
+                                 size_t element_size) {
+  mu_cirq_index_t takr = cirq->takr;
+  size_t available = read_available(cirq, takr);
+  size_t n_elements = (size_t)cirq->mask + 1;
+  const uint8_t *store = (const uint8_t *)cirq->store;
+  size_t first;
+
+  if (count > available) {
+    count = available;
+  }
+  first = n_elements - takr;
+  if (first > count) {
+    first = count;
   }
-  return p >> 1;
+  memcpy(dst, &store[takr * element_size], first * element_size);
+  memcpy((uint8_t *)dst + first * element_size,
+         store,
+         (count - first) * element_size);
+  // Release the slots only after the items have been copied out.
+  STORE_INDEX(&cirq->takr, (takr + count) & cirq->mask);
+  return count;
 }
@@ -43,11 +43,31 @@ extern "C" {
 // =============================================================================
 // types and definitions
 
+/**
+ * @brief Width of the queue indices in bits: 8, 16 or 32.  A queue can hold up
+ * to 2^MU_CIRQ_INDEX_BITS elements (one less is usable).  Wider indices allow
+ * larger queues at the cost of a larger mu_cirq_t; on most targets the indices
+ * must be no wider than the native word for loads and stores to be atomic.
+ */
+#ifndef MU_CIRQ_INDEX_BITS
+#define MU_CIRQ_INDEX_BITS 8
+#endif
+
+#if (MU_CIRQ_INDEX_BITS == 8)
+typedef uint8_t mu_cirq_index_t;
+#elif (MU_CIRQ_INDEX_BITS == 16)
+typedef uint16_t mu_cirq_index_t;
+#elif (MU_CIRQ_INDEX_BITS == 32)
+typedef uint32_t mu_cirq_index_t;
+#else
+#error "MU_CIRQ_INDEX_BITS must be 8, 16 or 32"
+#endif
+
 typedef struct {
-  void *store;         // item store, 2^n elements long (up to 256 max)
-  uint8_t mask;         // 2^n - 1, and also capacity of circular buffer
-  uint8_t putr;        // index where the next item will be stored
-  uint8_t takr;        // index of the next item to be fetched
+  void *store;                   // item store, 2^n elements long
+  mu_cirq_index_t mask;          // 2^n - 1, and also capacity of the queue
+  volatile mu_cirq_index_t putr; // index where the next item will be stored
+  volatile mu_cirq_index_t takr; // index of the next item to be fetched
 } mu_cirq_t;
 
 // =============================================================================
@@ -56,42 +76,113 @@ typedef struct {
 /**
  * @brief Initialize the Circular Queue.
  *
- * Note that the queue will hold a maximum of 255 elements, or one less than the
- * highest power of two less than or equal to n_elements, whichever is smaller.
- * The n_elements argument is rounded down to the nearest power of two that is
- * less than or equal to n_elements, and the store must be capable of holding
- * that many elements.  The actual capacity of the queue is one less than the
- * (adjusted) n_elements.
+ * n_elements must be a power of two between 2 and 2^MU_CIRQ_INDEX_BITS, and
+ * the store must be capable of holding that many elements.  The actual
+ * capacity of the queue is one less than n_elements.
  *
  * @param cirq Pointer to the circular Queue structure to be initialized.
  * @param store Pointer to the data store.
- * @param n_elements Maximum number of elements to be held in the queue.
+ * @param n_elements Number of elements in the store.
+ * @return cirq on success, or NULL (leaving cirq unmodified) if n_elements is
+ *         not a power of two or is out of range.
  */
-mu_cirq_t *mu_cirq_init(mu_cirq_t *cirq, void *store, uint8_t n_elements);
+mu_cirq_t *mu_cirq_init(mu_cirq_t *cirq, void *store, size_t n_elements);
 
 mu_cirq_t *mu_cirq_reset(mu_cirq_t *cirq);
 
-uint8_t mu_cirq_capacity(mu_cirq_t *cirq);
+mu_cirq_index_t mu_cirq_capacity(mu_cirq_t *cirq);
 
 bool mu_cirq_is_empty(mu_cirq_t *cirq);
 
 bool mu_cirq_is_full(mu_cirq_t *cirq);
 
-uint8_t mu_cirq_write_8(mu_cirq_t *cirq, const uint8_t *src, size_t count);
+/**
+ * @brief Copy up to count elements into the queue.
+ *
+ * The free space is computed once and the elements are moved with at most two
+ * memcpy() calls (one when the free space wraps around the end of the store).
+ * putr is advanced only after the copy, so the consumer never sees a partially
+ * written element.  May only be called by the producer.
+ *
+ * The _16, _32 and _n variants behave identically for wider elements.
+ *
+ * @return The number of elements written, which is less than count if the
+ *         queue filled.
+ */
+mu_cirq_index_t mu_cirq_write_8(mu_cirq_t *cirq, const uint8_t *src, size_t count);
+
+/**
+ * @brief Copy up to count elements out of the queue.
+ *
+ * As with mu_cirq_write_8(), at most two memcpy() calls are made and takr is
+ * advanced only after the copy.  May only be called by the consumer.
+ *
+ * @return The number of elements read, which is less than count if the queue
+ *         emptied.
+ */
+mu_cirq_index_t mu_cirq_read_8(mu_cirq_t *cirq, uint8_t *dst, size_t count);
 
-uint8_t mu_cirq_read_8(mu_cirq_t *cirq, uint8_t *dst, size_t count);
+mu_cirq_index_t mu_cirq_write_16(mu_cirq_t *cirq, const uint16_t *src, size_t count);
 
-uint8_t mu_cirq_write_16(mu_cirq_t *cirq, const uint16_t *src, size_t count);
+mu_cirq_index_t mu_cirq_read_16(mu_cirq_t *cirq, uint16_t *dst, size_t count);
 
-uint8_t mu_cirq_read_16(mu_cirq_t *cirq, uint16_t *dst, size_t count);
+mu_cirq_index_t mu_cirq_write_32(mu_cirq_t *cirq, const uint32_t *src, size_t count);
 
-uint8_t mu_cirq_write_32(mu_cirq_t *cirq, const uint32_t *src, size_t count);
+mu_cirq_index_t mu_cirq_read_32(mu_cirq_t *cirq, uint32_t *dst, size_t count);
 
-uint8_t mu_cirq_read_32(mu_cirq_t *cirq, uint32_t *dst, size_t count);
+mu_cirq_index_t mu_cirq_write_n(mu_cirq_t *cirq, const void *src, size_t count, uint8_t element_size);
 
-uint8_t mu_cirq_write_n(mu_cirq_t *cirq, const void *src, size_t count, uint8_t element_size);
+mu_cirq_index_t mu_cirq_read_n(mu_cirq_t *cirq, void *dst, size_t count, uint8_t element_size);
 
-uint8_t mu_cirq_read_n(mu_cirq_t *cirq, void *dst, size_t count, uint8_t element_size);
+/**
+ * @brief Expose the contiguous free region at putr for direct writing.
+ *
+ * This lets a producer such as a DMA engine write straight into the store
+ * rather than bouncing data through an intermediate buffer.  Because the
+ * region never wraps, *len may be less than the total free space: after
+ * committing, a second reserve returns the remainder at the start of the
+ * store.  May only be called by the producer.
+ *
+ * @param ptr Set to the address of the first free element.
+ * @param len Set to the number of contiguous free elements (possibly zero).
+ * @param element_size The size of each element in bytes.
+ */
+void mu_cirq_write_reserve(mu_cirq_t *cirq,
+                           void **ptr,
+                           size_t *len,
+                           uint8_t element_size);
+
+/**
+ * @brief Publish n elements written into a region from mu_cirq_write_reserve().
+ *
+ * n is clamped to the free space in the queue.  May only be called by the
+ * producer.
+ */
+void mu_cirq_write_commit(mu_cirq_t *cirq, size_t n);
+
+/**
+ * @brief Expose the contiguous filled region at takr for direct reading.
+ *
+ * As with mu_cirq_write_reserve(), the region never wraps, so *len may be less
+ * than the number of elements in the queue.  May only be called by the
+ * consumer.
+ *
+ * @param ptr Set to the address of the oldest element.
+ * @param len Set to the number of contiguous elements (possibly zero).
+ * @param element_size The size of each element in bytes.
+ */
+void mu_cirq_read_peek(mu_cirq_t *cirq,
+                       const void **ptr,
+                       size_t *len,
+                       uint8_t element_size);
+
+/**
+ * @brief Release n elements consumed from a region from mu_cirq_read_peek().
+ *
+ * n is clamped to the number of elements in the queue.  May only be called by
+ * the consumer.
+ */
+void mu_cirq_read_release(mu_cirq_t *cirq, size_t n);
 
 #ifdef __cplusplus
 }
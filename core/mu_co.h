@@ -0,0 +1,167 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Stackless coroutines for task functions.
+ *
+ * A multi-step asynchronous sequence is usually written as a state machine
+ * whose task function reschedules itself between steps.  The mu_co macros let
+ * the same sequence be written as straight-line code, in the manner of
+ * protothreads:
+ *
+ * @code
+ * typedef struct {
+ *   mu_co_t co;   // resume point
+ *   int count;    // state that must survive a yield
+ * } blinker_t;
+ *
+ * static void blinker_fn(void *ctx, void *arg) {
+ *   blinker_t *self = (blinker_t *)ctx;
+ *   (void)arg;
+ *
+ *   MU_CO_BEGIN(&self->co);
+ *   for (self->count = 0; self->count < 10; self->count++) {
+ *     led_on();
+ *     MU_CO_AWAIT_MS(&self->co, 100);
+ *     led_off();
+ *     MU_CO_AWAIT_MS(&self->co, 900);
+ *   }
+ *   MU_CO_WAIT_UNTIL(&self->co, button_is_pressed());
+ *   MU_CO_END(&self->co);
+ * }
+ * @endcode
+ *
+ * The context passed to the task (here a blinker_t) holds a mu_co_t that
+ * records where to resume.  Each MU_CO_YIELD(), MU_CO_AWAIT_MS() or
+ * MU_CO_WAIT_UNTIL() reschedules the current task and returns.  The next call
+ * to the task function jumps straight back to that point.  No stack is kept
+ * between calls and no context switch takes place, so a coroutine costs only
+ * the two bytes of its mu_co_t.
+ *
+ * The macros expand to a switch statement, so:
+ * - local variables do not survive a yield; keep such state in the context;
+ * - the coroutine body must not contain its own switch statement that spans
+ *   a yield;
+ * - each yield must be on its own source line.
+ *
+ * After MU_CO_END() the resume point is reset, so the next call to the task
+ * function starts again from MU_CO_BEGIN().  The task is not rescheduled at
+ * the end, so a restart only happens when something schedules the task again.
+ */
+
+#ifndef _MU_CO_H_
+#define _MU_CO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_sched.h"
+#include "mu_time.h"
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+// Marks the deliberate fall through into MU_CO_WAIT_UNTIL()'s case label.  A
+// /* fall through */ comment would be stripped from the macro expansion.
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define MU_CO_FALLTHROUGH __attribute__((fallthrough))
+#endif
+#endif
+#ifndef MU_CO_FALLTHROUGH
+#define MU_CO_FALLTHROUGH ((void)0)
+#endif
+
+typedef struct {
+  uint16_t resume; // source line to resume from, or 0 to start from the top
+} mu_co_t;
+
+/**
+ * @brief Initialize (or reset) a coroutine so that it starts from the top.
+ */
+#define MU_CO_INIT(_co) ((_co)->resume = 0)
+
+/**
+ * @brief Start the body of a coroutine.  Must come before any other mu_co
+ * macro in the task function.
+ */
+#define MU_CO_BEGIN(_co)                                                       \
+  switch ((_co)->resume) {                                                     \
+  case 0:
+
+/**
+ * @brief End the body of a coroutine and reset it to start from the top.
+ */
+#define MU_CO_END(_co)                                                         \
+  }                                                                            \
+  (_co)->resume = 0;                                                           \
+  return
+
+/**
+ * @brief Give other tasks a chance to run, resuming at the next opportunity.
+ */
+#define MU_CO_YIELD(_co)                                                       \
+  do {                                                                         \
+    (_co)->resume = __LINE__;                                                  \
+    mu_sched_reschedule_now();                                                 \
+    return;                                                                    \
+  case __LINE__:;                                                              \
+  } while (0)
+
+/**
+ * @brief Suspend the coroutine for the given number of milliseconds.
+ */
+#define MU_CO_AWAIT_MS(_co, _ms)                                               \
+  do {                                                                         \
+    (_co)->resume = __LINE__;                                                  \
+    mu_sched_reschedule_in(mu_time_ms_to_duration(_ms));                       \
+    return;                                                                    \
+  case __LINE__:;                                                              \
+  } while (0)
+
+/**
+ * @brief Suspend the coroutine until _cond is true.  The condition is tested
+ * immediately and then again on every pass of the scheduler.
+ */
+#define MU_CO_WAIT_UNTIL(_co, _cond)                                           \
+  do {                                                                         \
+    (_co)->resume = __LINE__;                                                  \
+    MU_CO_FALLTHROUGH;                                                         \
+  case __LINE__:                                                               \
+    if (!(_cond)) {                                                            \
+      mu_sched_reschedule_now();                                               \
+      return;                                                                  \
+    }                                                                          \
+  } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _MU_CO_H_ */
@@ -199,7 +199,7 @@ mu_dlist_t *mu_dlist_last(mu_dlist_t *head) {
 
 size_t mu_dlist_length(mu_dlist_t *head) {
   mu_dlist_t *list = head;
-  int length = 0;
+  size_t length = 0;
 
   while (mu_dlist_next(list) != head) {
     length += 1;
@@ -264,7 +264,8 @@ void *mu_dlist_traverse_prev(mu_dlist_t *head, mu_dlist_traverse_fn fn, void *ar
 
 
 mu_dlist_t *mu_dlist_reverse(mu_dlist_t *head) {
-  if (mu_dlist_length(head) > 1) {
+  // more than one element iff the first and last elements differ
+  if (mu_dlist_next(head) != mu_dlist_prev(head)) {
     mu_dlist_t reversed;
     mu_dlist_init(&reversed);
 
@@ -280,6 +281,78 @@ mu_dlist_t *mu_dlist_reverse(mu_dlist_t *head) {
   return head;
 }
 
+// =============================================================================
+// operations on a counted list head
+
+mu_dlist_counted_t *mu_dlist_counted_init(mu_dlist_counted_t *list) {
+  mu_dlist_init(&list->head);
+  list->count = 0;
+  return list;
+}
+
+mu_dlist_t *mu_dlist_counted_head(mu_dlist_counted_t *list) {
+  return &list->head;
+}
+
+size_t mu_dlist_counted_length(mu_dlist_counted_t *list) {
+  return list->count;
+}
+
+bool mu_dlist_counted_is_empty(mu_dlist_counted_t *list) {
+  return list->count == 0;
+}
+
+mu_dlist_t *mu_dlist_counted_insert_next(mu_dlist_counted_t *list,
+                                         mu_dlist_t *pos,
+                                         mu_dlist_t *e) {
+  list->count += 1;
+  return mu_dlist_insert_next(pos, e);
+}
+
+mu_dlist_t *mu_dlist_counted_insert_prev(mu_dlist_counted_t *list,
+                                         mu_dlist_t *pos,
+                                         mu_dlist_t *e) {
+  list->count += 1;
+  return mu_dlist_insert_prev(pos, e);
+}
+
+mu_dlist_counted_t *mu_dlist_counted_push(mu_dlist_counted_t *list,
+                                          mu_dlist_t *e) {
+  mu_dlist_counted_insert_next(list, &list->head, e);
+  return list;
+}
+
+mu_dlist_counted_t *mu_dlist_counted_push_prev(mu_dlist_counted_t *list,
+                                               mu_dlist_t *e) {
+  mu_dlist_counted_insert_prev(list, &list->head, e);
+  return list;
+}
+
+mu_dlist_t *mu_dlist_counted_pop(mu_dlist_counted_t *list) {
+  mu_dlist_t *e = mu_dlist_pop(&list->head);
+  if (e != NULL) {
+    list->count -= 1;
+  }
+  return e;
+}
+
+mu_dlist_t *mu_dlist_counted_pop_prev(mu_dlist_counted_t *list) {
+  mu_dlist_t *e = mu_dlist_pop_prev(&list->head);
+  if (e != NULL) {
+    list->count -= 1;
+  }
+  return e;
+}
+
+mu_dlist_t *mu_dlist_counted_unlink(mu_dlist_counted_t *list, mu_dlist_t *e) {
+  if (mu_dlist_unlink(e) != NULL) {
+    list->count -= 1;
+    return e;
+  } else {
+    return NULL;
+  }
+}
+
 // =============================================================================
 // local (static) code
 
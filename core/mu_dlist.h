@@ -68,6 +68,17 @@
  * approach simplifies the code, especially operations that modify the first (or
  * last) items in the list.  It also makes finding the first and last elements
  * of the list especially fast.
+ *
+ * # counted lists
+ *
+ * mu_dlist_length() walks the entire list.  When the length is needed often
+ * (e.g. for telemetry), use a mu_dlist_counted_t as the list head instead: it
+ * wraps a plain head with an element count that is maintained as elements are
+ * inserted, pushed, popped and unlinked through the mu_dlist_counted_xxx()
+ * functions, so mu_dlist_counted_length() is O(1).  Read-only operations such
+ * as mu_dlist_first() or mu_dlist_traverse() can be applied directly to the
+ * result of mu_dlist_counted_head().  Modifying the list by any other means
+ * leaves the count stale.
  */
 
 #ifndef _MU_DLIST_H_
@@ -100,6 +111,14 @@ typedef struct _mu_dlist {
  */
 typedef void *(*mu_dlist_traverse_fn)(mu_dlist_t *list, void *arg);
 
+/**
+ * @brief A list head that keeps track of the number of elements in the list.
+ */
+typedef struct {
+  mu_dlist_t head;  // the underlying list head
+  size_t count;     // number of elements in the list
+} mu_dlist_counted_t;
+
 /**
  * @brief Given a pointer to a structure and the name of the slot containing a
  * mu_dlist_t, return a pointer to the mu_dlist_t.
@@ -297,6 +316,112 @@ void *mu_dlist_traverse_prev(mu_dlist_t *head, mu_dlist_traverse_fn fn, void *ar
  */
 mu_dlist_t *mu_dlist_reverse(mu_dlist_t *head);
 
+// =============================================================================
+// operations on a counted list head
+
+/**
+ * @brief Initialize a counted list head.
+ *
+ * @param list A pointer to the counted list head.
+ * @return list
+ */
+mu_dlist_counted_t *mu_dlist_counted_init(mu_dlist_counted_t *list);
+
+/**
+ * @brief Return the underlying list head of a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The plain list head, suitable for read-only mu_dlist_xxx() calls.
+ */
+mu_dlist_t *mu_dlist_counted_head(mu_dlist_counted_t *list);
+
+/**
+ * @brief Return the number of elements in a counted list in constant time.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The number of elements in the list.
+ */
+size_t mu_dlist_counted_length(mu_dlist_counted_t *list);
+
+/**
+ * @brief Return true if a counted list has no elements.
+ *
+ * @param list A pointer to the counted list head.
+ * @return true if the list contains no elements.
+ */
+bool mu_dlist_counted_is_empty(mu_dlist_counted_t *list);
+
+/**
+ * @brief Insert an element after a given position in a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param pos The list head or an element of the list.
+ * @param e The element to insert.
+ * @return e
+ */
+mu_dlist_t *mu_dlist_counted_insert_next(mu_dlist_counted_t *list,
+                                         mu_dlist_t *pos,
+                                         mu_dlist_t *e);
+
+/**
+ * @brief Insert an element before a given position in a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param pos The list head or an element of the list.
+ * @param e The element to insert.
+ * @return e
+ */
+mu_dlist_t *mu_dlist_counted_insert_prev(mu_dlist_counted_t *list,
+                                         mu_dlist_t *pos,
+                                         mu_dlist_t *e);
+
+/**
+ * @brief Push an element onto the head of a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param e A pointer to the element to push.
+ * @return list
+ */
+mu_dlist_counted_t *mu_dlist_counted_push(mu_dlist_counted_t *list,
+                                          mu_dlist_t *e);
+
+/**
+ * @brief Push an element onto the tail of a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param e A pointer to the element to push.
+ * @return list
+ */
+mu_dlist_counted_t *mu_dlist_counted_push_prev(mu_dlist_counted_t *list,
+                                               mu_dlist_t *e);
+
+/**
+ * @brief Remove the first element from a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The element removed, or NULL if the list is empty.
+ */
+mu_dlist_t *mu_dlist_counted_pop(mu_dlist_counted_t *list);
+
+/**
+ * @brief Remove the last element from a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The element removed, or NULL if the list is empty.
+ */
+mu_dlist_t *mu_dlist_counted_pop_prev(mu_dlist_counted_t *list);
+
+/**
+ * @brief Delete an element from a counted list.
+ *
+ * Note: the element must either be unlinked or be a member of this list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param e A pointer the element to unlink.
+ * @return e if the element was in the list, NULL otherwise
+ */
+mu_dlist_t *mu_dlist_counted_unlink(mu_dlist_counted_t *list, mu_dlist_t *e);
+
 #ifdef __cplusplus
 }
 #endif
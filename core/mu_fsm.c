@@ -26,6 +26,12 @@
 // Includes
 
 #include "mu_fsm.h"
+#include "mu_mpsc.h"
+#include "mu_sched.h"
+#include "mu_task.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // =============================================================================
 // Private types and definitions
@@ -33,6 +39,15 @@
 // =============================================================================
 // Private declarations
 
+static void queued_task_fn(void *ctx, void *arg);
+
+static void queued_dispatch(mu_fsm_queued_t *fsm, int event);
+
+static const mu_fsm_transition_t *queued_find_transition(mu_fsm_queued_t *fsm,
+                                                         int event);
+
+static void queued_call_hook(mu_fsm_queued_t *fsm, int state, bool entry);
+
 // =============================================================================
 // Local storage
 
@@ -76,5 +91,133 @@ const char *mu_fsm_state_name(mu_fsm_t *fsm, int state) {
   return "";
 }
 
+mu_fsm_err_t mu_fsm_queued_init(mu_fsm_queued_t *fsm,
+                                const mu_fsm_state_t states[],
+                                int n_states,
+                                const mu_fsm_transition_t transitions[],
+                                int n_transitions,
+                                int initial_state,
+                                mu_mpsc_cell_t *cells,
+                                uint16_t capacity,
+                                void *ctx) {
+  if (mu_mpsc_init(&fsm->events, cells, capacity) != MU_MPSC_ERR_NONE) {
+    return MU_FSM_ERR_SIZE;
+  }
+  fsm->states = states;
+  fsm->n_states = n_states;
+  fsm->transitions = transitions;
+  fsm->n_transitions = n_transitions;
+  fsm->state = initial_state;
+  fsm->ctx = ctx;
+  mu_task_init(&fsm->task, queued_task_fn, fsm, "fsm");
+  queued_call_hook(fsm, initial_state, true);
+  return MU_FSM_ERR_NONE;
+}
+
+mu_fsm_err_t mu_fsm_queued_post(mu_fsm_queued_t *fsm, int event) {
+  mu_fsm_err_t err = MU_FSM_ERR_NONE;
+  if (mu_mpsc_put(&fsm->events, (mu_mpsc_item_t)(intptr_t)event) !=
+      MU_MPSC_ERR_NONE) {
+    err = MU_FSM_ERR_FULL;
+  }
+  // Schedule the machine even if the event was dropped: a full queue must
+  // still be drained.
+  if (!mu_task_is_scheduled(&fsm->task)) {
+    mu_sched_task_now(&fsm->task);
+  }
+  return err;
+}
+
+mu_fsm_err_t mu_fsm_queued_isr_post(mu_fsm_queued_t *fsm, int event) {
+  bool is_full = mu_mpsc_put(&fsm->events, (mu_mpsc_item_t)(intptr_t)event) !=
+                 MU_MPSC_ERR_NONE;
+  // Try to schedule the machine even if the event was dropped, otherwise a
+  // queue that filled while scheduling was refused would never be drained.
+  // Events left queued by a failed schedule are processed along with the next
+  // post that schedules the machine.
+  bool is_scheduled = mu_sched_isr_task_now(&fsm->task) == MU_SCHED_ERR_NONE;
+  if (is_full) {
+    return MU_FSM_ERR_FULL;
+  } else if (!is_scheduled) {
+    return MU_FSM_ERR_NOT_SCHEDULED;
+  }
+  return MU_FSM_ERR_NONE;
+}
+
+bool mu_fsm_queued_is_pending(mu_fsm_queued_t *fsm) {
+  return !mu_mpsc_is_empty(&fsm->events);
+}
+
+int mu_fsm_queued_get_state(mu_fsm_queued_t *fsm) { return fsm->state; }
+
+const char *mu_fsm_queued_state_name(mu_fsm_queued_t *fsm, int state) {
+  if ((state < 0) || (state >= fsm->n_states)) {
+    return "unknown state";
+  } else if (fsm->states[state].name == NULL) {
+    return "";
+  } else {
+    return fsm->states[state].name;
+  }
+}
+
 // =============================================================================
 // Private functions
+
+static void queued_task_fn(void *ctx, void *arg) {
+  (void)arg;
+  mu_fsm_queued_t *fsm = (mu_fsm_queued_t *)ctx;
+  mu_mpsc_item_t item;
+
+  // Process at most one queue's worth of events per call so that a machine
+  // that keeps posting to itself can't starve the other tasks.
+  for (uint16_t i = mu_mpsc_capacity(&fsm->events); i > 0; i--) {
+    if (mu_mpsc_get(&fsm->events, &item) != MU_MPSC_ERR_NONE) {
+      return;
+    }
+    queued_dispatch(fsm, (int)(intptr_t)item);
+  }
+  if (mu_fsm_queued_is_pending(fsm) && !mu_task_is_scheduled(&fsm->task)) {
+    mu_sched_task_now(&fsm->task);
+  }
+}
+
+static void queued_dispatch(mu_fsm_queued_t *fsm, int event) {
+  const mu_fsm_transition_t *t = queued_find_transition(fsm, event);
+  if (t == NULL) {
+    return;
+  }
+  if (t->next_state == MU_FSM_NO_TRANSITION) {
+    if (t->action != NULL) {
+      t->action(fsm->ctx, event);
+    }
+  } else {
+    queued_call_hook(fsm, fsm->state, false);
+    if (t->action != NULL) {
+      t->action(fsm->ctx, event);
+    }
+    fsm->state = t->next_state;
+    queued_call_hook(fsm, fsm->state, true);
+  }
+}
+
+static const mu_fsm_transition_t *queued_find_transition(mu_fsm_queued_t *fsm,
+                                                         int event) {
+  for (int i = 0; i < fsm->n_transitions; i++) {
+    const mu_fsm_transition_t *t = &fsm->transitions[i];
+    if ((t->event == event) &&
+        ((t->state == fsm->state) || (t->state == MU_FSM_ANY_STATE))) {
+      return t;
+    }
+  }
+  return NULL;
+}
+
+static void queued_call_hook(mu_fsm_queued_t *fsm, int state, bool entry) {
+  if ((state >= 0) && (state < fsm->n_states)) {
+    const mu_fsm_state_t *s = &fsm->states[state];
+    mu_fsm_hook_fn hook = entry ? s->on_entry : s->on_exit;
+    if (hook != NULL) {
+      hook(fsm->ctx, state);
+    }
+  }
+}
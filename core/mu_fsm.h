@@ -32,7 +32,11 @@ extern "C" {
 // =============================================================================
 // includes
 
+#include "mu_mpsc.h"
+#include "mu_task.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // =============================================================================
 // types and definitions
@@ -47,6 +51,75 @@ typedef struct {
   int n_states;           // size of fns[]
 } mu_fsm_t;
 
+// -----------------------------------------------------------------------------
+// Event queued state machines
+//
+// mu_fsm_dispatch() runs the current state function immediately, so an event
+// raised from within a state function recurses, and events originating at
+// interrupt level must be marshalled to the foreground by hand.  A
+// mu_fsm_queued_t instead posts each event into a per-machine FIFO (a mu_mpsc,
+// so both the foreground and interrupt handlers may post) and drains it from a
+// single scheduler task.  Each event runs to completion -- exit hook, action,
+// entry hook -- before the next one is taken from the queue.
+//
+// Behavior is described by constant tables rather than code:
+//
+//     static const mu_fsm_state_t s_states[] = {
+//       [LED_OFF] = {"off", NULL, led_off_entry},
+//       [LED_ON] = {"on", led_on_exit, led_on_entry},
+//     };
+//     static const mu_fsm_transition_t s_transitions[] = {
+//       {LED_OFF, EVT_BUTTON, LED_ON, NULL},
+//       {LED_ON, EVT_BUTTON, LED_OFF, NULL},
+//       {MU_FSM_ANY_STATE, EVT_TICK, MU_FSM_NO_TRANSITION, count_tick},
+//     };
+//
+// The first transition whose state and event match is taken.  Events that
+// match no transition are discarded.
+
+typedef enum {
+  MU_FSM_ERR_NONE,
+  MU_FSM_ERR_FULL,  // the event queue is full
+  MU_FSM_ERR_SIZE,  // the event queue capacity is not a power of two
+  MU_FSM_ERR_NOT_SCHEDULED, // event queued, but the machine's task was not
+} mu_fsm_err_t;
+
+// In a transition table, matches any current state.
+#define MU_FSM_ANY_STATE (-1)
+
+// In a transition table, runs the action without leaving the current state.
+#define MU_FSM_NO_TRANSITION (-1)
+
+// Signature of an entry or exit hook.
+typedef void (*mu_fsm_hook_fn)(void *ctx, int state);
+
+// Signature of a transition action.
+typedef void (*mu_fsm_action_fn)(void *ctx, int event);
+
+typedef struct {
+  const char *name;        // state name, may be NULL
+  mu_fsm_hook_fn on_exit;  // called when leaving the state, may be NULL
+  mu_fsm_hook_fn on_entry; // called when entering the state, may be NULL
+} mu_fsm_state_t;
+
+typedef struct {
+  int state;               // current state, or MU_FSM_ANY_STATE
+  int event;               // the triggering event
+  int next_state;          // the new state, or MU_FSM_NO_TRANSITION
+  mu_fsm_action_fn action; // called between exit and entry hooks, may be NULL
+} mu_fsm_transition_t;
+
+typedef struct {
+  const mu_fsm_state_t *states;           // table of states
+  const mu_fsm_transition_t *transitions; // table of transitions
+  int n_states;                           // size of states[]
+  int n_transitions;                      // size of transitions[]
+  int state;                              // the current state
+  void *ctx;                              // passed to hooks and actions
+  mu_mpsc_t events;                       // pending events
+  mu_task_t task;                         // drains the pending events
+} mu_fsm_queued_t;
+
 // =============================================================================
 // Declarations
 
@@ -64,6 +137,69 @@ void mu_fsm_dispatch(mu_fsm_t *fsm, void *receiver, void *sender);
 
 const char *mu_fsm_state_name(mu_fsm_t *fsm, int state);
 
+/**
+ * @brief Initialize an event queued state machine and enter its initial state.
+ *
+ * The initial state's on_entry hook is called before this function returns.
+ *
+ * @param fsm The state machine to initialize.
+ * @param states Table of n_states states, indexed by state number.
+ * @param n_states Number of entries in states[].
+ * @param transitions Table of n_transitions transitions.
+ * @param n_transitions Number of entries in transitions[].
+ * @param initial_state The initial state.
+ * @param cells Storage for the event queue.
+ * @param capacity Number of elements in cells.  Must be a power of two.
+ * @param ctx User context, passed to every hook and action.
+ * @return MU_FSM_ERR_SIZE if capacity is not a power of two, MU_FSM_ERR_NONE
+ *         otherwise.
+ */
+mu_fsm_err_t mu_fsm_queued_init(mu_fsm_queued_t *fsm,
+                                const mu_fsm_state_t states[],
+                                int n_states,
+                                const mu_fsm_transition_t transitions[],
+                                int n_transitions,
+                                int initial_state,
+                                mu_mpsc_cell_t *cells,
+                                uint16_t capacity,
+                                void *ctx);
+
+/**
+ * @brief Post an event from the foreground, including from within a hook or
+ * action of the same machine.
+ *
+ * The machine is scheduled even when the event is dropped, so that a full
+ * queue is always drained.
+ *
+ * @return MU_FSM_ERR_FULL if the event queue is full, MU_FSM_ERR_NONE
+ *         otherwise.
+ */
+mu_fsm_err_t mu_fsm_queued_post(mu_fsm_queued_t *fsm, int event);
+
+/**
+ * @brief Post an event from interrupt level.
+ *
+ * The machine is scheduled even when the event is dropped, so that a queue
+ * that filled while the scheduler's interrupt queue was full is drained by the
+ * next post that gets through.
+ *
+ * @return MU_FSM_ERR_FULL if the event queue is full and the event was
+ *         dropped, MU_FSM_ERR_NOT_SCHEDULED if the event was queued but the
+ *         scheduler's interrupt queue is full (the event is processed with
+ *         the next one that schedules the machine), MU_FSM_ERR_NONE
+ *         otherwise.
+ */
+mu_fsm_err_t mu_fsm_queued_isr_post(mu_fsm_queued_t *fsm, int event);
+
+/**
+ * @brief Return true if events are waiting to be processed.
+ */
+bool mu_fsm_queued_is_pending(mu_fsm_queued_t *fsm);
+
+int mu_fsm_queued_get_state(mu_fsm_queued_t *fsm);
+
+const char *mu_fsm_queued_state_name(mu_fsm_queued_t *fsm, int state);
+
 #ifdef __cplusplus
 }
 #endif
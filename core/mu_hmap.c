@@ -0,0 +1,319 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_hmap.h"
+#include "mu_str.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// =============================================================================
+// private types and definitions
+
+// =============================================================================
+// private declarations
+
+static uint32_t hash_int(uint32_t key);
+
+static uint32_t hash_bytes(const uint8_t *bytes, size_t len);
+
+static size_t probe_distance(mu_hmap_t *map, uint32_t hash, size_t index);
+
+static bool key_matches(const mu_hmap_entry_t *entry,
+                        const uint8_t *bytes,
+                        size_t key);
+
+static mu_hmap_entry_t *find_entry(mu_hmap_t *map,
+                                   const uint8_t *bytes,
+                                   size_t key,
+                                   uint32_t hash);
+
+static mu_hmap_err_t put_entry(mu_hmap_t *map,
+                               const uint8_t *bytes,
+                               size_t key,
+                               uint32_t hash,
+                               void *value);
+
+static mu_hmap_err_t get_entry(mu_hmap_t *map,
+                               const uint8_t *bytes,
+                               size_t key,
+                               uint32_t hash,
+                               void **value);
+
+static mu_hmap_err_t remove_entry(mu_hmap_t *map,
+                                  const uint8_t *bytes,
+                                  size_t key,
+                                  uint32_t hash,
+                                  void **value);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+mu_hmap_t *mu_hmap_init(mu_hmap_t *map,
+                        mu_hmap_entry_t *entries,
+                        size_t capacity) {
+  if ((entries == NULL) || (capacity == 0) ||
+      ((capacity & (capacity - 1)) != 0)) {
+    return NULL;
+  }
+  map->entries = entries;
+  map->capacity = capacity;
+  return mu_hmap_reset(map);
+}
+
+mu_hmap_t *mu_hmap_reset(mu_hmap_t *map) {
+  for (size_t i = 0; i < map->capacity; i++) {
+    map->entries[i].hash = 0;
+  }
+  map->count = 0;
+  return map;
+}
+
+size_t mu_hmap_capacity(mu_hmap_t *map) { return map->capacity; }
+
+size_t mu_hmap_count(mu_hmap_t *map) { return map->count; }
+
+bool mu_hmap_is_empty(mu_hmap_t *map) { return map->count == 0; }
+
+bool mu_hmap_is_full(mu_hmap_t *map) { return map->count == map->capacity; }
+
+mu_hmap_err_t mu_hmap_put(mu_hmap_t *map, uint32_t key, void *value) {
+  return put_entry(map, NULL, key, hash_int(key), value);
+}
+
+mu_hmap_err_t mu_hmap_get(mu_hmap_t *map, uint32_t key, void **value) {
+  return get_entry(map, NULL, key, hash_int(key), value);
+}
+
+bool mu_hmap_contains(mu_hmap_t *map, uint32_t key) {
+  return mu_hmap_get(map, key, NULL) == MU_HMAP_ERR_NONE;
+}
+
+mu_hmap_err_t mu_hmap_remove(mu_hmap_t *map, uint32_t key, void **value) {
+  return remove_entry(map, NULL, key, hash_int(key), value);
+}
+
+mu_hmap_err_t mu_hmap_put_str(mu_hmap_t *map,
+                              const mu_str_t *key,
+                              void *value) {
+  const uint8_t *bytes = mu_str_read_ref(key);
+  size_t len = mu_str_read_available(key);
+  return put_entry(map, bytes, len, hash_bytes(bytes, len), value);
+}
+
+mu_hmap_err_t mu_hmap_get_str(mu_hmap_t *map,
+                              const mu_str_t *key,
+                              void **value) {
+  const uint8_t *bytes = mu_str_read_ref(key);
+  size_t len = mu_str_read_available(key);
+  return get_entry(map, bytes, len, hash_bytes(bytes, len), value);
+}
+
+bool mu_hmap_contains_str(mu_hmap_t *map, const mu_str_t *key) {
+  return mu_hmap_get_str(map, key, NULL) == MU_HMAP_ERR_NONE;
+}
+
+mu_hmap_err_t mu_hmap_remove_str(mu_hmap_t *map,
+                                 const mu_str_t *key,
+                                 void **value) {
+  const uint8_t *bytes = mu_str_read_ref(key);
+  size_t len = mu_str_read_available(key);
+  return remove_entry(map, bytes, len, hash_bytes(bytes, len), value);
+}
+
+void *mu_hmap_traverse(mu_hmap_t *map, mu_hmap_traverse_fn fn, void *arg) {
+  void *result = NULL;
+  for (size_t i = 0; (i < map->capacity) && (result == NULL); i++) {
+    if (map->entries[i].hash != 0) {
+      result = fn(&map->entries[i], arg);
+    }
+  }
+  return result;
+}
+
+// =============================================================================
+// private code
+
+/**
+ * @brief Hash an integer key with the murmur3 finalizer, which spreads
+ * sequential ids (the common case) evenly over the slots.
+ */
+static uint32_t hash_int(uint32_t key) {
+  key ^= key >> 16;
+  key *= 0x85ebca6b;
+  key ^= key >> 13;
+  key *= 0xc2b2ae35;
+  key ^= key >> 16;
+  // A hash of 0 marks an unused slot.
+  return (key == 0) ? 1 : key;
+}
+
+/**
+ * @brief Hash a string key with 32 bit FNV-1a.
+ */
+static uint32_t hash_bytes(const uint8_t *bytes, size_t len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return (hash == 0) ? 1 : hash;
+}
+
+/**
+ * @brief Return how far the slot at index is from the home slot of hash.
+ */
+static size_t probe_distance(mu_hmap_t *map, uint32_t hash, size_t index) {
+  return (index - (hash & (map->capacity - 1))) & (map->capacity - 1);
+}
+
+static bool key_matches(const mu_hmap_entry_t *entry,
+                        const uint8_t *bytes,
+                        size_t key) {
+  if (entry->key != key) {
+    return false;
+  } else if ((bytes == NULL) || (entry->bytes == NULL)) {
+    // integer keys only match integer keys
+    return bytes == entry->bytes;
+  } else {
+    return memcmp(entry->bytes, bytes, key) == 0;
+  }
+}
+
+static mu_hmap_entry_t *find_entry(mu_hmap_t *map,
+                                   const uint8_t *bytes,
+                                   size_t key,
+                                   uint32_t hash) {
+  size_t mask = map->capacity - 1;
+  size_t index = hash & mask;
+
+  for (size_t dist = 0; dist < map->capacity; dist++) {
+    mu_hmap_entry_t *entry = &map->entries[index];
+    if (entry->hash == 0) {
+      return NULL;
+    }
+    // Robin Hood invariant: had the key been present, it would have displaced
+    // any entry that is closer to its own home slot than we are to ours.
+    if (probe_distance(map, entry->hash, index) < dist) {
+      return NULL;
+    }
+    if ((entry->hash == hash) && key_matches(entry, bytes, key)) {
+      return entry;
+    }
+    index = (index + 1) & mask;
+  }
+  return NULL;
+}
+
+static mu_hmap_err_t put_entry(mu_hmap_t *map,
+                               const uint8_t *bytes,
+                               size_t key,
+                               uint32_t hash,
+                               void *value) {
+  mu_hmap_entry_t *found = find_entry(map, bytes, key, hash);
+  if (found != NULL) {
+    found->value = value;
+    return MU_HMAP_ERR_NONE;
+  }
+  if (mu_hmap_is_full(map)) {
+    return MU_HMAP_ERR_FULL;
+  }
+
+  mu_hmap_entry_t pending = {.bytes = bytes,
+                             .key = key,
+                             .value = value,
+                             .hash = hash};
+  size_t mask = map->capacity - 1;
+  size_t index = hash & mask;
+  size_t dist = 0;
+
+  // Walk forward until an unused slot is found, swapping the pending entry
+  // with any entry that is closer to its home slot ("richer") than it is.
+  while (map->entries[index].hash != 0) {
+    mu_hmap_entry_t *entry = &map->entries[index];
+    size_t entry_dist = probe_distance(map, entry->hash, index);
+    if (entry_dist < dist) {
+      mu_hmap_entry_t displaced = *entry;
+      *entry = pending;
+      pending = displaced;
+      dist = entry_dist;
+    }
+    index = (index + 1) & mask;
+    dist += 1;
+  }
+  map->entries[index] = pending;
+  map->count += 1;
+  return MU_HMAP_ERR_NONE;
+}
+
+static mu_hmap_err_t get_entry(mu_hmap_t *map,
+                               const uint8_t *bytes,
+                               size_t key,
+                               uint32_t hash,
+                               void **value) {
+  mu_hmap_entry_t *found = find_entry(map, bytes, key, hash);
+  if (found == NULL) {
+    return MU_HMAP_ERR_NOT_FOUND;
+  }
+  if (value != NULL) {
+    *value = found->value;
+  }
+  return MU_HMAP_ERR_NONE;
+}
+
+static mu_hmap_err_t remove_entry(mu_hmap_t *map,
+                                  const uint8_t *bytes,
+                                  size_t key,
+                                  uint32_t hash,
+                                  void **value) {
+  mu_hmap_entry_t *found = find_entry(map, bytes, key, hash);
+  if (found == NULL) {
+    return MU_HMAP_ERR_NOT_FOUND;
+  }
+  if (value != NULL) {
+    *value = found->value;
+  }
+
+  // Shift the following entries back one slot until reaching an unused slot
+  // or an entry that is already in its home slot.
+  size_t mask = map->capacity - 1;
+  size_t index = found - map->entries;
+  size_t next = (index + 1) & mask;
+  while ((map->entries[next].hash != 0) &&
+         (probe_distance(map, map->entries[next].hash, next) != 0)) {
+    map->entries[index] = map->entries[next];
+    index = next;
+    next = (index + 1) & mask;
+  }
+  map->entries[index].hash = 0;
+  map->count -= 1;
+  return MU_HMAP_ERR_NONE;
+}
@@ -0,0 +1,243 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Fixed-capacity hash map over caller-supplied storage.
+ *
+ * mu_hmap maps keys to void * values in (expected) constant time.  Keys are
+ * either 32 bit integers or strings held in a mu_str_t.  The map never
+ * allocates: the caller supplies an array of mu_hmap_entry_t slots whose
+ * number must be a power of two:
+ *
+ *     static mu_hmap_entry_t s_device_slots[256];
+ *     mu_hmap_init(&s_devices, s_device_slots, 256);
+ *     mu_hmap_put(&s_devices, device_id, &device);
+ *
+ * Collisions are resolved by open addressing with Robin Hood linear probing,
+ * which keeps probe sequences short even when the map is nearly full; removal
+ * shifts the following entries back, so no tombstones accumulate.  Lookups
+ * stay fast up to a load of about 80%, so size the slot array accordingly.
+ *
+ * A string key is stored by reference: the map remembers where the key's
+ * bytes are, not a copy of them, so they must remain valid and unchanged for
+ * as long as the entry is in the map.  Integer and string keys may share a
+ * map; an integer key never matches a string key.
+ *
+ * mu_hmap is not interrupt safe: calls on the same map must not be made
+ * concurrently from interrupt and foreground levels.
+ */
+
+#ifndef _MU_HMAP_H_
+#define _MU_HMAP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_str.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  MU_HMAP_ERR_NONE,
+  MU_HMAP_ERR_FULL,
+  MU_HMAP_ERR_NOT_FOUND,
+} mu_hmap_err_t;
+
+/**
+ * @brief One slot of a hash map.  Treat the fields as private, except that
+ * a traverse function may read and update value.
+ */
+typedef struct {
+  const uint8_t *bytes; // bytes of a string key, or NULL for an integer key
+  size_t key;           // an integer key, or the length of a string key
+  void *value;          // the value associated with the key
+  uint32_t hash;        // hash of the key, or 0 if the slot is unused
+} mu_hmap_entry_t;
+
+typedef struct {
+  mu_hmap_entry_t *entries; // caller-supplied slots
+  size_t capacity;          // number of slots, a power of two
+  size_t count;             // number of slots in use
+} mu_hmap_t;
+
+/**
+ * @brief Signature for a function passed to mu_hmap_traverse.
+ *
+ * @param entry An entry in the map.
+ * @param arg A user-supplied argument.
+ * @return A NULL value to continue traversing, a non-null value to stop.
+ */
+typedef void *(*mu_hmap_traverse_fn)(mu_hmap_entry_t *entry, void *arg);
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize an empty hash map over caller-supplied slots.
+ *
+ * @param map The map to initialize.
+ * @param entries An array of capacity slots.
+ * @param capacity The number of slots.  Must be a non-zero power of two.
+ * @return map on success, or NULL if capacity is not a power of two.
+ */
+mu_hmap_t *mu_hmap_init(mu_hmap_t *map,
+                        mu_hmap_entry_t *entries,
+                        size_t capacity);
+
+/**
+ * @brief Remove all entries from the map.
+ */
+mu_hmap_t *mu_hmap_reset(mu_hmap_t *map);
+
+/**
+ * @brief Return the number of slots in the map.
+ */
+size_t mu_hmap_capacity(mu_hmap_t *map);
+
+/**
+ * @brief Return the number of entries in the map.
+ */
+size_t mu_hmap_count(mu_hmap_t *map);
+
+/**
+ * @brief Return true if the map has no entries.
+ */
+bool mu_hmap_is_empty(mu_hmap_t *map);
+
+/**
+ * @brief Return true if every slot in the map is in use.
+ */
+bool mu_hmap_is_full(mu_hmap_t *map);
+
+/**
+ * @brief Associate a value with an integer key, replacing any previous value.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value The value to store.
+ * @return MU_HMAP_ERR_FULL if the key is new and the map is full,
+ *         MU_HMAP_ERR_NONE otherwise.
+ */
+mu_hmap_err_t mu_hmap_put(mu_hmap_t *map, uint32_t key, void *value);
+
+/**
+ * @brief Look up the value associated with an integer key.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value If non-NULL, receives the value when the key is found.
+ * @return MU_HMAP_ERR_NOT_FOUND if the key is not in the map,
+ *         MU_HMAP_ERR_NONE otherwise.
+ */
+mu_hmap_err_t mu_hmap_get(mu_hmap_t *map, uint32_t key, void **value);
+
+/**
+ * @brief Return true if an integer key is in the map.
+ */
+bool mu_hmap_contains(mu_hmap_t *map, uint32_t key);
+
+/**
+ * @brief Remove an integer key and its value from the map.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value If non-NULL, receives the removed value when the key is found.
+ * @return MU_HMAP_ERR_NOT_FOUND if the key is not in the map,
+ *         MU_HMAP_ERR_NONE otherwise.
+ */
+mu_hmap_err_t mu_hmap_remove(mu_hmap_t *map, uint32_t key, void **value);
+
+/**
+ * @brief Associate a value with a string key, replacing any previous value.
+ *
+ * The key is the readable portion of the mu_str_t.  Only a reference to its
+ * bytes is stored, not the mu_str_t itself.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value The value to store.
+ * @return MU_HMAP_ERR_FULL if the key is new and the map is full,
+ *         MU_HMAP_ERR_NONE otherwise.
+ */
+mu_hmap_err_t mu_hmap_put_str(mu_hmap_t *map,
+                              const mu_str_t *key,
+                              void *value);
+
+/**
+ * @brief Look up the value associated with a string key.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value If non-NULL, receives the value when the key is found.
+ * @return MU_HMAP_ERR_NOT_FOUND if the key is not in the map,
+ *         MU_HMAP_ERR_NONE otherwise.
+ */
+mu_hmap_err_t mu_hmap_get_str(mu_hmap_t *map,
+                              const mu_str_t *key,
+                              void **value);
+
+/**
+ * @brief Return true if a string key is in the map.
+ */
+bool mu_hmap_contains_str(mu_hmap_t *map, const mu_str_t *key);
+
+/**
+ * @brief Remove a string key and its value from the map.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value If non-NULL, receives the removed value when the key is found.
+ * @return MU_HMAP_ERR_NOT_FOUND if the key is not in the map,
+ *         MU_HMAP_ERR_NONE otherwise.
+ */
+mu_hmap_err_t mu_hmap_remove_str(mu_hmap_t *map,
+                                 const mu_str_t *key,
+                                 void **value);
+
+/**
+ * @brief Call fn with each entry in the map, in no particular order, stopping
+ * when fn returns a non-NULL value.
+ *
+ * fn may update entry->value but must not add or remove entries.
+ *
+ * @param map The map.
+ * @param fn The function to call on each entry.
+ * @param arg A user-supplied argument, passed as the second argument to fn.
+ * @return The final value returned from fn.
+ */
+void *mu_hmap_traverse(mu_hmap_t *map, mu_hmap_traverse_fn fn, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _MU_HMAP_H_ */
@@ -123,6 +123,50 @@ mu_list_t *mu_list_next_element(mu_list_t *element) {
   return element->next;
 }
 
+// =============================================================================
+// counted list operations
+
+mu_list_counted_t *mu_list_counted_init(mu_list_counted_t *list) {
+  mu_list_init(&list->head);
+  list->count = 0;
+  return list;
+}
+
+mu_list_t *mu_list_counted_head(mu_list_counted_t *list) {
+  return &list->head;
+}
+
+size_t mu_list_counted_length(mu_list_counted_t *list) {
+  return list->count;
+}
+
+bool mu_list_counted_is_empty(mu_list_counted_t *list) {
+  return list->count == 0;
+}
+
+mu_list_counted_t *mu_list_counted_push(mu_list_counted_t *list,
+                                        mu_list_t *element) {
+  mu_list_push(&list->head, element);
+  list->count += 1;
+  return list;
+}
+
+mu_list_t *mu_list_counted_pop(mu_list_counted_t *list) {
+  mu_list_t *element = mu_list_pop(&list->head);
+  if (element != NULL) {
+    list->count -= 1;
+  }
+  return element;
+}
+
+mu_list_t *mu_list_counted_delete(mu_list_counted_t *list, mu_list_t *element) {
+  mu_list_t *deleted = mu_list_delete(&list->head, element);
+  if (deleted != NULL) {
+    list->count -= 1;
+  }
+  return deleted;
+}
+
 // =============================================================================
 // local (static) code
 
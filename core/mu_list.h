@@ -68,6 +68,13 @@
  * approach simplifies the code, especially operations that modify the first (or
  * last) items in the list.  It also makes finding the first and last elements
  * of the list especially fast.
+ *
+ * # counted lists
+ *
+ * mu_list_length() walks the entire list.  A mu_list_counted_t wraps a list
+ * head with an element count that the mu_list_counted_xxx() functions maintain
+ * on push, pop and delete, making mu_list_counted_length() O(1).  Read-only
+ * operations can be applied to the result of mu_list_counted_head().
  */
 
 #ifndef _MU_LIST_H_
@@ -99,6 +106,14 @@ typedef struct _mu_list {
  */
 typedef void *(*mu_list_traverse_fn)(mu_list_t *prev, void *arg);
 
+/**
+ * @brief A list head that keeps track of the number of elements in the list.
+ */
+typedef struct {
+  mu_list_t head;  // the underlying list head
+  size_t count;    // number of elements in the list
+} mu_list_counted_t;
+
 /**
  * @brief Given a pointer to a structure and the name of the slot containing a
  * mu_list_t, return a pointer to the mu_list_t.
@@ -220,6 +235,68 @@ void *mu_list_traverse(mu_list_t *list, mu_list_traverse_fn fn, void *arg);
  */
 mu_list_t *mu_list_next_element(mu_list_t *element);
 
+// =============================================================================
+// counted list operations
+
+/**
+ * @brief Initialize a counted list head.
+ *
+ * @param list A pointer to the counted list head.
+ * @return list
+ */
+mu_list_counted_t *mu_list_counted_init(mu_list_counted_t *list);
+
+/**
+ * @brief Return the underlying list head of a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The plain list head, suitable for read-only mu_list_xxx() calls.
+ */
+mu_list_t *mu_list_counted_head(mu_list_counted_t *list);
+
+/**
+ * @brief Return the number of elements in a counted list in constant time.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The number of elements in the list.
+ */
+size_t mu_list_counted_length(mu_list_counted_t *list);
+
+/**
+ * @brief Return true if a counted list has no elements.
+ *
+ * @param list A pointer to the counted list head.
+ * @return true if the list contains no elements.
+ */
+bool mu_list_counted_is_empty(mu_list_counted_t *list);
+
+/**
+ * @brief Push an item onto the head of a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param element A pointer to a list item.
+ * @return list
+ */
+mu_list_counted_t *mu_list_counted_push(mu_list_counted_t *list,
+                                        mu_list_t *element);
+
+/**
+ * @brief Remove the first element from a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @return The element removed, or NULL if the list is empty.
+ */
+mu_list_t *mu_list_counted_pop(mu_list_counted_t *list);
+
+/**
+ * @brief Delete an element from a counted list.
+ *
+ * @param list A pointer to the counted list head.
+ * @param element A pointer the element to delete.
+ * @return the element removed from the list, or NULL if it was not in the list
+ */
+mu_list_t *mu_list_counted_delete(mu_list_counted_t *list, mu_list_t *element);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,9 +30,12 @@
 
 #ifdef MU_LOG_ENABLED // rest of file...
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 // =============================================================================
 // private types and definitions
@@ -42,6 +45,77 @@ typedef struct {
   mu_log_level_t threshold;
 } subscriber_t;
 
+// Active threshold when there are no subscribers: above every level.
+#define NO_THRESHOLD ((mu_log_level_t)(MU_LOG_CRITICAL_LEVEL + 1))
+
+// The argument passed to broadcast().
+typedef struct {
+  mu_log_level_t severity;
+  const char *message;
+} broadcast_t;
+
+#if (MU_LOG_DEFERRED)
+
+// A captured argument.  Integers are widened to intmax_t or uintmax_t and
+// floating point values to double.
+typedef union {
+  intmax_t i;
+  uintmax_t u;
+  double d;
+  const void *p;
+} deferred_arg_t;
+
+typedef struct {
+  const char *fmt;
+  const mu_log_module_t *module; // or NULL
+  uint8_t severity;
+  uint8_t n_args;
+  deferred_arg_t args[MU_LOG_DEFERRED_MAX_ARGS];
+} deferred_record_t;
+
+// One slot of the deferred ring.  The ring uses the same sequence-numbered
+// cells as mu_mpsc, but with a record in place of the pointer-sized item.
+typedef struct {
+  volatile uint16_t seq;
+  deferred_record_t record;
+} deferred_cell_t;
+
+typedef struct {
+  deferred_cell_t cells[MU_LOG_DEFERRED_QUEUE_SIZE];
+  volatile uint16_t tail;  // next position to be claimed by a producer
+  volatile uint16_t head;  // next position to be claimed by a consumer
+  volatile uint32_t dropped_count;
+} deferred_ring_t;
+
+#define DEFERRED_MASK (MU_LOG_DEFERRED_QUEUE_SIZE - 1)
+
+#if ((MU_LOG_DEFERRED_QUEUE_SIZE & DEFERRED_MASK) != 0) ||                     \
+    (MU_LOG_DEFERRED_QUEUE_SIZE < 2) || (MU_LOG_DEFERRED_QUEUE_SIZE > 0x8000)
+#error "MU_LOG_DEFERRED_QUEUE_SIZE must be a power of two from 2 to 32768"
+#endif
+
+// The kind of argument a conversion specifier consumes.
+typedef enum {
+  ARG_NONE,     // %% or an unsupported conversion
+  ARG_SIGNED,   // d i
+  ARG_UNSIGNED, // u o x X c
+  ARG_DOUBLE,   // f F e E g G a A
+  ARG_POINTER,  // s p
+} arg_kind_t;
+
+// A parsed conversion specifier.
+typedef struct {
+  const char *start; // the '%'
+  const char *end;   // one past the conversion character
+  bool star_width;
+  bool star_precision;
+  char length[3];    // length modifier, e.g. "l" or "ll"
+  char conversion;
+  arg_kind_t kind;
+} conversion_t;
+
+#endif // #if (MU_LOG_DEFERRED)
+
 // =============================================================================
 // private declarations
 
@@ -55,14 +129,83 @@ static void *function_matches(void *a, void *b);
  * @brief Call subscriber's function with a logging message.
  *
  * If the severity equals or exceeds the subscriber's threshold, call the
- * subscriber's function with s_message.
+ * subscriber's function with the message.
  *
  * @param subscriber Pointer to a subscriber object.
- * @param arg Pointer to the severity of the current log message.
+ * @param arg Pointer to a broadcast_t holding the severity and message.
  * @return Returns NULL in order for mu_vect_traverse to visit all elements.
  */
 static void *broadcast(void *subscriber, void *arg);
 
+/**
+ * @brief Recompute s_active_threshold from the subscribers.
+ */
+static void update_active_threshold(void);
+
+/**
+ * @brief Common body of mu_log_message() and mu_log_module_message(), called
+ * once the message is known to be wanted.
+ */
+static void log_message_v(const mu_log_module_t *module,
+                          mu_log_level_t severity,
+                          const char *fmt,
+                          va_list ap);
+
+/**
+ * @brief Write the module prefix (if any) to the start of dst (which holds
+ * MU_LOG_MAX_MESSAGE_LENGTH bytes) and return its length.
+ */
+static size_t format_prefix(char *dst, const mu_log_module_t *module);
+
+/**
+ * @brief Format into dst (avail > 0 bytes) with vsnprintf() or, if so
+ * configured, mu_str_vformat().  Always null terminates, and returns the number
+ * of characters actually written, not counting the null.
+ */
+static size_t log_vformat(char *dst, size_t avail, const char *fmt, va_list ap);
+
+static size_t log_format(char *dst, size_t avail, const char *fmt, ...);
+
+#if (MU_LOG_DEFERRED)
+
+/**
+ * @brief Capture a message into the deferred ring.  Safe to call from any
+ * context.
+ */
+static void deferred_put(const mu_log_module_t *module,
+                         mu_log_level_t severity,
+                         const char *fmt,
+                         va_list ap);
+
+/**
+ * @brief Remove the oldest record from the deferred ring.  Safe to call from
+ * any context: each record is claimed by exactly one caller.
+ */
+static bool deferred_get(deferred_record_t *record);
+
+/**
+ * @brief Format a captured record into message, which holds
+ * MU_LOG_MAX_MESSAGE_LENGTH bytes.
+ */
+static void deferred_format(char *message, const deferred_record_t *record);
+
+/**
+ * @brief Parse the conversion specifier starting at the '%' at p.
+ */
+static const char *parse_conversion(const char *p, conversion_t *conv);
+
+/**
+ * @brief Format every pending record into message and broadcast it.
+ */
+static void deferred_drain(char *message);
+
+/**
+ * @brief The log task: drain the ring.
+ */
+static void deferred_task_fn(void *ctx, void *arg);
+
+#endif // #if (MU_LOG_DEFERRED)
+
 // =============================================================================
 // local storage
 
@@ -71,6 +214,16 @@ static subscriber_t s_subscribers_store[MU_LOG_MAX_SUBSCRIBERS];
 
 static char s_message[MU_LOG_MAX_MESSAGE_LENGTH];
 
+// The lowest threshold among the subscribers
+static mu_log_level_t s_active_threshold = NO_THRESHOLD;
+
+#if (MU_LOG_DEFERRED)
+static deferred_ring_t s_deferred;
+static mu_task_t s_deferred_task;
+// mu_log_flush() may interrupt the log task, so it formats into its own buffer.
+static char s_flush_message[MU_LOG_MAX_MESSAGE_LENGTH];
+#endif
+
 #undef DEFINE_MU_LOG_LEVEL
 #define DEFINE_MU_LOG_LEVEL(level, name) name,
 const char * const s_level_names[] = {
@@ -83,6 +236,18 @@ const char * const s_level_names[] = {
 
 void mu_log_init() {
   mu_vect_init(&s_subscribers, s_subscribers_store, MU_LOG_MAX_SUBSCRIBERS, sizeof(subscriber_t));
+  s_active_threshold = NO_THRESHOLD;
+#if (MU_LOG_DEFERRED)
+  for (uint16_t i = 0; i < MU_LOG_DEFERRED_QUEUE_SIZE; i++) {
+    s_deferred.cells[i].seq = i;
+  }
+  s_deferred.head = 0;
+  s_deferred.tail = 0;
+  s_deferred.dropped_count = 0;
+  mu_task_init(&s_deferred_task, deferred_task_fn, NULL, "mu_log");
+  // Run after everything else that is runnable.
+  mu_task_set_priority(&s_deferred_task, MU_TASK_PRIORITY_LEVELS - 1);
+#endif
 }
 
 // install or update a subscriber
@@ -94,6 +259,7 @@ mu_log_err_t mu_log_subscribe(mu_log_function_t fn, mu_log_level_t threshold) {
   if (mu_vect_push(&s_subscribers, &s) == MU_VECT_ERR_FULL) {
     return MU_LOG_ERR_SUBSCRIBERS_EXCEEDED;
   } else {
+    update_active_threshold();
     return MU_LOG_ERR_NONE;
   }
 }
@@ -103,6 +269,7 @@ mu_log_err_t mu_log_unsubscribe(mu_log_function_t fn) {
   int index = mu_vect_find_index(&s_subscribers, function_matches, &s);
   // No need to check for negative index: mu_vect_delete_at does that.
   mu_vect_delete_at(&s_subscribers, index, NULL);
+  update_active_threshold();
   return MU_LOG_ERR_NONE;
 }
 
@@ -116,11 +283,58 @@ const char *mu_log_level_name(mu_log_level_t severity) {
 
 void mu_log_message(mu_log_level_t severity, const char *fmt, ...) {
   va_list ap;
+
+  if (severity < s_active_threshold) {
+    return; // no subscriber wants it: skip the formatting
+  }
+  va_start(ap, fmt);
+  log_message_v(NULL, severity, fmt, ap);
+  va_end(ap);
+}
+
+void mu_log_module_message(const mu_log_module_t *module,
+                           mu_log_level_t severity,
+                           const char *fmt,
+                           ...) {
+  va_list ap;
+
+  if ((severity < module->threshold) || (severity < s_active_threshold)) {
+    return;
+  }
   va_start(ap, fmt);
-  vsnprintf(s_message, MU_LOG_MAX_MESSAGE_LENGTH, fmt, ap);
+  log_message_v(module, severity, fmt, ap);
   va_end(ap);
+}
+
+mu_log_module_t *mu_log_module_init(mu_log_module_t *module,
+                                    const char *name,
+                                    mu_log_level_t threshold) {
+  module->name = name;
+  module->threshold = threshold;
+  return module;
+}
 
-  mu_vect_traverse(&s_subscribers, broadcast, &severity);
+void mu_log_module_set_threshold(mu_log_module_t *module,
+                                 mu_log_level_t threshold) {
+  module->threshold = threshold;
+}
+
+mu_log_level_t mu_log_active_threshold(void) {
+  return s_active_threshold;
+}
+
+void mu_log_flush(void) {
+#if (MU_LOG_DEFERRED)
+  deferred_drain(s_flush_message);
+#endif
+}
+
+uint32_t mu_log_dropped_count(void) {
+#if (MU_LOG_DEFERRED)
+  return mu_atomic_load_u32(&s_deferred.dropped_count);
+#else
+  return 0;
+#endif
 }
 
 // =============================================================================
@@ -132,14 +346,375 @@ static void *function_matches(void *a, void *b) {
   return as->fn == bs->fn ? a : NULL;
 }
 
+static void update_active_threshold(void) {
+  mu_log_level_t threshold = NO_THRESHOLD;
+
+  for (size_t i = 0; i < mu_vect_count(&s_subscribers); i++) {
+    subscriber_t *s = (subscriber_t *)mu_vect_ref(&s_subscribers, i);
+    if (s->threshold < threshold) {
+      threshold = s->threshold;
+    }
+  }
+  s_active_threshold = threshold;
+}
+
+static void log_message_v(const mu_log_module_t *module,
+                          mu_log_level_t severity,
+                          const char *fmt,
+                          va_list ap) {
+#if (MU_LOG_DEFERRED)
+  deferred_put(module, severity, fmt, ap);
+  // Coalesces with any post that the log task has not yet serviced.
+  mu_sched_isr_task_now(&s_deferred_task);
+#else
+  broadcast_t b = {.severity = severity, .message = s_message};
+  size_t len = format_prefix(s_message, module);
+  log_vformat(&s_message[len], MU_LOG_MAX_MESSAGE_LENGTH - len, fmt, ap);
+  mu_vect_traverse(&s_subscribers, broadcast, &b);
+#endif
+}
+
+static size_t format_prefix(char *dst, const mu_log_module_t *module) {
+  if (module == NULL) {
+    return 0;
+  }
+  return log_format(dst, MU_LOG_MAX_MESSAGE_LENGTH, "%s: ", module->name);
+}
+
+static size_t log_vformat(char *dst, size_t avail, const char *fmt, va_list ap) {
+#if (MU_LOG_USE_MU_STR_FORMAT)
+  mu_strbuf_t buf;
+  mu_str_t str;
+  size_t written;
+
+  // reserve the last byte for the null
+  mu_strbuf_init_wr(&buf, (uint8_t *)dst, avail - 1);
+  mu_str_init_for_write(&str, &buf);
+  written = mu_str_vformat(&str, fmt, ap);
+  dst[written] = '\0';
+  return written;
+#else
+  int written = vsnprintf(dst, avail, fmt, ap);
+
+  if (written < 0) {
+    dst[0] = '\0';
+    return 0;
+  }
+  // vsnprintf returns the length it *would* have written
+  return ((size_t)written < avail) ? (size_t)written : avail - 1;
+#endif
+}
+
+static size_t log_format(char *dst, size_t avail, const char *fmt, ...) {
+  size_t written;
+  va_list ap;
+
+  va_start(ap, fmt);
+  written = log_vformat(dst, avail, fmt, ap);
+  va_end(ap);
+  return written;
+}
+
 static void *broadcast(void *subscriber, void *arg) {
   subscriber_t *s = (subscriber_t *)subscriber;
-  mu_log_level_t *severity = (mu_log_level_t *)arg;
+  broadcast_t *b = (broadcast_t *)arg;
 
-  if (*severity >= s->threshold) {
-    s->fn(*severity, s_message);
+  if (b->severity >= s->threshold) {
+    s->fn(b->severity, b->message);
   }
   return NULL;
 }
 
+#if (MU_LOG_DEFERRED)
+
+static void deferred_put(const mu_log_module_t *module,
+                         mu_log_level_t severity,
+                         const char *fmt,
+                         va_list ap) {
+  uint16_t pos = mu_atomic_load_u16(&s_deferred.tail);
+  deferred_cell_t *cell;
+
+  // Claim a cell exactly as mu_mpsc_put() does.
+  for (;;) {
+    cell = &s_deferred.cells[pos & DEFERRED_MASK];
+    int16_t dif = (int16_t)(mu_atomic_load_u16(&cell->seq) - pos);
+    if (dif == 0) {
+      if (mu_atomic_cas_u16(&s_deferred.tail, &pos, pos + 1)) {
+        break;
+      }
+    } else if (dif < 0) {
+      mu_atomic_fetch_add_u32(&s_deferred.dropped_count, 1);
+      return;
+    } else {
+      pos = mu_atomic_load_u16(&s_deferred.tail);
+    }
+  }
+
+  // Capture the arguments by walking the format string.
+  deferred_record_t *record = &cell->record;
+  const char *p = fmt;
+  uint8_t n = 0;
+
+  record->fmt = fmt;
+  record->module = module;
+  record->severity = severity;
+  while ((p = strchr(p, '%')) != NULL) {
+    conversion_t conv;
+    p = parse_conversion(p, &conv);
+    int needed = conv.star_width + conv.star_precision +
+                 (conv.kind != ARG_NONE);
+    if (n + needed > MU_LOG_DEFERRED_MAX_ARGS) {
+      break;
+    }
+    if (conv.star_width) {
+      record->args[n++].i = va_arg(ap, int);
+    }
+    if (conv.star_precision) {
+      record->args[n++].i = va_arg(ap, int);
+    }
+    switch (conv.kind) {
+    case ARG_SIGNED:
+      if (strcmp(conv.length, "ll") == 0) {
+        record->args[n++].i = va_arg(ap, long long);
+      } else if (strcmp(conv.length, "l") == 0) {
+        record->args[n++].i = va_arg(ap, long);
+      } else if (strcmp(conv.length, "j") == 0) {
+        record->args[n++].i = va_arg(ap, intmax_t);
+      } else if (strcmp(conv.length, "z") == 0) {
+        record->args[n++].i = (intmax_t)va_arg(ap, size_t);
+      } else if (strcmp(conv.length, "t") == 0) {
+        record->args[n++].i = va_arg(ap, ptrdiff_t);
+      } else if (strcmp(conv.length, "hh") == 0) {
+        record->args[n++].i = (signed char)va_arg(ap, int);
+      } else if (strcmp(conv.length, "h") == 0) {
+        record->args[n++].i = (short)va_arg(ap, int);
+      } else {
+        record->args[n++].i = va_arg(ap, int);
+      }
+      break;
+    case ARG_UNSIGNED:
+      if (strcmp(conv.length, "ll") == 0) {
+        record->args[n++].u = va_arg(ap, unsigned long long);
+      } else if (strcmp(conv.length, "l") == 0) {
+        record->args[n++].u = va_arg(ap, unsigned long);
+      } else if (strcmp(conv.length, "j") == 0) {
+        record->args[n++].u = va_arg(ap, uintmax_t);
+      } else if (strcmp(conv.length, "z") == 0) {
+        record->args[n++].u = va_arg(ap, size_t);
+      } else if (strcmp(conv.length, "t") == 0) {
+        record->args[n++].u = (uintmax_t)va_arg(ap, ptrdiff_t);
+      } else if (strcmp(conv.length, "hh") == 0) {
+        record->args[n++].u = (unsigned char)va_arg(ap, unsigned int);
+      } else if (strcmp(conv.length, "h") == 0) {
+        record->args[n++].u = (unsigned short)va_arg(ap, unsigned int);
+      } else {
+        record->args[n++].u = va_arg(ap, unsigned int);
+      }
+      break;
+    case ARG_DOUBLE:
+      if (strcmp(conv.length, "L") == 0) {
+        record->args[n++].d = (double)va_arg(ap, long double);
+      } else {
+        record->args[n++].d = va_arg(ap, double);
+      }
+      break;
+    case ARG_POINTER:
+      record->args[n++].p = va_arg(ap, const void *);
+      break;
+    case ARG_NONE:
+      break;
+    }
+  }
+  record->n_args = n;
+
+  // Publish the record.
+  mu_atomic_store_u16(&cell->seq, pos + 1);
+}
+
+static bool deferred_get(deferred_record_t *record) {
+  uint16_t pos = mu_atomic_load_u16(&s_deferred.head);
+  deferred_cell_t *cell;
+
+  // mu_log_flush() may interrupt the log task part way through a drain, so
+  // records are claimed with a CAS on head, as producers claim cells with a
+  // CAS on tail.  The record is copied before the claim: the cell can't be
+  // reused until its claimant releases it, and a caller that loses the claim
+  // discards its copy and retries.
+  for (;;) {
+    cell = &s_deferred.cells[pos & DEFERRED_MASK];
+    if (mu_atomic_load_u16(&cell->seq) != (uint16_t)(pos + 1)) {
+      return false;
+    }
+    *record = cell->record;
+    if (mu_atomic_cas_u16(&s_deferred.head, &pos, pos + 1)) {
+      break;
+    }
+  }
+  mu_atomic_store_u16(&cell->seq, pos + MU_LOG_DEFERRED_QUEUE_SIZE);
+  return true;
+}
+
+static void deferred_format(char *message, const deferred_record_t *record) {
+  const char *p = record->fmt;
+  size_t len = format_prefix(message, record->module);
+  uint8_t n = 0;
+
+  while (*p != '\0' && len < MU_LOG_MAX_MESSAGE_LENGTH - 1) {
+    const char *pct = strchr(p, '%');
+    size_t literal = (pct == NULL) ? strlen(p) : (size_t)(pct - p);
+    if (literal > MU_LOG_MAX_MESSAGE_LENGTH - 1 - len) {
+      literal = MU_LOG_MAX_MESSAGE_LENGTH - 1 - len;
+    }
+    memcpy(&message[len], p, literal);
+    len += literal;
+    if (pct == NULL) {
+      break;
+    }
+
+    conversion_t conv;
+    p = parse_conversion(pct, &conv);
+    int needed = conv.star_width + conv.star_precision +
+                 (conv.kind != ARG_NONE);
+    if (n + needed > record->n_args) {
+      // arguments beyond MU_LOG_DEFERRED_MAX_ARGS were not captured
+      break;
+    }
+
+    // Rebuild the specifier with any '*' replaced by its captured value and
+    // the length modifier replaced to match the widened argument.
+    char spec[32];
+    size_t k = 0;
+    const char *q = conv.start;
+    while (q < conv.end && k < sizeof(spec) - 12) {
+      if (*q == '*') {
+        int value = (int)record->args[n++].i;
+        if (q > conv.start && q[-1] == '.' && value < 0) {
+          // A negative '*' precision is taken as if it were omitted, but
+          // ".-1" would read as a '-' flag: drop the '.' instead.
+          k--;
+        } else {
+          k += log_format(&spec[k], sizeof(spec) - k, "%d", value);
+        }
+        q++;
+      } else if (strchr("hljztL", *q) != NULL) {
+        q++; // dropped: see below
+      } else if (q == conv.end - 1) {
+        break;
+      } else {
+        spec[k++] = *q++;
+      }
+    }
+    if ((conv.kind == ARG_SIGNED || conv.kind == ARG_UNSIGNED) &&
+        (conv.conversion != 'c')) {
+      spec[k++] = 'j';
+    }
+    spec[k++] = conv.conversion;
+    spec[k] = '\0';
+
+    char *dst = &message[len];
+    size_t avail = MU_LOG_MAX_MESSAGE_LENGTH - len;
+    size_t written = 0;
+    switch (conv.kind) {
+    case ARG_SIGNED:
+      written = log_format(dst, avail, spec, record->args[n++].i);
+      break;
+    case ARG_UNSIGNED:
+      if (conv.conversion == 'c') {
+        written = log_format(dst, avail, spec, (int)record->args[n++].u);
+      } else {
+        written = log_format(dst, avail, spec, record->args[n++].u);
+      }
+      break;
+    case ARG_DOUBLE:
+      written = log_format(dst, avail, spec, record->args[n++].d);
+      break;
+    case ARG_POINTER:
+      written = log_format(dst, avail, spec, record->args[n++].p);
+      break;
+    case ARG_NONE:
+      if (conv.conversion == '%') {
+        written = log_format(dst, avail, "%%");
+      }
+      break;
+    }
+    len += written;
+  }
+  message[len] = '\0';
+}
+
+static const char *parse_conversion(const char *p, conversion_t *conv) {
+  size_t n = 0;
+
+  memset(conv, 0, sizeof(conversion_t));
+  conv->start = p++;
+  while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+    p++;
+  }
+  if (*p == '*') {
+    conv->star_width = true;
+    p++;
+  }
+  while (*p >= '0' && *p <= '9') {
+    p++;
+  }
+  if (*p == '.') {
+    p++;
+    if (*p == '*') {
+      conv->star_precision = true;
+      p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+      p++;
+    }
+  }
+  while (*p != '\0' && strchr("hljztL", *p) != NULL && n < 2) {
+    conv->length[n++] = *p++;
+  }
+  conv->conversion = *p;
+  if (*p != '\0') {
+    p++;
+  }
+  conv->end = p;
+
+  switch (conv->conversion) {
+  case 'd': case 'i':
+    conv->kind = ARG_SIGNED;
+    break;
+  case 'u': case 'o': case 'x': case 'X': case 'c':
+    conv->kind = ARG_UNSIGNED;
+    break;
+  case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a':
+  case 'A':
+    conv->kind = ARG_DOUBLE;
+    break;
+  case 's': case 'p':
+    conv->kind = ARG_POINTER;
+    break;
+  default:
+    // %% and unsupported conversions (such as %n) consume no argument
+    conv->kind = ARG_NONE;
+    break;
+  }
+  return p;
+}
+
+static void deferred_drain(char *message) {
+  deferred_record_t record;
+  broadcast_t b = {.message = message};
+
+  while (deferred_get(&record)) {
+    b.severity = (mu_log_level_t)record.severity;
+    deferred_format(message, &record);
+    mu_vect_traverse(&s_subscribers, broadcast, &b);
+  }
+}
+
+static void deferred_task_fn(void *ctx, void *arg) {
+  (void)ctx;
+  (void)arg;
+  deferred_drain(s_message);
+}
+
+#endif // #if (MU_LOG_DEFERRED)
+
 #endif // #ifdef MU_LOG_ENABLED
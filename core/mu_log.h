@@ -32,6 +32,7 @@ extern "C" {
 // =============================================================================
 // includes
 
+#include <stdint.h>
 
 // =============================================================================
 // types and definitions
@@ -139,29 +140,73 @@ typedef enum {
 //#define MU_LOG_ENABLED 1
 
 
+// Messages below MU_LOG_MIN_LEVEL are removed at compile time: the call and
+// the evaluation of its arguments vanish from the image.  For example, add
+// -DMU_LOG_MIN_LEVEL=MU_LOG_INFO_LEVEL to drop all TRACE and DEBUG messages.
+#ifndef MU_LOG_MIN_LEVEL
+#define MU_LOG_MIN_LEVEL MU_LOG_TRACE_LEVEL
+#endif
+
 #if (MU_LOG_ENABLED)
   #define MU_LOG_INIT() mu_log_init()
   #define MU_LOG_SUBSCRIBE(a, b) mu_log_subscribe(a, b)
   #define MU_LOG_UNSUBSCRIBE(a) mu_log_unsubscribe(a)
   #define MU_LOG_LEVEL_NAME(a) mu_log_level_name(a)
-  #define MU_LOG_TRACE(...) mu_log_message(MU_LOG_TRACE_LEVEL, __VA_ARGS__)
-  #define MU_LOG_DEBUG(...) mu_log_message(MU_LOG_DEBUG_LEVEL, __VA_ARGS__)
-  #define MU_LOG_INFO(...) mu_log_message(MU_LOG_INFO_LEVEL, __VA_ARGS__)
-  #define MU_LOG_WARN(...) mu_log_message(MU_LOG_WARN_LEVEL, __VA_ARGS__)
-  #define MU_LOG_ERROR(...) mu_log_message(MU_LOG_ERROR_LEVEL, __VA_ARGS__)
-  #define MU_LOG_CRITICAL(...) mu_log_message(MU_LOG_CRITICAL_LEVEL, __VA_ARGS__)
+  // The first comparison is between constants, so the compiler discards the
+  // call entirely when level is below MU_LOG_MIN_LEVEL.  The second skips the
+  // call (and the evaluation of its arguments) when no subscriber wants it.
+  #define MU_LOG_AT_LEVEL(level, ...) \
+    do { \
+      if (((level) >= MU_LOG_MIN_LEVEL) && \
+          ((level) >= mu_log_active_threshold())) { \
+        mu_log_message((level), __VA_ARGS__); \
+      } \
+    } while (0)
+  #define MU_LOG_MODULE_AT_LEVEL(module, level, ...) \
+    do { \
+      if (((level) >= MU_LOG_MIN_LEVEL) && \
+          ((level) >= mu_log_active_threshold())) { \
+        mu_log_module_message((module), (level), __VA_ARGS__); \
+      } \
+    } while (0)
+  #define MU_LOG_TRACE(...) MU_LOG_AT_LEVEL(MU_LOG_TRACE_LEVEL, __VA_ARGS__)
+  #define MU_LOG_DEBUG(...) MU_LOG_AT_LEVEL(MU_LOG_DEBUG_LEVEL, __VA_ARGS__)
+  #define MU_LOG_INFO(...) MU_LOG_AT_LEVEL(MU_LOG_INFO_LEVEL, __VA_ARGS__)
+  #define MU_LOG_WARN(...) MU_LOG_AT_LEVEL(MU_LOG_WARN_LEVEL, __VA_ARGS__)
+  #define MU_LOG_ERROR(...) MU_LOG_AT_LEVEL(MU_LOG_ERROR_LEVEL, __VA_ARGS__)
+  #define MU_LOG_CRITICAL(...) MU_LOG_AT_LEVEL(MU_LOG_CRITICAL_LEVEL, __VA_ARGS__)
+  #define MU_LOG_MODULE_TRACE(m, ...) \
+    MU_LOG_MODULE_AT_LEVEL(m, MU_LOG_TRACE_LEVEL, __VA_ARGS__)
+  #define MU_LOG_MODULE_DEBUG(m, ...) \
+    MU_LOG_MODULE_AT_LEVEL(m, MU_LOG_DEBUG_LEVEL, __VA_ARGS__)
+  #define MU_LOG_MODULE_INFO(m, ...) \
+    MU_LOG_MODULE_AT_LEVEL(m, MU_LOG_INFO_LEVEL, __VA_ARGS__)
+  #define MU_LOG_MODULE_WARN(m, ...) \
+    MU_LOG_MODULE_AT_LEVEL(m, MU_LOG_WARN_LEVEL, __VA_ARGS__)
+  #define MU_LOG_MODULE_ERROR(m, ...) \
+    MU_LOG_MODULE_AT_LEVEL(m, MU_LOG_ERROR_LEVEL, __VA_ARGS__)
+  #define MU_LOG_MODULE_CRITICAL(m, ...) \
+    MU_LOG_MODULE_AT_LEVEL(m, MU_LOG_CRITICAL_LEVEL, __VA_ARGS__)
 #else
   // uLog vanishes when disabled at compile time...
   #define MU_LOG_INIT() do {} while(0)
   #define MU_LOG_SUBSCRIBE(a, b) do {} while(0)
   #define MU_LOG_UNSUBSCRIBE(a) do {} while(0)
   #define MU_LOG_LEVEL_NAME(a) do {} while(0)
+  #define MU_LOG_AT_LEVEL(level, ...) do {} while(0)
+  #define MU_LOG_MODULE_AT_LEVEL(module, level, ...) do {} while(0)
   #define MU_LOG_TRACE(f, ...) do {} while(0)
-  #define MU_LOG_DEBUG(f, ...) do {} while(0))
+  #define MU_LOG_DEBUG(f, ...) do {} while(0)
   #define MU_LOG_INFO(f, ...) do {} while(0)
   #define MU_LOG_WARN(f, ...) do {} while(0)
   #define MU_LOG_ERROR(f, ...) do {} while(0)
   #define MU_LOG_CRITICAL(f, ...) do {} while(0)
+  #define MU_LOG_MODULE_TRACE(m, ...) do {} while(0)
+  #define MU_LOG_MODULE_DEBUG(m, ...) do {} while(0)
+  #define MU_LOG_MODULE_INFO(m, ...) do {} while(0)
+  #define MU_LOG_MODULE_WARN(m, ...) do {} while(0)
+  #define MU_LOG_MODULE_ERROR(m, ...) do {} while(0)
+  #define MU_LOG_MODULE_CRITICAL(m, ...) do {} while(0)
 #endif
 
 typedef enum {
@@ -176,11 +221,68 @@ typedef enum {
 // maximum length of formatted log message
 #define MU_LOG_MAX_MESSAGE_LENGTH 120
 
+// When non-zero, messages are formatted with mulib's own mu_str_vformat()
+// rather than the C library's vsnprintf().  See mu_str_vformat() for the
+// supported subset of printf.
+#ifndef MU_LOG_USE_MU_STR_FORMAT
+#define MU_LOG_USE_MU_STR_FORMAT 0
+#endif
+
+/**
+ * Deferred logging
+ *
+ * When MU_LOG_DEFERRED is non-zero, mu_log_message() does not format anything.
+ * Instead it captures the severity, the format pointer and the raw argument
+ * values into a binary record, appends the record to a lock-free ring and
+ * returns.  A low-priority task (scheduled via mu_sched_isr_task_now(), so
+ * posts from several call sites coalesce) later formats each record and
+ * broadcasts it to the subscribers.  This keeps slow subscribers out of the
+ * caller's context and makes mu_log_message() safe to call from interrupts.
+ *
+ * Because arguments are captured by value, a %s argument is captured as a
+ * pointer: the string it points to must remain valid until the record is
+ * formatted (string literals always are).  At most MU_LOG_DEFERRED_MAX_ARGS
+ * arguments (including '*' widths and precisions) are captured; formatting
+ * stops at the first conversion beyond that.  When the ring is full, the new
+ * record is dropped and counted (see mu_log_dropped_count()).
+ */
+#ifndef MU_LOG_DEFERRED
+#define MU_LOG_DEFERRED 0
+#endif
+
+// number of records in the deferred ring: must be a power of two
+#ifndef MU_LOG_DEFERRED_QUEUE_SIZE
+#define MU_LOG_DEFERRED_QUEUE_SIZE 16
+#endif
+
+// maximum number of arguments captured per deferred record
+#ifndef MU_LOG_DEFERRED_MAX_ARGS
+#define MU_LOG_DEFERRED_MAX_ARGS 6
+#endif
+
 /**
  * @brief: prototype for uLog subscribers.
  */
 typedef void (*mu_log_function_t)(mu_log_level_t severity, const char *msg);
 
+/**
+ * @brief A module tag with its own threshold.
+ *
+ * Messages logged through a module are dropped (before any formatting) if
+ * they are below the module's threshold, and are prefixed with the module's
+ * name and ": " when broadcast.  Declare one per source module, e.g.:
+ *
+ * @code
+ * static mu_log_module_t s_log = {.name = "radio", .threshold = MU_LOG_WARN_LEVEL};
+ * ...
+ * MU_LOG_MODULE_INFO(&s_log, "rssi = %d", rssi);
+ * @endcode
+ */
+typedef struct {
+  const char *name;
+  mu_log_level_t threshold;
+} mu_log_module_t;
+
 // =============================================================================
 // declarations
 
@@ -229,6 +331,59 @@ mu_log_err_t mu_log_unsubscribe(mu_log_function_t fn);
  */
 void mu_log_message(mu_log_level_t severity, const char *fmt, ...);
 
+/**
+ * @brief Generate a log message tagged with a module.
+ *
+ * As with mu_log_message(), but the message is discarded if severity is below
+ * the module's threshold, and the broadcast message is prefixed with the
+ * module's name.
+ */
+void mu_log_module_message(const mu_log_module_t *module,
+                           mu_log_level_t severity,
+                           const char *fmt,
+                           ...);
+
+/**
+ * @brief Initialize a module tag.
+ */
+mu_log_module_t *mu_log_module_init(mu_log_module_t *module,
+                                    const char *name,
+                                    mu_log_level_t threshold);
+
+/**
+ * @brief Change a module's threshold at run time.
+ */
+void mu_log_module_set_threshold(mu_log_module_t *module,
+                                 mu_log_level_t threshold);
+
+/**
+ * @brief Return the lowest threshold among all subscribers.
+ *
+ * Messages below this level would not reach any subscriber, so
+ * mu_log_message() discards them with a single comparison before doing any
+ * formatting.  If there are no subscribers, returns a level above
+ * MU_LOG_CRITICAL_LEVEL.
+ */
+mu_log_level_t mu_log_active_threshold(void);
+
+/**
+ * @brief Format and broadcast every pending deferred record now, from the
+ * caller's context.  Useful before a reset or from a fault handler.  Does
+ * nothing unless MU_LOG_DEFERRED is non-zero.
+ *
+ * This may interrupt the log task: records are claimed atomically, so each is
+ * broadcast exactly once, and the flush formats into its own buffer.  The
+ * subscribers must be safe to call from the caller's context, and two calls to
+ * mu_log_flush() must not interrupt each other.
+ */
+void mu_log_flush(void);
+
+/**
+ * @brief Return the number of deferred records dropped because the ring was
+ * full.  Always 0 unless MU_LOG_DEFERRED is non-zero.
+ */
+uint32_t mu_log_dropped_count(void);
+
 /**
  * @brief Get the log level as a string.
  *
@@ -0,0 +1,159 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_log_token.h"
+#include "mulib.h"
+
+#ifdef MU_LOG_ENABLED // rest of file...
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// =============================================================================
+// private types and definitions
+
+typedef struct {
+  uint8_t *data;
+  size_t length;
+  bool overflowed;
+} encoder_t;
+
+// =============================================================================
+// private declarations
+
+static void put_byte(encoder_t *enc, uint8_t byte);
+
+static void put_varint(encoder_t *enc, int64_t value);
+
+static void put_float(encoder_t *enc, double value);
+
+static void put_string(encoder_t *enc, const char *s);
+
+// =============================================================================
+// local storage
+
+static mu_log_token_fn s_sink;
+static mu_log_level_t s_threshold;
+
+// =============================================================================
+// public code
+
+void mu_log_token_set_sink(mu_log_token_fn fn, mu_log_level_t threshold) {
+  s_sink = fn;
+  s_threshold = threshold;
+}
+
+void mu_log_token_message(mu_log_level_t severity,
+                          uint32_t token,
+                          uint32_t types,
+                          ...) {
+  uint8_t buf[MU_LOG_TOKEN_MAX_LENGTH];
+  encoder_t enc = {.data = buf, .length = 0, .overflowed = false};
+  mu_log_token_fn sink = s_sink;
+  unsigned int n_args = types & 0x0f;
+  va_list ap;
+
+  if ((sink == NULL) || (severity < s_threshold)) {
+    return;
+  }
+  for (int i = 0; i < 4; i++) {
+    put_byte(&enc, (uint8_t)(token >> (8 * i)));
+  }
+  va_start(ap, types);
+  for (unsigned int i = 0; i < n_args && !enc.overflowed; i++) {
+    switch ((mu_log_token_arg_t)((types >> (4 + 3 * i)) & 0x07)) {
+    case MU_LOG_TOKEN_ARG_INT32:
+      put_varint(&enc, va_arg(ap, int));
+      break;
+    case MU_LOG_TOKEN_ARG_INT64:
+      put_varint(&enc, va_arg(ap, long long));
+      break;
+    case MU_LOG_TOKEN_ARG_DOUBLE:
+      put_float(&enc, va_arg(ap, double));
+      break;
+    case MU_LOG_TOKEN_ARG_STRING:
+      put_string(&enc, va_arg(ap, const char *));
+      break;
+    case MU_LOG_TOKEN_ARG_POINTER:
+      put_varint(&enc, (int64_t)(uintptr_t)va_arg(ap, void *));
+      break;
+    }
+  }
+  va_end(ap);
+  sink(severity, buf, enc.length);
+}
+
+// =============================================================================
+// private code
+
+static void put_byte(encoder_t *enc, uint8_t byte) {
+  if (enc->length < MU_LOG_TOKEN_MAX_LENGTH) {
+    enc->data[enc->length++] = byte;
+  } else {
+    enc->overflowed = true;
+  }
+}
+
+static void put_varint(encoder_t *enc, int64_t value) {
+  // ZigZag maps small magnitudes of either sign to small unsigned values.
+  uint64_t zz = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+
+  while (zz >= 0x80) {
+    put_byte(enc, (uint8_t)(zz | 0x80));
+    zz >>= 7;
+  }
+  put_byte(enc, (uint8_t)zz);
+}
+
+static void put_float(encoder_t *enc, double value) {
+  float f = (float)value;
+  uint32_t bits;
+
+  memcpy(&bits, &f, sizeof(bits));
+  for (int i = 0; i < 4; i++) {
+    put_byte(enc, (uint8_t)(bits >> (8 * i)));
+  }
+}
+
+static void put_string(encoder_t *enc, const char *s) {
+  size_t length = (s == NULL) ? 0 : strlen(s);
+  uint8_t header = 0;
+
+  if (length > MU_LOG_TOKEN_MAX_STRING_LENGTH) {
+    length = MU_LOG_TOKEN_MAX_STRING_LENGTH;
+    header = 0x80; // truncated
+  }
+  put_byte(enc, header | (uint8_t)length);
+  for (size_t i = 0; i < length; i++) {
+    put_byte(enc, (uint8_t)s[i]);
+  }
+}
+
+#endif // #ifdef MU_LOG_ENABLED
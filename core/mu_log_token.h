@@ -0,0 +1,336 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Tokenized (binary) logging for mu_log.
+ *
+ * A tokenized log call replaces its format string with a 32-bit token computed
+ * at compile time, and emits only the token and its packed arguments:
+ *
+ * @code
+ * MU_LOG_TOKEN_INFO("battery at %d mV, temp %f", mv, temp_c);
+ * @endcode
+ *
+ * sends 4 bytes of token plus roughly 2 + 4 bytes of arguments, rather than a
+ * 30-odd character string, and the format string itself is not linked into
+ * the image.  A host-side tool (tools/mu_log_tokens.py) rebuilds the text.
+ *
+ * ## Tokens
+ *
+ * The token is the 65599 hash of the format string: the string's length plus
+ * the sum of each character times successive powers of 65599, modulo 2^32,
+ * over the first MU_LOG_TOKEN_HASH_LENGTH characters.  The hash is written as
+ * a constant expression over the string literal, so an optimizing compiler
+ * folds it to a constant and drops the literal.
+ *
+ * So that the host can map tokens back to strings, each format string is also
+ * placed in the ELF section ".mu_log_tokens".  Give that section the (INFO)
+ * or (NOLOAD) type in the linker script so it takes no space on the target:
+ *
+ *     .mu_log_tokens (INFO) : { KEEP(*(.mu_log_tokens)) }
+ *
+ * then generate the string table from the linked image:
+ *
+ *     tools/mu_log_tokens.py table app.elf > tokens.csv
+ *
+ * ## Encoding
+ *
+ * A message is the token (4 bytes, little endian) followed by each argument in
+ * order.  The type of each argument is determined at compile time:
+ * - integers (including enums) and pointers: ZigZag-encoded base-128 varint
+ *   (1 to 10 bytes)
+ * - float and double: IEEE-754 single precision, 4 bytes little endian
+ * - char * strings: a length byte (bit 7 set if truncated) and that many bytes
+ *
+ * At most MU_LOG_TOKEN_MAX_ARGS arguments are supported, and the message is
+ * truncated to MU_LOG_TOKEN_MAX_LENGTH bytes.  Messages are delivered to a
+ * single sink, which frames and transmits them as it sees fit (the host tool
+ * accepts one message per line in hex or base64).
+ *
+ * Tokenized logging requires GCC or Clang (for _Generic, section attributes
+ * and ##__VA_ARGS__) and an ELF toolchain.
+ */
+
+#ifndef _MU_LOG_TOKEN_H_
+#define _MU_LOG_TOKEN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_log.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+// maximum number of arguments to a tokenized log call
+#define MU_LOG_TOKEN_MAX_ARGS 8
+
+// number of leading characters of the format string included in the hash
+#define MU_LOG_TOKEN_HASH_LENGTH 80
+
+// maximum encoded message length in bytes
+#ifndef MU_LOG_TOKEN_MAX_LENGTH
+#define MU_LOG_TOKEN_MAX_LENGTH 48
+#endif
+
+// maximum number of bytes of a string argument (at most 127)
+#ifndef MU_LOG_TOKEN_MAX_STRING_LENGTH
+#define MU_LOG_TOKEN_MAX_STRING_LENGTH 24
+#endif
+
+/**
+ * @brief Argument types, packed three bits per argument above a four bit count
+ * into the types word passed to mu_log_token_message().
+ */
+typedef enum {
+  MU_LOG_TOKEN_ARG_INT32,
+  MU_LOG_TOKEN_ARG_INT64,
+  MU_LOG_TOKEN_ARG_DOUBLE,
+  MU_LOG_TOKEN_ARG_STRING,
+  MU_LOG_TOKEN_ARG_POINTER,
+} mu_log_token_arg_t;
+
+/**
+ * @brief Receives each encoded message.
+ */
+typedef void (*mu_log_token_fn)(mu_log_level_t severity,
+                                const uint8_t *data,
+                                size_t length);
+
+// One term of the token hash: character i times 65599^(i+1).  The inner
+// conditional keeps the index in bounds so no out-of-range access is formed.
+#define MU_LOG_TOKEN_TERM(s, i, k)                                             \
+  ((i) < sizeof(s) - 1                                                         \
+       ? (uint32_t)(uint8_t)(s)[(i) < sizeof(s) ? (i) : 0] * (uint32_t)(k)     \
+       : 0u)
+
+/**
+ * @brief The token for a string literal s.
+ */
+#define MU_LOG_TOKEN(s)                                                        \
+  ((uint32_t)(sizeof(s) - 1) +                                                 \
+  MU_LOG_TOKEN_TERM(s,  0, 0x0001003fu) + \
+  MU_LOG_TOKEN_TERM(s,  1, 0x007e0f81u) + \
+  MU_LOG_TOKEN_TERM(s,  2, 0x2e86d0bfu) + \
+  MU_LOG_TOKEN_TERM(s,  3, 0x43ec5f01u) + \
+  MU_LOG_TOKEN_TERM(s,  4, 0x162c613fu) + \
+  MU_LOG_TOKEN_TERM(s,  5, 0xd62aee81u) + \
+  MU_LOG_TOKEN_TERM(s,  6, 0xa311b1bfu) + \
+  MU_LOG_TOKEN_TERM(s,  7, 0xd319be01u) + \
+  MU_LOG_TOKEN_TERM(s,  8, 0xb156c23fu) + \
+  MU_LOG_TOKEN_TERM(s,  9, 0x6698cd81u) + \
+  MU_LOG_TOKEN_TERM(s, 10, 0x0d1b92bfu) + \
+  MU_LOG_TOKEN_TERM(s, 11, 0xcc881d01u) + \
+  MU_LOG_TOKEN_TERM(s, 12, 0x7280233fu) + \
+  MU_LOG_TOKEN_TERM(s, 13, 0x50c7ac81u) + \
+  MU_LOG_TOKEN_TERM(s, 14, 0x8da473bfu) + \
+  MU_LOG_TOKEN_TERM(s, 15, 0x4f377c01u) + \
+  MU_LOG_TOKEN_TERM(s, 16, 0xfaa8843fu) + \
+  MU_LOG_TOKEN_TERM(s, 17, 0x33b78b81u) + \
+  MU_LOG_TOKEN_TERM(s, 18, 0x45ac54bfu) + \
+  MU_LOG_TOKEN_TERM(s, 19, 0x7a27db01u) + \
+  MU_LOG_TOKEN_TERM(s, 20, 0xeacfe53fu) + \
+  MU_LOG_TOKEN_TERM(s, 21, 0xae686a81u) + \
+  MU_LOG_TOKEN_TERM(s, 22, 0x563335bfu) + \
+  MU_LOG_TOKEN_TERM(s, 23, 0x6c593a01u) + \
+  MU_LOG_TOKEN_TERM(s, 24, 0xe3f6463fu) + \
+  MU_LOG_TOKEN_TERM(s, 25, 0x5fda4981u) + \
+  MU_LOG_TOKEN_TERM(s, 26, 0xe03916bfu) + \
+  MU_LOG_TOKEN_TERM(s, 27, 0x44cb9901u) + \
+  MU_LOG_TOKEN_TERM(s, 28, 0x871ba73fu) + \
+  MU_LOG_TOKEN_TERM(s, 29, 0xe70d2881u) + \
+  MU_LOG_TOKEN_TERM(s, 30, 0x04bdf7bfu) + \
+  MU_LOG_TOKEN_TERM(s, 31, 0x227ef801u) + \
+  MU_LOG_TOKEN_TERM(s, 32, 0x7540083fu) + \
+  MU_LOG_TOKEN_TERM(s, 33, 0xe3010781u) + \
+  MU_LOG_TOKEN_TERM(s, 34, 0xe4c1d8bfu) + \
+  MU_LOG_TOKEN_TERM(s, 35, 0x24735701u) + \
+  MU_LOG_TOKEN_TERM(s, 36, 0x4f63693fu) + \
+  MU_LOG_TOKEN_TERM(s, 37, 0xf2b5e681u) + \
+  MU_LOG_TOKEN_TERM(s, 38, 0xa144b9bfu) + \
+  MU_LOG_TOKEN_TERM(s, 39, 0x69a8b601u) + \
+  MU_LOG_TOKEN_TERM(s, 40, 0xb685ca3fu) + \
+  MU_LOG_TOKEN_TERM(s, 41, 0xb52bc581u) + \
+  MU_LOG_TOKEN_TERM(s, 42, 0x5b469abfu) + \
+  MU_LOG_TOKEN_TERM(s, 43, 0x111f1501u) + \
+  MU_LOG_TOKEN_TERM(s, 44, 0x4ba72b3fu) + \
+  MU_LOG_TOKEN_TERM(s, 45, 0xc962a481u) + \
+  MU_LOG_TOKEN_TERM(s, 46, 0x33c77bbfu) + \
+  MU_LOG_TOKEN_TERM(s, 47, 0x39d67401u) + \
+  MU_LOG_TOKEN_TERM(s, 48, 0xafc78c3fu) + \
+  MU_LOG_TOKEN_TERM(s, 49, 0xce5a8381u) + \
+  MU_LOG_TOKEN_TERM(s, 50, 0x4bc75cbfu) + \
+  MU_LOG_TOKEN_TERM(s, 51, 0x02ced301u) + \
+  MU_LOG_TOKEN_TERM(s, 52, 0x83e6ed3fu) + \
+  MU_LOG_TOKEN_TERM(s, 53, 0x63136281u) + \
+  MU_LOG_TOKEN_TERM(s, 54, 0xc4463dbfu) + \
+  MU_LOG_TOKEN_TERM(s, 55, 0x8b083201u) + \
+  MU_LOG_TOKEN_TERM(s, 56, 0x69054e3fu) + \
+  MU_LOG_TOKEN_TERM(s, 57, 0x268d4181u) + \
+  MU_LOG_TOKEN_TERM(s, 58, 0xbe441ebfu) + \
+  MU_LOG_TOKEN_TERM(s, 59, 0xf1829101u) + \
+  MU_LOG_TOKEN_TERM(s, 60, 0x0022af3fu) + \
+  MU_LOG_TOKEN_TERM(s, 61, 0xb7c82081u) + \
+  MU_LOG_TOKEN_TERM(s, 62, 0x5ac0ffbfu) + \
+  MU_LOG_TOKEN_TERM(s, 63, 0x553df001u) + \
+  MU_LOG_TOKEN_TERM(s, 64, 0xea3f103fu) + \
+  MU_LOG_TOKEN_TERM(s, 65, 0xb5c3ff81u) + \
+  MU_LOG_TOKEN_TERM(s, 66, 0xbabce0bfu) + \
+  MU_LOG_TOKEN_TERM(s, 67, 0xd53a4f01u) + \
+  MU_LOG_TOKEN_TERM(s, 68, 0xc85a713fu) + \
+  MU_LOG_TOKEN_TERM(s, 69, 0xbf80de81u) + \
+  MU_LOG_TOKEN_TERM(s, 70, 0xff37c1bfu) + \
+  MU_LOG_TOKEN_TERM(s, 71, 0x9077ae01u) + \
+  MU_LOG_TOKEN_TERM(s, 72, 0x3b74d23fu) + \
+  MU_LOG_TOKEN_TERM(s, 73, 0x73febd81u) + \
+  MU_LOG_TOKEN_TERM(s, 74, 0x4931a2bfu) + \
+  MU_LOG_TOKEN_TERM(s, 75, 0xa5f60d01u) + \
+  MU_LOG_TOKEN_TERM(s, 76, 0xe48e333fu) + \
+  MU_LOG_TOKEN_TERM(s, 77, 0x723d9c81u) + \
+  MU_LOG_TOKEN_TERM(s, 78, 0xb9aa83bfu) + \
+  MU_LOG_TOKEN_TERM(s, 79, 0x34b56c01u) + \
+  0u)
+
+// The argument is classified by the type it is passed as: the conditional
+// applies the integer promotions, so that _Bool, char, short and enum
+// arguments (which _Generic can't name) select the int they promote to rather
+// than falling through to the pointer default.
+#define MU_LOG_TOKEN_ARG_TYPE(a)                                               \
+  _Generic((0 ? (a) : (a)),                                                    \
+    int: MU_LOG_TOKEN_ARG_INT32,                                               \
+    unsigned int: MU_LOG_TOKEN_ARG_INT32,                                      \
+    long: (sizeof(long) > 4 ? MU_LOG_TOKEN_ARG_INT64 : MU_LOG_TOKEN_ARG_INT32),\
+    unsigned long: (sizeof(long) > 4 ? MU_LOG_TOKEN_ARG_INT64                  \
+                                     : MU_LOG_TOKEN_ARG_INT32),                \
+    long long: MU_LOG_TOKEN_ARG_INT64,                                         \
+    unsigned long long: MU_LOG_TOKEN_ARG_INT64,                                \
+    float: MU_LOG_TOKEN_ARG_DOUBLE,                                            \
+    double: MU_LOG_TOKEN_ARG_DOUBLE,                                           \
+    char *: MU_LOG_TOKEN_ARG_STRING,                                           \
+    const char *: MU_LOG_TOKEN_ARG_STRING,                                     \
+    default: MU_LOG_TOKEN_ARG_POINTER)
+
+#define MU_LOG_TOKEN_T(a, i) ((uint32_t)MU_LOG_TOKEN_ARG_TYPE(a) << (4 + 3 * (i)))
+
+#define MU_LOG_TOKEN_COUNT(...)                                                \
+  MU_LOG_TOKEN_COUNT_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MU_LOG_TOKEN_COUNT_(_, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+#define MU_LOG_TOKEN_CAT(a, b) MU_LOG_TOKEN_CAT_(a, b)
+#define MU_LOG_TOKEN_CAT_(a, b) a##b
+
+#define MU_LOG_TOKEN_TYPES(...)                                                \
+  MU_LOG_TOKEN_CAT(MU_LOG_TOKEN_TYPES_, MU_LOG_TOKEN_COUNT(__VA_ARGS__))       \
+  (__VA_ARGS__)
+#define MU_LOG_TOKEN_TYPES_0() 0u
+#define MU_LOG_TOKEN_TS_1(a) MU_LOG_TOKEN_T(a, 0)
+#define MU_LOG_TOKEN_TS_2(a, b) \
+  (MU_LOG_TOKEN_TS_1(a) | MU_LOG_TOKEN_T(b, 1))
+#define MU_LOG_TOKEN_TS_3(a, b, c) \
+  (MU_LOG_TOKEN_TS_2(a, b) | MU_LOG_TOKEN_T(c, 2))
+#define MU_LOG_TOKEN_TS_4(a, b, c, d) \
+  (MU_LOG_TOKEN_TS_3(a, b, c) | MU_LOG_TOKEN_T(d, 3))
+#define MU_LOG_TOKEN_TS_5(a, b, c, d, e) \
+  (MU_LOG_TOKEN_TS_4(a, b, c, d) | MU_LOG_TOKEN_T(e, 4))
+#define MU_LOG_TOKEN_TS_6(a, b, c, d, e, f) \
+  (MU_LOG_TOKEN_TS_5(a, b, c, d, e) | MU_LOG_TOKEN_T(f, 5))
+#define MU_LOG_TOKEN_TS_7(a, b, c, d, e, f, g) \
+  (MU_LOG_TOKEN_TS_6(a, b, c, d, e, f) | MU_LOG_TOKEN_T(g, 6))
+#define MU_LOG_TOKEN_TS_8(a, b, c, d, e, f, g, h) \
+  (MU_LOG_TOKEN_TS_7(a, b, c, d, e, f, g) | MU_LOG_TOKEN_T(h, 7))
+#define MU_LOG_TOKEN_TYPES_1(a) (MU_LOG_TOKEN_TS_1(a) | 1u)
+#define MU_LOG_TOKEN_TYPES_2(a, b) (MU_LOG_TOKEN_TS_2(a, b) | 2u)
+#define MU_LOG_TOKEN_TYPES_3(a, b, c) (MU_LOG_TOKEN_TS_3(a, b, c) | 3u)
+#define MU_LOG_TOKEN_TYPES_4(a, b, c, d) (MU_LOG_TOKEN_TS_4(a, b, c, d) | 4u)
+#define MU_LOG_TOKEN_TYPES_5(a, b, c, d, e) \
+  (MU_LOG_TOKEN_TS_5(a, b, c, d, e) | 5u)
+#define MU_LOG_TOKEN_TYPES_6(a, b, c, d, e, f) \
+  (MU_LOG_TOKEN_TS_6(a, b, c, d, e, f) | 6u)
+#define MU_LOG_TOKEN_TYPES_7(a, b, c, d, e, f, g) \
+  (MU_LOG_TOKEN_TS_7(a, b, c, d, e, f, g) | 7u)
+#define MU_LOG_TOKEN_TYPES_8(a, b, c, d, e, f, g, h) \
+  (MU_LOG_TOKEN_TS_8(a, b, c, d, e, f, g, h) | 8u)
+
+#if (MU_LOG_ENABLED)
+  // Emit a tokenized message.  The format string is recorded in the
+  // .mu_log_tokens section for the host tool; only its token reaches the
+  // encoded message.
+  #define MU_LOG_TOKEN_AT_LEVEL(level, fmt, ...) \
+    do { \
+      if ((level) >= MU_LOG_MIN_LEVEL) { \
+        static const char _mu_log_token_fmt[] \
+            __attribute__((section(".mu_log_tokens"), used)) = fmt; \
+        (void)_mu_log_token_fmt; \
+        mu_log_token_message((level), MU_LOG_TOKEN(fmt), \
+                             MU_LOG_TOKEN_TYPES(__VA_ARGS__), ##__VA_ARGS__); \
+      } \
+    } while (0)
+#else
+  #define MU_LOG_TOKEN_AT_LEVEL(level, fmt, ...) do {} while(0)
+#endif
+
+#define MU_LOG_TOKEN_TRACE(...) MU_LOG_TOKEN_AT_LEVEL(MU_LOG_TRACE_LEVEL, __VA_ARGS__)
+#define MU_LOG_TOKEN_DEBUG(...) MU_LOG_TOKEN_AT_LEVEL(MU_LOG_DEBUG_LEVEL, __VA_ARGS__)
+#define MU_LOG_TOKEN_INFO(...) MU_LOG_TOKEN_AT_LEVEL(MU_LOG_INFO_LEVEL, __VA_ARGS__)
+#define MU_LOG_TOKEN_WARN(...) MU_LOG_TOKEN_AT_LEVEL(MU_LOG_WARN_LEVEL, __VA_ARGS__)
+#define MU_LOG_TOKEN_ERROR(...) MU_LOG_TOKEN_AT_LEVEL(MU_LOG_ERROR_LEVEL, __VA_ARGS__)
+#define MU_LOG_TOKEN_CRITICAL(...) \
+  MU_LOG_TOKEN_AT_LEVEL(MU_LOG_CRITICAL_LEVEL, __VA_ARGS__)
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set the function that receives encoded messages, and the minimum
+ * severity it receives.  Pass NULL to discard tokenized messages.
+ */
+void mu_log_token_set_sink(mu_log_token_fn fn, mu_log_level_t threshold);
+
+/**
+ * @brief Encode a tokenized message and pass it to the sink.  Normally called
+ * via the MU_LOG_TOKEN_xxx() macros, which compute token and types.
+ *
+ * The message is encoded into a buffer on the caller's stack, so this may be
+ * called from interrupt level provided the sink can be.
+ *
+ * @param severity The severity level of the message.
+ * @param token The format string's token.
+ * @param types Argument count and types, as built by MU_LOG_TOKEN_TYPES().
+ */
+void mu_log_token_message(mu_log_level_t severity,
+                          uint32_t token,
+                          uint32_t types,
+                          ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_LOG_TOKEN_H_
@@ -0,0 +1,158 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_mpsc.h"
+#include "mu_atomic.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// private types and definitions
+
+// =============================================================================
+// private declarations
+
+#define IS_POWER_OF_TWO(n) (((n) & ((n)-1)) == 0)
+
+// Largest capacity for which position differences fit in an int16_t
+#define MPSC_MAX_CAPACITY 0x8000
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+mu_mpsc_err_t mu_mpsc_init(mu_mpsc_t *q, mu_mpsc_cell_t *cells,
+                           uint16_t capacity) {
+  if ((capacity < 2) || !IS_POWER_OF_TWO(capacity) ||
+      (capacity > MPSC_MAX_CAPACITY)) {
+    return MU_MPSC_ERR_SIZE;
+  }
+  q->mask = capacity - 1;
+  q->cells = cells;
+  return mu_mpsc_reset(q);
+}
+
+mu_mpsc_err_t mu_mpsc_reset(mu_mpsc_t *q) {
+  for (uint16_t i = 0; i <= q->mask; i++) {
+    // cell i is first writable when the tail reaches position i
+    q->cells[i].seq = i;
+  }
+  q->head = 0;
+  q->tail = 0;
+  q->high_water = 0;
+  q->overflow_count = 0;
+  return MU_MPSC_ERR_NONE;
+}
+
+uint16_t mu_mpsc_capacity(mu_mpsc_t *q) {
+  return q->mask + 1;
+}
+
+/**
+ * @brief May be called by any producer: claim a cell by advancing the tail,
+ * then publish the item through the cell's sequence number.
+ */
+mu_mpsc_err_t mu_mpsc_put(mu_mpsc_t *q, mu_mpsc_item_t item) {
+  uint16_t pos = mu_atomic_load_u16(&q->tail);
+  mu_mpsc_cell_t *cell;
+
+  for (;;) {
+    cell = &q->cells[pos & q->mask];
+    int16_t dif = (int16_t)(mu_atomic_load_u16(&cell->seq) - pos);
+    if (dif == 0) {
+      // cell is free at this position: try to claim it.  On failure, pos is
+      // updated to the current tail.
+      if (mu_atomic_cas_u16(&q->tail, &pos, pos + 1)) {
+        break;
+      }
+    } else if (dif < 0) {
+      // cell still holds an item from one lap ago: the queue is full
+      mu_atomic_fetch_add_u32(&q->overflow_count, 1);
+      return MU_MPSC_ERR_FULL;
+    } else {
+      // another producer claimed this position first
+      pos = mu_atomic_load_u16(&q->tail);
+    }
+  }
+  cell->item = item;
+  mu_atomic_store_u16(&cell->seq, pos + 1);
+
+  // Track the deepest the queue has been.  The consumer may be advancing head
+  // concurrently, so depth may be overstated by the items being read.
+  uint16_t depth = (uint16_t)(pos + 1 - mu_atomic_load_u16(&q->head));
+  uint16_t high_water = mu_atomic_load_u16(&q->high_water);
+  while ((depth > high_water) &&
+         !mu_atomic_cas_u16(&q->high_water, &high_water, depth)) {
+    // high_water was updated by another producer: retry
+  }
+  return MU_MPSC_ERR_NONE;
+}
+
+/**
+ * @brief To be called by Consumer only: release the cell to the producers only
+ * after fetching the item.
+ */
+mu_mpsc_err_t mu_mpsc_get(mu_mpsc_t *q, mu_mpsc_item_t *item) {
+  uint16_t pos = q->head;
+  mu_mpsc_cell_t *cell = &q->cells[pos & q->mask];
+
+  if (mu_atomic_load_u16(&cell->seq) != (uint16_t)(pos + 1)) {
+    // not yet published
+    return MU_MPSC_ERR_EMPTY;
+  }
+  *item = cell->item;
+  // make the cell writable for the producer one lap from now
+  mu_atomic_store_u16(&cell->seq, pos + q->mask + 1);
+  q->head = pos + 1;
+  return MU_MPSC_ERR_NONE;
+}
+
+bool mu_mpsc_is_empty(mu_mpsc_t *q) {
+  uint16_t pos = q->head;
+  mu_mpsc_cell_t *cell = &q->cells[pos & q->mask];
+  return mu_atomic_load_u16(&cell->seq) != (uint16_t)(pos + 1);
+}
+
+uint32_t mu_mpsc_overflow_count(mu_mpsc_t *q) {
+  return mu_atomic_load_u32(&q->overflow_count);
+}
+
+uint16_t mu_mpsc_high_water(mu_mpsc_t *q) {
+  return mu_atomic_load_u16(&q->high_water);
+}
+
+void mu_mpsc_reset_high_water(mu_mpsc_t *q) {
+  // A producer racing with this store fails its compare-and-swap, re-reads
+  // zero and records its own depth.
+  mu_atomic_store_u16(&q->high_water, 0);
+}
+
+// =============================================================================
+// private code
@@ -0,0 +1,151 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Implementation of a lock-free Multiple Producer / Single Consumer
+ * queue.
+ *
+ * Like mu_spsc, mpsc stores pointer sized objects in a queue, but any number
+ * of producers may call mu_mpsc_put() concurrently -- for example, interrupt
+ * handlers at different priorities that preempt one another.  The scheduler
+ * uses an instance of mpsc as its ISR queue.
+ *
+ * The queue is a bounded ring of cells, each holding an item and a sequence
+ * number (after D. Vyukov).  A producer claims a cell by advancing the tail
+ * with a compare-and-swap, writes the item, and then publishes it by updating
+ * the cell's sequence number.  The consumer only takes a cell once it has been
+ * published, so a producer that is preempted between claiming and publishing
+ * delays the consumer but never corrupts the queue.
+ *
+ * Unlike mu_spsc, all `capacity` cells are usable.  Each failed put increments
+ * an overflow count rather than failing silently, and the queue records the
+ * largest number of items it has held (its high-water mark) so that it can be
+ * sized from field data.
+ */
+
+#ifndef _MU_MPSC_H_
+#define _MU_MPSC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  MU_MPSC_ERR_NONE,
+  MU_MPSC_ERR_EMPTY,
+  MU_MPSC_ERR_FULL,
+  MU_MPSC_ERR_SIZE,
+} mu_mpsc_err_t;
+
+// mu_mpsc manages pointer-sized objects
+typedef void * mu_mpsc_item_t;
+
+typedef struct {
+  volatile uint16_t seq;    // position at which this cell can be written / read
+  mu_mpsc_item_t item;
+} mu_mpsc_cell_t;
+
+typedef struct {
+  uint16_t mask;
+  volatile uint16_t tail;   // next position to be claimed by a producer
+  volatile uint16_t head;   // next position to be read by the consumer
+  mu_mpsc_cell_t *cells;
+  volatile uint16_t high_water; // most items held at once since reset
+  volatile uint32_t overflow_count; // number of puts refused since reset
+} mu_mpsc_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief initialize an mpsc queue with a backing store of cells.  capacity
+ * must be a power of two between 2 and 32768.
+ */
+mu_mpsc_err_t mu_mpsc_init(mu_mpsc_t *q, mu_mpsc_cell_t *cells, uint16_t capacity);
+
+/**
+ * @brief reset the queue to empty and clear the overflow count and high-water
+ * mark.  Not interrupt safe!
+ */
+mu_mpsc_err_t mu_mpsc_reset(mu_mpsc_t *q);
+
+/**
+ * @brief return the maximum number of items that can be stored in the queue.
+ * May be called at any time.
+ */
+uint16_t mu_mpsc_capacity(mu_mpsc_t *q);
+
+/**
+ * @brief Insert an item at the tail of the queue.  May be called by any number
+ * of producers, including from nested interrupts.
+ *
+ * @return MU_MPSC_ERR_FULL (and increment the overflow count) if the queue is
+ *         full, MU_MPSC_ERR_NONE otherwise.
+ */
+mu_mpsc_err_t mu_mpsc_put(mu_mpsc_t *q, mu_mpsc_item_t item);
+
+/**
+ * @brief Remove an item from the head of the queue.  May only be called by the
+ * consumer (foreground level).
+ */
+mu_mpsc_err_t mu_mpsc_get(mu_mpsc_t *q, mu_mpsc_item_t *item);
+
+/**
+ * @brief Return true if there is no item ready to be removed.  May only be
+ * called by the consumer.
+ */
+bool mu_mpsc_is_empty(mu_mpsc_t *q);
+
+/**
+ * @brief Return the number of puts that failed because the queue was full
+ * since the queue was last reset.  May be called at any time.
+ */
+uint32_t mu_mpsc_overflow_count(mu_mpsc_t *q);
+
+/**
+ * @brief Return the largest number of items held in the queue at once since
+ * the queue was last reset.  May be called at any time.
+ */
+uint16_t mu_mpsc_high_water(mu_mpsc_t *q);
+
+/**
+ * @brief Restart high-water tracking from zero.  The next put records the
+ * depth at that time.  May be called at any time.
+ */
+void mu_mpsc_reset_high_water(mu_mpsc_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_MPSC_H_
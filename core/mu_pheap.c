@@ -0,0 +1,278 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_pheap.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// =============================================================================
+// local types and definitions
+
+// =============================================================================
+// local (forward) declarations
+
+/**
+ * @brief Combine two detached trees, returning the root of the result.
+ *
+ * The tree whose root comes second becomes the leftmost child of the other.
+ */
+static mu_pheap_node_t *meld(mu_pheap_t *heap,
+                             mu_pheap_node_t *a,
+                             mu_pheap_node_t *b);
+
+/**
+ * @brief Combine a list of sibling trees into a single tree using the
+ * standard two-pass pairing strategy.  Returns NULL if first is NULL.
+ */
+static mu_pheap_node_t *merge_pairs(mu_pheap_t *heap, mu_pheap_node_t *first);
+
+/**
+ * @brief Return the parent of a node, or NULL if node is the root.
+ */
+static mu_pheap_node_t *parent_of(mu_pheap_node_t *node);
+
+/**
+ * @brief Return the first node of a subtree in traversal (post) order.
+ */
+static mu_pheap_node_t *first_in_subtree(mu_pheap_node_t *node);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+mu_pheap_node_t *mu_pheap_node_init(mu_pheap_node_t *node) {
+  node->child = NULL;
+  node->next = NULL;
+  node->prev = node;
+  return node;
+}
+
+bool mu_pheap_node_is_linked(mu_pheap_node_t *node) {
+  return node->prev != node;
+}
+
+mu_pheap_t *mu_pheap_init(mu_pheap_t *heap, mu_pheap_precedes_fn precedes) {
+  heap->root = NULL;
+  heap->precedes = precedes;
+  heap->count = 0;
+  return heap;
+}
+
+mu_pheap_t *mu_pheap_reset(mu_pheap_t *heap) {
+  while (!mu_pheap_is_empty(heap)) {
+    mu_pheap_pop(heap);
+  }
+  return heap;
+}
+
+bool mu_pheap_is_empty(mu_pheap_t *heap) {
+  return heap->root == NULL;
+}
+
+size_t mu_pheap_count(mu_pheap_t *heap) {
+  return heap->count;
+}
+
+mu_pheap_node_t *mu_pheap_peek(mu_pheap_t *heap) {
+  return heap->root;
+}
+
+mu_pheap_node_t *mu_pheap_insert(mu_pheap_t *heap, mu_pheap_node_t *node) {
+  node->child = NULL;
+  node->next = NULL;
+  if (heap->root == NULL) {
+    heap->root = node;
+  } else {
+    heap->root = meld(heap, heap->root, node);
+  }
+  heap->root->prev = NULL;
+  heap->count += 1;
+  return node;
+}
+
+mu_pheap_node_t *mu_pheap_pop(mu_pheap_t *heap) {
+  mu_pheap_node_t *root = heap->root;
+  if (root == NULL) {
+    return NULL;
+  }
+  heap->root = merge_pairs(heap, root->child);
+  if (heap->root != NULL) {
+    heap->root->prev = NULL;
+  }
+  heap->count -= 1;
+  return mu_pheap_node_init(root);
+}
+
+mu_pheap_node_t *mu_pheap_remove(mu_pheap_t *heap, mu_pheap_node_t *node) {
+  if (!mu_pheap_node_is_linked(node)) {
+    return NULL;
+  }
+  if (node == heap->root) {
+    return mu_pheap_pop(heap);
+  }
+  // detach node (and its subtree) from its parent or left sibling
+  if (node->prev->child == node) {
+    node->prev->child = node->next;
+  } else {
+    node->prev->next = node->next;
+  }
+  if (node->next != NULL) {
+    node->next->prev = node->prev;
+  }
+  // combine node's children and merge them back into the heap
+  mu_pheap_node_t *subtree = merge_pairs(heap, node->child);
+  if (subtree != NULL) {
+    heap->root = meld(heap, heap->root, subtree);
+    heap->root->prev = NULL;
+  }
+  heap->count -= 1;
+  return mu_pheap_node_init(node);
+}
+
+void *mu_pheap_traverse(mu_pheap_t *heap, mu_pheap_traverse_fn fn, void *arg) {
+  mu_pheap_node_t *node = NULL;
+  void *result = NULL;
+
+  if (heap->root != NULL) {
+    node = first_in_subtree(heap->root);
+  }
+  while (node != NULL && result == NULL) {
+    // Find the successor before calling fn in case fn removes node.  Removing
+    // a node only rearranges its own (already visited) subtree and the list of
+    // the root's children, so the successor remains valid.
+    mu_pheap_node_t *next;
+    if (node->next != NULL) {
+      next = first_in_subtree(node->next);
+    } else {
+      next = parent_of(node);
+    }
+    result = fn(node, arg);
+    node = next;
+  }
+  return result;
+}
+
+void *mu_pheap_traverse_reverse(mu_pheap_t *heap,
+                                mu_pheap_traverse_fn fn,
+                                void *arg) {
+  mu_pheap_node_t *node = heap->root;
+  void *result = NULL;
+
+  while (node != NULL && result == NULL) {
+    result = fn(node, arg);
+    if (node->child != NULL) {
+      // rightmost child is next
+      node = node->child;
+      while (node->next != NULL) {
+        node = node->next;
+      }
+    } else {
+      // left sibling of the nearest ancestor (or self) that has one
+      while (node != NULL && (node->prev == NULL || node->prev->child == node)) {
+        node = node->prev;
+      }
+      if (node != NULL) {
+        node = node->prev;
+      }
+    }
+  }
+  return result;
+}
+
+// =============================================================================
+// local (static) code
+
+static mu_pheap_node_t *meld(mu_pheap_t *heap,
+                             mu_pheap_node_t *a,
+                             mu_pheap_node_t *b) {
+  if (heap->precedes(b, a)) {
+    mu_pheap_node_t *t = a;
+    a = b;
+    b = t;
+  }
+  // b becomes the leftmost child of a
+  b->prev = a;
+  b->next = a->child;
+  if (a->child != NULL) {
+    a->child->prev = b;
+  }
+  a->child = b;
+  a->next = NULL;
+  return a;
+}
+
+static mu_pheap_node_t *merge_pairs(mu_pheap_t *heap, mu_pheap_node_t *first) {
+  mu_pheap_node_t *pairs = NULL; // melded pairs, in reverse order
+
+  // first pass: meld siblings in pairs, left to right
+  while (first != NULL) {
+    mu_pheap_node_t *a = first;
+    mu_pheap_node_t *b = a->next;
+    if (b == NULL) {
+      first = NULL;
+    } else {
+      first = b->next;
+      b->next = NULL;
+      a = meld(heap, a, b);
+    }
+    a->next = pairs;
+    pairs = a;
+  }
+
+  if (pairs == NULL) {
+    return NULL;
+  }
+
+  // second pass: meld the pairs, right to left
+  mu_pheap_node_t *result = pairs;
+  pairs = pairs->next;
+  result->next = NULL;
+  while (pairs != NULL) {
+    mu_pheap_node_t *next = pairs->next;
+    pairs->next = NULL;
+    result = meld(heap, result, pairs);
+    pairs = next;
+  }
+  return result;
+}
+
+static mu_pheap_node_t *parent_of(mu_pheap_node_t *node) {
+  // walk left across the siblings to the leftmost, whose prev is the parent
+  while (node->prev != NULL && node->prev->child != node) {
+    node = node->prev;
+  }
+  return node->prev;
+}
+
+static mu_pheap_node_t *first_in_subtree(mu_pheap_node_t *node) {
+  while (node->child != NULL) {
+    node = node->child;
+  }
+  return node;
+}
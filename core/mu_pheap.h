@@ -0,0 +1,203 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file Intrusive pairing heap.
+ *
+ * A pairing heap is a heap-ordered multi-way tree that offers O(1) insertion
+ * and O(log n) amortized removal of the first element or of an arbitrary
+ * element.  Like mu_dlist, the links live inside the structure being ordered,
+ * so no additional storage is required.  Use MU_PHEAP_CONTAINER to get from a
+ * mu_pheap_node_t back to its enclosing structure.
+ *
+ * The ordering is defined by a user-supplied `precedes` function that returns
+ * true if node a should come out of the heap before node b.  If two nodes are
+ * equivalent, the order in which they are popped is unspecified: callers that
+ * need FIFO behavior should break ties with a sequence number.
+ *
+ * Each node has three links:
+ * - child: the leftmost child of the node, or NULL
+ * - next: the right sibling of the node, or NULL
+ * - prev: the left sibling of the node, or its parent if the node is the
+ *   leftmost child, or NULL if the node is the root of the heap.
+ *
+ * A node that's not in a heap has its prev field pointing to itself.
+ */
+
+#ifndef _MU_PHEAP_H_
+#define _MU_PHEAP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// =============================================================================
+// types and definitions
+
+typedef struct _mu_pheap_node {
+  struct _mu_pheap_node *child; // leftmost child
+  struct _mu_pheap_node *next;  // right sibling
+  struct _mu_pheap_node *prev;  // left sibling or parent
+} mu_pheap_node_t;
+
+/**
+ * @brief Signature for the ordering function.
+ *
+ * @return true if node a should be popped before node b.
+ */
+typedef bool (*mu_pheap_precedes_fn)(mu_pheap_node_t *a, mu_pheap_node_t *b);
+
+/**
+ * @brief Signature for a function passed to mu_pheap_traverse.
+ * @return NULL to continue traversing, a non-null value to stop.
+ */
+typedef void *(*mu_pheap_traverse_fn)(mu_pheap_node_t *node, void *arg);
+
+typedef struct {
+  mu_pheap_node_t *root;          // the first node in the heap (or NULL)
+  mu_pheap_precedes_fn precedes;  // ordering function
+  size_t count;                   // number of nodes in the heap
+} mu_pheap_t;
+
+/**
+ * @brief Given a pointer to a mu_pheap_node_t slot within a containing
+ * structure, return a pointer to the containing structure.
+ */
+#define MU_PHEAP_CONTAINER(_ptr, _type, _member) \
+  ((_type *)((char *)(1 ? (_ptr) : &((_type *)0)->_member) - offsetof(_type, _member)))
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize a heap node so it is not part of any heap.
+ *
+ * @param node The node to initialize.
+ * @return node
+ */
+mu_pheap_node_t *mu_pheap_node_init(mu_pheap_node_t *node);
+
+/**
+ * @brief Return true if the node is part of a heap.
+ */
+bool mu_pheap_node_is_linked(mu_pheap_node_t *node);
+
+/**
+ * @brief Initialize an empty heap.
+ *
+ * @param heap The heap to initialize.
+ * @param precedes The ordering function.
+ * @return heap
+ */
+mu_pheap_t *mu_pheap_init(mu_pheap_t *heap, mu_pheap_precedes_fn precedes);
+
+/**
+ * @brief Remove all nodes from the heap, leaving each node unlinked.
+ *
+ * @param heap The heap.
+ * @return heap
+ */
+mu_pheap_t *mu_pheap_reset(mu_pheap_t *heap);
+
+/**
+ * @brief Return true if the heap has no nodes.
+ */
+bool mu_pheap_is_empty(mu_pheap_t *heap);
+
+/**
+ * @brief Return the number of nodes in the heap.
+ */
+size_t mu_pheap_count(mu_pheap_t *heap);
+
+/**
+ * @brief Return the first node in the heap without removing it, or NULL if
+ * the heap is empty.
+ */
+mu_pheap_node_t *mu_pheap_peek(mu_pheap_t *heap);
+
+/**
+ * @brief Add a node to the heap.  O(1).
+ *
+ * Note: the node must not already be part of a heap.
+ *
+ * @param heap The heap.
+ * @param node The node to insert.
+ * @return node
+ */
+mu_pheap_node_t *mu_pheap_insert(mu_pheap_t *heap, mu_pheap_node_t *node);
+
+/**
+ * @brief Remove and return the first node in the heap.  O(log n) amortized.
+ *
+ * @param heap The heap.
+ * @return The removed node, or NULL if the heap was empty.
+ */
+mu_pheap_node_t *mu_pheap_pop(mu_pheap_t *heap);
+
+/**
+ * @brief Remove an arbitrary node from the heap.  O(log n) amortized.
+ *
+ * Note: the node must be part of the given heap or not linked at all.
+ *
+ * @param heap The heap.
+ * @param node The node to remove.
+ * @return node if it was in the heap, NULL otherwise.
+ */
+mu_pheap_node_t *mu_pheap_remove(mu_pheap_t *heap, mu_pheap_node_t *node);
+
+/**
+ * @brief Call fn with each node of the heap, stopping when fn returns a
+ * non-null value.  O(n).
+ *
+ * Nodes are visited in tree order (children before their parent, so the root
+ * comes last), not in sorted order.  fn may remove the node it is given.  If
+ * fn also re-inserts the node, the node may be visited a second time.  fn must
+ * not remove any other node.
+ *
+ * @param heap The heap.
+ * @param fn The function to call with each node.
+ * @param arg Passed as the second argument to fn.
+ * @return The first non-null value returned by fn, or NULL.
+ */
+void *mu_pheap_traverse(mu_pheap_t *heap, mu_pheap_traverse_fn fn, void *arg);
+
+/**
+ * @brief Like mu_pheap_traverse, but visits the nodes in the opposite order
+ * (root first).  fn must not modify the heap.
+ */
+void *mu_pheap_traverse_reverse(mu_pheap_t *heap,
+                                mu_pheap_traverse_fn fn,
+                                void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _MU_PHEAP_H_ */
@@ -0,0 +1,144 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_pool.h"
+#include "mu_list.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// private types and definitions
+
+// =============================================================================
+// private declarations
+
+static bool is_pointer_aligned(const void *p);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+mu_pool_t *mu_pool_init(mu_pool_t *pool,
+                        void *arena,
+                        size_t block_size,
+                        size_t block_count) {
+  if ((arena == NULL) || !is_pointer_aligned(arena) ||
+      (block_size < sizeof(mu_list_t)) ||
+      ((block_size % sizeof(void *)) != 0)) {
+    return NULL;
+  }
+  pool->arena = (char *)arena;
+  pool->block_size = block_size;
+  pool->block_count = block_count;
+#if (MU_POOL_STATISTICS)
+  pool->high_water = 0;
+  pool->failure_count = 0;
+#endif
+  return mu_pool_reset(pool);
+}
+
+mu_pool_t *mu_pool_reset(mu_pool_t *pool) {
+  mu_list_init(&pool->free_list);
+  // Push in reverse so that blocks are handed out in address order.
+  for (size_t i = pool->block_count; i > 0; i--) {
+    mu_list_t *block = (mu_list_t *)(pool->arena + (i - 1) * pool->block_size);
+    mu_list_push(&pool->free_list, block);
+  }
+  pool->free_count = pool->block_count;
+  return pool;
+}
+
+void *mu_pool_alloc(mu_pool_t *pool) {
+  mu_list_t *block = mu_list_pop(&pool->free_list);
+
+  if (block == NULL) {
+#if (MU_POOL_STATISTICS)
+    pool->failure_count += 1;
+#endif
+    return NULL;
+  }
+  pool->free_count -= 1;
+#if (MU_POOL_STATISTICS)
+  size_t in_use = pool->block_count - pool->free_count;
+  if (in_use > pool->high_water) {
+    pool->high_water = in_use;
+  }
+#endif
+  return block;
+}
+
+mu_pool_err_t mu_pool_free(mu_pool_t *pool, void *block) {
+  if (!mu_pool_owns(pool, block)) {
+    return MU_POOL_ERR_NOT_OWNED;
+  }
+  mu_list_push(&pool->free_list, (mu_list_t *)block);
+  pool->free_count += 1;
+  return MU_POOL_ERR_NONE;
+}
+
+bool mu_pool_owns(mu_pool_t *pool, void *ptr) {
+  uintptr_t start = (uintptr_t)pool->arena;
+  uintptr_t p = (uintptr_t)ptr;
+
+  if ((p < start) || (p >= start + pool->block_size * pool->block_count)) {
+    return false;
+  }
+  return ((p - start) % pool->block_size) == 0;
+}
+
+size_t mu_pool_block_size(mu_pool_t *pool) { return pool->block_size; }
+
+size_t mu_pool_block_count(mu_pool_t *pool) { return pool->block_count; }
+
+size_t mu_pool_free_count(mu_pool_t *pool) { return pool->free_count; }
+
+size_t mu_pool_in_use_count(mu_pool_t *pool) {
+  return pool->block_count - pool->free_count;
+}
+
+#if (MU_POOL_STATISTICS)
+
+size_t mu_pool_high_water(mu_pool_t *pool) { return pool->high_water; }
+
+size_t mu_pool_failure_count(mu_pool_t *pool) { return pool->failure_count; }
+
+void mu_pool_reset_statistics(mu_pool_t *pool) {
+  pool->high_water = mu_pool_in_use_count(pool);
+  pool->failure_count = 0;
+}
+
+#endif
+
+// =============================================================================
+// private code
+
+static bool is_pointer_aligned(const void *p) {
+  return ((uintptr_t)p % sizeof(void *)) == 0;
+}
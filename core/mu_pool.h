@@ -0,0 +1,209 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Fixed-size block allocator over a caller-supplied arena.
+ *
+ * mulib never calls malloc(), but applications often need a handful of
+ * interchangeable objects -- tasks, timers, message buffers -- whose lifetimes
+ * are not static.  mu_pool carves a caller-supplied arena into equal sized
+ * blocks and threads the free blocks onto an embedded mu_list, so that both
+ * mu_pool_alloc() and mu_pool_free() run in constant time and the pool itself
+ * needs no storage beyond the mu_pool_t header.
+ *
+ * Each free block holds its free-list link in its first bytes, so the block
+ * size must be at least sizeof(mu_list_t) and a multiple of sizeof(void *),
+ * and the arena must be pointer aligned.  The simplest way to meet these
+ * constraints is to use an array of the object type as the arena:
+ *
+ *     static my_msg_t s_msg_arena[8];
+ *     mu_pool_init(&s_msg_pool, s_msg_arena, sizeof(my_msg_t), 8);
+ *
+ * For objects whose size is not a multiple of a pointer, MU_POOL_BLOCK_SIZE()
+ * rounds up and MU_POOL_ARENA_WORDS() sizes a pointer-aligned arena:
+ *
+ *     static void *s_arena[MU_POOL_ARENA_WORDS(sizeof(odd_t), 8)];
+ *     mu_pool_init(&s_pool, s_arena, MU_POOL_BLOCK_SIZE(sizeof(odd_t)), 8);
+ *
+ * When MU_POOL_STATISTICS is non-zero, each pool tracks the largest number of
+ * blocks ever allocated at once and the number of failed allocations, which
+ * makes it easy to right-size the arena on a running system.
+ *
+ * mu_pool is not interrupt safe: calls on the same pool must not be made
+ * concurrently from interrupt and foreground levels.
+ */
+
+#ifndef _MU_POOL_H_
+#define _MU_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_list.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// =============================================================================
+// types and definitions
+
+#ifndef MU_POOL_STATISTICS
+#define MU_POOL_STATISTICS 1
+#endif
+
+typedef enum {
+  MU_POOL_ERR_NONE,
+  MU_POOL_ERR_NOT_OWNED,
+} mu_pool_err_t;
+
+typedef struct {
+  mu_list_t free_list; // free blocks, linked through their first word
+  char *arena;         // start of the caller-supplied arena
+  size_t block_size;   // size of each block in bytes
+  size_t block_count;  // number of blocks in the arena
+  size_t free_count;   // number of blocks currently on the free list
+#if (MU_POOL_STATISTICS)
+  size_t high_water;    // largest number of blocks allocated at once
+  size_t failure_count; // number of calls to mu_pool_alloc() that failed
+#endif
+} mu_pool_t;
+
+/**
+ * @brief Round an object size up to a usable block size.
+ */
+#define MU_POOL_BLOCK_SIZE(_size)                                              \
+  ((_size) < sizeof(mu_list_t)                                                 \
+       ? sizeof(mu_list_t)                                                     \
+       : (((_size) + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *))
+
+/**
+ * @brief Number of pointer-sized words needed for an arena of _count blocks
+ * of (unrounded) size _size.
+ */
+#define MU_POOL_ARENA_WORDS(_size, _count)                                     \
+  ((MU_POOL_BLOCK_SIZE(_size) / sizeof(void *)) * (_count))
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize a pool over a caller-supplied arena.
+ *
+ * All blocks start out free.
+ *
+ * @param pool The pool to initialize.
+ * @param arena Pointer-aligned storage of at least block_size * block_count
+ *        bytes.
+ * @param block_size The size of each block in bytes.  Must be at least
+ *        sizeof(mu_list_t) and a multiple of sizeof(void *).
+ * @param block_count The number of blocks in the arena.
+ * @return pool on success, or NULL if the arena or block size is unsuitable.
+ */
+mu_pool_t *mu_pool_init(mu_pool_t *pool,
+                        void *arena,
+                        size_t block_size,
+                        size_t block_count);
+
+/**
+ * @brief Return every block to the free list.
+ *
+ * Any outstanding pointers into the pool become invalid.  Statistics are not
+ * affected: see mu_pool_reset_statistics().
+ */
+mu_pool_t *mu_pool_reset(mu_pool_t *pool);
+
+/**
+ * @brief Allocate one block from the pool in constant time.
+ *
+ * The contents of the returned block are undefined.
+ *
+ * @return A pointer to the block, or NULL if the pool is exhausted.
+ */
+void *mu_pool_alloc(mu_pool_t *pool);
+
+/**
+ * @brief Return a block to the pool in constant time.
+ *
+ * @param block A pointer previously returned by mu_pool_alloc() on the same
+ *        pool.  Freeing a block twice corrupts the pool.
+ * @return MU_POOL_ERR_NOT_OWNED if block does not refer to the start of a
+ *         block within this pool's arena, MU_POOL_ERR_NONE otherwise.
+ */
+mu_pool_err_t mu_pool_free(mu_pool_t *pool, void *block);
+
+/**
+ * @brief Return true if ptr refers to the start of a block in this pool.
+ */
+bool mu_pool_owns(mu_pool_t *pool, void *ptr);
+
+/**
+ * @brief Return the size of each block in bytes.
+ */
+size_t mu_pool_block_size(mu_pool_t *pool);
+
+/**
+ * @brief Return the total number of blocks managed by the pool.
+ */
+size_t mu_pool_block_count(mu_pool_t *pool);
+
+/**
+ * @brief Return the number of blocks currently available for allocation.
+ */
+size_t mu_pool_free_count(mu_pool_t *pool);
+
+/**
+ * @brief Return the number of blocks currently allocated.
+ */
+size_t mu_pool_in_use_count(mu_pool_t *pool);
+
+#if (MU_POOL_STATISTICS)
+
+/**
+ * @brief Return the largest number of blocks allocated at any one time since
+ * the pool was initialized or its statistics were last reset.
+ */
+size_t mu_pool_high_water(mu_pool_t *pool);
+
+/**
+ * @brief Return the number of calls to mu_pool_alloc() that returned NULL
+ * since the pool was initialized or its statistics were last reset.
+ */
+size_t mu_pool_failure_count(mu_pool_t *pool);
+
+/**
+ * @brief Clear the failure count and set the high-water mark to the number of
+ * blocks currently in use.
+ */
+void mu_pool_reset_statistics(mu_pool_t *pool);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_POOL_H_
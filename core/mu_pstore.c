@@ -35,10 +35,13 @@
 
 static void delete_at(mu_pstore_t *pstore, size_t index);
 static size_t find_insertion_index(mu_pstore_t *pstore, mu_pstore_item_t item, mu_pstore_compare_fn cmp);
-static void heapsort(mu_pstore_t *pstore, mu_pstore_compare_fn cmp);
+static void quicksort(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp, int depth);
+static void insertion_sort(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp);
+static void heapsort(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp);
 static void heapify(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp);
 static void sift_down(mu_pstore_item_t *items, mu_pstore_compare_fn cmp, int start, int end);
 static void swap(mu_pstore_item_t *items, int a, int b);
+static int sort_depth(size_t count);
 
 // =============================================================================
 // local storage
@@ -173,9 +176,15 @@ mu_pstore_item_t mu_pstore_delete(mu_pstore_t *pstore, mu_pstore_item_t item) {
 }
 
 mu_pstore_err_t mu_pstore_filter(mu_pstore_t *pstore, mu_pstore_filter_fn match) {
-  (void)(pstore);
-  (void)(match);
-  // TODO: NOT YET IMPLEMENTED
+  size_t kept = 0;
+
+  for (size_t i=0; i<pstore->count; i++) {
+    mu_pstore_item_t item = pstore->items[i];
+    if (match(item)) {
+      pstore->items[kept++] = item;
+    }
+  }
+  pstore->count = kept;
   return MU_PSTORE_ERR_NONE;
 }
 
@@ -188,9 +197,44 @@ mu_pstore_err_t mu_pstore_insert_sorted(mu_pstore_t *pstore, mu_pstore_item_t it
   }
 }
 
+mu_pstore_err_t mu_pstore_insert_sorted_n(mu_pstore_t *pstore, mu_pstore_item_t *items, size_t n, mu_pstore_compare_fn cmp) {
+  mu_pstore_t batch;
+  size_t i = pstore->count;
+  size_t j = n;
+  size_t k = i + n;
+
+  if (n > pstore->capacity - pstore->count) {
+    return MU_PSTORE_ERR_FULL;
+  }
+  mu_pstore_init(&batch, items, n);
+  batch.count = n;
+  mu_pstore_sort(&batch, cmp);
+
+  // Merge from the top down, so each item is moved at most once and the
+  // unmerged existing items are never overwritten.
+  while (j > 0) {
+    if (i > 0 && cmp(pstore->items[i - 1], items[j - 1]) > 0) {
+      pstore->items[--k] = pstore->items[--i];
+    } else {
+      pstore->items[--k] = items[--j];
+    }
+  }
+  pstore->count += n;
+  return MU_PSTORE_ERR_NONE;
+}
+
 mu_pstore_err_t mu_pstore_sort(mu_pstore_t *pstore, mu_pstore_compare_fn cmp) {
-  if (mu_pstore_count(pstore) > 1) {
-    heapsort(pstore, cmp);
+  mu_pstore_item_t *items = mu_pstore_items(pstore);
+  size_t count = mu_pstore_count(pstore);
+  size_t i = 1;
+
+  // Nearly-sorted input is common: check for already-sorted in one pass.
+  while (i < count && cmp(items[i], items[i - 1]) >= 0) {
+    i++;
+  }
+  if (i < count) {
+    quicksort(items, count, cmp, sort_depth(count));
+    insertion_sort(items, count, cmp);
   }
   return MU_PSTORE_ERR_NONE;
 }
@@ -227,10 +271,65 @@ static size_t find_insertion_index(mu_pstore_t *pstore, mu_pstore_item_t item, m
   return low;
 }
 
-static void heapsort(mu_pstore_t *pstore, mu_pstore_compare_fn cmp) {
-  mu_pstore_item_t *items = mu_pstore_items(pstore);
-  size_t count = mu_pstore_count(pstore);
+// Introsort, leaving partitions of MU_SORT_INSERTION_THRESHOLD or fewer items
+// for insertion_sort().
+static void quicksort(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp, int depth) {
+  while (count > MU_SORT_INSERTION_THRESHOLD) {
+    if (depth-- == 0) {
+      heapsort(items, count, cmp); // too many bad partitions
+      return;
+    }
+    // Median of three, which also leaves sentinels at both ends.
+    size_t mid = count / 2;
+    if (cmp(items[mid], items[0]) < 0) {
+      swap(items, mid, 0);
+    }
+    if (cmp(items[count - 1], items[mid]) < 0) {
+      swap(items, count - 1, mid);
+      if (cmp(items[mid], items[0]) < 0) {
+        swap(items, mid, 0);
+      }
+    }
+    mu_pstore_item_t pivot = items[mid];
+    size_t i = 0;
+    size_t j = count - 1;
+    for (;;) {
+      do {
+        i++;
+      } while (cmp(items[i], pivot) < 0);
+      do {
+        j--;
+      } while (cmp(pivot, items[j]) < 0);
+      if (i >= j) {
+        break;
+      }
+      swap(items, i, j);
+    }
+    // Recurse into the smaller part and iterate on the larger.
+    if (i < count - i) {
+      quicksort(items, i, cmp, depth);
+      items += i;
+      count -= i;
+    } else {
+      quicksort(&items[i], count - i, cmp, depth);
+      count = i;
+    }
+  }
+}
+
+static void insertion_sort(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp) {
+  for (size_t i = 1; i < count; i++) {
+    mu_pstore_item_t item = items[i];
+    size_t j = i;
+    while (j > 0 && cmp(item, items[j - 1]) < 0) {
+      items[j] = items[j - 1];
+      j--;
+    }
+    items[j] = item;
+  }
+}
 
+static void heapsort(mu_pstore_item_t *items, size_t count, mu_pstore_compare_fn cmp) {
   heapify(items, count, cmp);
 
   size_t end = count - 1;
@@ -275,3 +374,13 @@ static void swap(mu_pstore_item_t *items, int a, int b) {
   items[a] = items[b];
   items[b] = temp;
 }
+
+static int sort_depth(size_t count) {
+  int depth = 0;
+
+  while (count > 1) {
+    depth += 2;
+    count >>= 1;
+  }
+  return depth;
+}
@@ -243,9 +243,8 @@ mu_pstore_err_t mu_pstore_delete_at(mu_pstore_t *pstore, mu_pstore_item_t *item,
  *
  * The user-supplied filter function is called with a void * argument, and
  * should return true if that element is to be preserved and false if it is
- * to be removed from the pstore.
- *
- * TODO: NOT YET IMPLEMENTED.
+ * to be removed from the pstore.  The preserved items keep their order, and
+ * the pstore is compacted in a single pass.
  *
  * @param pstore The pstore structure.
  * @param match The user supplied filter function.
@@ -274,12 +273,31 @@ mu_pstore_err_t mu_pstore_filter(mu_pstore_t *pstore, mu_pstore_filter_fn match)
  */
 mu_pstore_err_t mu_pstore_insert_sorted(mu_pstore_t *pstore, mu_pstore_item_t item, mu_pstore_compare_fn cmp);
 
+/**
+ * @brief Insert a batch of items into a sorted pstore.
+ *
+ * Equivalent to calling mu_pstore_insert_sorted() for each of the n items,
+ * but linear rather than quadratic in the size of the pstore: the batch is
+ * sorted (in place, so its order is not preserved) and then merged into the
+ * pstore in a single backwards pass.  The pstore must already be sorted.
+ *
+ * @param pstore The pstore structure.
+ * @param items Array of n items to insert.  Reordered by the call.
+ * @param n The number of items to insert.
+ * @param cmp The user supplied comparison function.
+ * @return MU_PSTORE_ERR_FULL (and nothing is inserted) if there is not room
+ *         for all n items, MU_PSTORE_ERR_NONE otherwise.
+ */
+mu_pstore_err_t mu_pstore_insert_sorted_n(mu_pstore_t *pstore, mu_pstore_item_t *items, size_t n, mu_pstore_compare_fn cmp);
+
 /**
  * @brief In-place sorting of a items in a pstore.
  *
- * mu_pstore_sort() performs an in-place heapsort on its items according to
- * a user-supplied comparison function.  The heapsort operation is O(log N)
- * with very low overhead.
+ * mu_pstore_sort() performs an in-place introsort on its items according to
+ * a user-supplied comparison function: already sorted input is detected in
+ * one pass, nearly sorted input is finished by insertion sort in close to
+ * linear time, and the worst case is O(N log N).  The sort is not stable.
+ * See mu_sort.h for sorts that inline the comparison for a given type.
  *
  * The user-supplied comparison function is called with two void * arguments,
  * and should return an integer less than, equal to, or greater than zero if
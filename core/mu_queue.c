@@ -46,6 +46,7 @@
 mu_queue_t *mu_queue_init(mu_queue_t *q) {
   mu_list_init(&q->takr);
   q->putr = NULL;
+  q->count = 0;
   return q;
 }
 
@@ -58,12 +59,16 @@ mu_queue_t *mu_queue_add(mu_queue_t *q, mu_list_t *item) {
     mu_list_push(q->putr, item);
   }
   q->putr = item;
+  q->count += 1;
 
   return q;
 }
 
 mu_list_t *mu_queue_remove(mu_queue_t *q) {
   mu_list_t *item = mu_list_pop(&q->takr);
+  if (item != NULL) {
+    q->count -= 1;
+  }
   if (mu_list_is_empty(&q->takr)) {
     q->putr = NULL;       // removing last item;
   }
@@ -85,7 +90,7 @@ bool mu_queue_contains(mu_queue_t *q, mu_list_t *item) {
 }
 
 int mu_queue_length(mu_queue_t *q) {
-  return mu_list_length(&q->takr);
+  return q->count;
 }
 
 // =============================================================================
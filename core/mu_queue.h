@@ -52,10 +52,14 @@ extern "C" {
 // +-------+     +---------+     +---------+  /  +---------+
 // | putr .|----------------------------------
 // +-------+
+//
+// The queue keeps a count of its items, so mu_queue_length() is O(1) as long as
+// the queue is only modified through the mu_queue_xxx() functions.
 
 typedef struct {
   mu_list_t takr;   // items are removed (popped) from the takr
   mu_list_t *putr;  // items are added (pushed) at the putr
+  size_t count;     // number of items in the queue
 } mu_queue_t;
 
 // =============================================================================
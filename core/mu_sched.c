@@ -27,163 +27,398 @@
 
 #include "mu_sched.h"
 
+#include "mu_atomic.h"
+#include "mu_bvec.h"
 #include "mu_config.h"
+#include "mu_list.h"
+#include "mu_mpsc.h"
 #include "mu_spsc.h"
 #include "mu_task.h"
+#include "mu_trace.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h> // memmove
 
 // =============================================================================
 // local types and definitions
 
-typedef struct {
-  mu_dlist_t task_list;     // time ordered list of tasks (soonest first)
-  mu_clock_fn clock_fn;     // function to call to get the current time
-  mu_task_t *idle_task;     // the idle task
-  mu_task_t *current_task;  // the task currently being processed
-  mu_spsc_t irq_task_queue; // Tasks queued at interrupt level
-  mu_spsc_item_t irq_task_queue_store[MU_IRQ_TASK_QUEUE_SIZE];
-} mu_sched_t;
+// The instance used by the mu_sched_xxx() convenience functions.  On multi-core
+// targets, mu_config.h may define MU_SCHED_DEFAULT() to select a different
+// instance on each core, e.g.:
+//
+//    #define MU_SCHED_DEFAULT() (&g_core_scheds[get_core_id()])
+//
+#ifndef MU_SCHED_DEFAULT
+#define MU_SCHED_DEFAULT() (&s_sched)
+#define MU_SCHED_USE_SINGLETON 1
+#endif
+
+// irq_task_queue is a mu_mpsc, which rejects any other capacity at runtime.
+#if ((MU_IRQ_TASK_QUEUE_SIZE & (MU_IRQ_TASK_QUEUE_SIZE - 1)) != 0) ||          \
+    (MU_IRQ_TASK_QUEUE_SIZE < 2) || (MU_IRQ_TASK_QUEUE_SIZE > 0x8000)
+#error "MU_IRQ_TASK_QUEUE_SIZE must be a power of two from 2 to 32768"
+#endif
+
+// Number of tasks moved from a mailbox per mu_spsc_get_n() call.
+#define MAILBOX_BATCH_SIZE 8
 
 // =============================================================================
 // local (forward) declarations
 
 static void default_idle_fn(void *self, void *arg);
 
-static mu_task_t *peek_next_task(void);
+static mu_task_t *peek_next_task(mu_sched_t *sched);
+
+static mu_task_t *pop_runnable_task(mu_sched_t *sched, mu_time_t now);
+
+static void transfer_isr_tasks(mu_sched_t *sched);
+
+static void *transfer_mailbox_aux(mu_list_t *prev, void *arg);
 
-static mu_task_t *get_runnable_task(mu_time_t now);
+static void run_task(mu_sched_t *sched, mu_task_t *task);
 
-static mu_sched_err_t queue_task(mu_task_t *task);
+static void run_idle(mu_sched_t *sched);
+
+static bool isr_tasks_pending(mu_sched_t *sched);
+
+static void *mailbox_pending_aux(mu_list_t *prev, void *arg);
+
+static mu_sched_err_t queue_task(mu_sched_t *sched, mu_task_t *task);
+
+static mu_task_t *unqueue_task(mu_sched_t *sched, mu_task_t *task);
+
+typedef struct {
+  mu_sched_traverse_fn user_fn;
+  void *arg;
+  bool safe;            // if true, skip tasks scheduled since traversal started
+  uint32_t seq_limit;   // the sched's seq when the traversal started
+} traverse_ctx_t;
 
-static mu_sched_err_t queue_isr_task(mu_task_t *task);
+static mu_task_t *traverse(mu_sched_t *sched,
+                           bool reverse,
+                           bool safe,
+                           mu_sched_traverse_fn user_fn,
+                           void *arg);
 
+#if !(MU_SCHED_USE_PHEAP) || (MU_TASK_PRIORITY_LEVELS > 1)
+static mu_task_t *traverse_dlist(mu_dlist_t *head,
+                                 bool reverse,
+                                 traverse_ctx_t *ctx);
+#endif
+
+static mu_task_t *visit_task(traverse_ctx_t *ctx, mu_task_t *task);
+
+static mu_sched_err_t queue_isr_task(mu_sched_t *sched, mu_task_t *task);
+
+#if (MU_SCHED_STATISTICS)
+static void stats_record_step(mu_sched_t *sched, mu_time_t now);
+static void stats_record_run(mu_sched_t *sched, mu_task_t *task);
+#endif
+
+// Operations on the schedule, independent of how it is stored.
+static void schedule_init(mu_sched_t *sched);
+static mu_task_t *schedule_first(mu_sched_t *sched);
+static void schedule_insert(mu_sched_t *sched, mu_task_t *task);
+static mu_task_t *schedule_remove(mu_sched_t *sched, mu_task_t *task);
+static mu_task_t *schedule_pop(mu_sched_t *sched);
+static int schedule_count(mu_sched_t *sched);
+static mu_task_t *schedule_traverse(mu_sched_t *sched,
+                                    bool reverse,
+                                    traverse_ctx_t *ctx);
+
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+// Runnable tasks, one FIFO per priority level.
+static void ready_init(mu_sched_t *sched);
+static mu_task_t *ready_first(mu_sched_t *sched);
+static void ready_push(mu_sched_t *sched, mu_task_t *task);
+static mu_task_t *ready_remove(mu_sched_t *sched, mu_task_t *task);
+static mu_task_t *ready_pop(mu_sched_t *sched);
+static int ready_count(mu_sched_t *sched);
+static mu_dlist_t *ready_highest_list(mu_sched_t *sched);
+static void promote_due_tasks(mu_sched_t *sched, mu_time_t now);
+#endif
+
+#if (MU_SCHED_USE_PHEAP)
+static bool task_precedes(mu_pheap_node_t *a, mu_pheap_node_t *b);
+static void *visit_task_aux(mu_pheap_node_t *node, void *arg);
+#else
 static mu_dlist_t *find_insertion_point(mu_dlist_t *head, mu_time_t time);
+#endif
 
 // =============================================================================
 // local storage
 
-// Singleton instance of the scheduler
+#if (MU_SCHED_USE_SINGLETON)
+// Default instance of the scheduler
 static mu_sched_t s_sched;
-
-static mu_task_t s_default_idle_task;
+#endif
 
 // =============================================================================
-// public code
+// public code: explicit scheduler instance
 
-void mu_sched_init() {
-  s_sched.clock_fn = mu_time_now;
-  s_sched.idle_task = &s_default_idle_task;
-  mu_task_init(&s_default_idle_task, default_idle_fn, NULL, "Idle");
+mu_sched_t *mu_sched_inst_init(mu_sched_t *sched) {
+  sched->clock_fn = mu_time_now;
+  sched->idle_task = &sched->default_idle_task;
+  sched->sleep_fn = NULL;
+  sched->wake_fn = NULL;
+  mu_task_init(&sched->default_idle_task, default_idle_fn, NULL, "Idle");
 
-  mu_spsc_init(&s_sched.irq_task_queue, s_sched.irq_task_queue_store,
-               MU_IRQ_TASK_QUEUE_SIZE);
-  mu_dlist_init(&s_sched.task_list);
-  mu_sched_reset();
+  mu_mpsc_err_t err = mu_mpsc_init(&sched->irq_task_queue,
+                                   sched->irq_task_queue_store,
+                                   MU_IRQ_TASK_QUEUE_SIZE);
+  assert(err == MU_MPSC_ERR_NONE);
+  (void)err; // unused when NDEBUG is defined
+  mu_list_init(&sched->mailboxes);
+  schedule_init(sched);
+  sched->seq = 0;
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  ready_init(sched);
+#endif
+  mu_sched_inst_reset(sched);
+  return sched;
 }
 
-void mu_sched_reset(void) {
-  mu_spsc_reset(&s_sched.irq_task_queue);
+void mu_sched_inst_reset(mu_sched_t *sched) {
+  mu_task_t *irq_task;
 
-  while (!mu_dlist_is_empty(&s_sched.task_list)) {
-    mu_dlist_pop(&s_sched.task_list);
+  while (mu_mpsc_get(&sched->irq_task_queue, (mu_mpsc_item_t *)(&irq_task)) ==
+         MU_MPSC_ERR_NONE) {
+    // discard tasks posted from interrupt level, allowing them to be re-posted
+    mu_atomic_clear(&irq_task->isr_pending);
+  }
+  mu_mpsc_reset(&sched->irq_task_queue);
+
+  while (schedule_pop(sched) != NULL) {
+    // remove all tasks from the schedule
+  }
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  while (ready_pop(sched) != NULL) {
+    // remove all runnable tasks
   }
-  s_sched.current_task = NULL;
+#endif
+  sched->current_task = NULL;
+#if (MU_SCHED_STATISTICS)
+  mu_sched_inst_reset_stats(sched);
+#endif
 }
 
-mu_sched_err_t mu_sched_step(void) {
-  mu_time_t now = mu_sched_get_current_time();
-  mu_task_t *irq_task;
+mu_sched_err_t mu_sched_inst_step(mu_sched_t *sched) {
+  mu_time_t now = mu_sched_inst_get_current_time(sched);
+#if (MU_SCHED_STATISTICS)
+  stats_record_step(sched, now);
+#endif
 
   // Transfer any pending tasks from the interrupt queue to the main queue
-  while (mu_spsc_get(&s_sched.irq_task_queue, (mu_spsc_item_t *)(&irq_task)) ==
-         MU_SPSC_ERR_NONE) {
-    queue_task(irq_task);
-  }
+  transfer_isr_tasks(sched);
 
   // Process one task in the main queue (or idle task if none are runnable)
-  s_sched.current_task = get_runnable_task(now);
-  mu_task_call(s_sched.current_task, NULL);
-  s_sched.current_task = NULL;
+  mu_task_t *task = pop_runnable_task(sched, now);
+  if (task != NULL) {
+    run_task(sched, task);
+  } else {
+    run_idle(sched);
+  }
 
   return MU_SCHED_ERR_NONE;
 }
 
-mu_task_t *mu_sched_get_idle_task(void) { return s_sched.idle_task; }
+int mu_sched_inst_step_batch(mu_sched_t *sched,
+                             int max_tasks,
+                             mu_duration_t budget) {
+  mu_time_t now = mu_sched_inst_get_current_time(sched);
+  mu_task_t *task;
+  int run_count = 0;
+#if (MU_SCHED_STATISTICS)
+  stats_record_step(sched, now);
+#endif
+
+  transfer_isr_tasks(sched);
 
-mu_task_t *mu_sched_get_default_idle_task(void) { return &s_default_idle_task; }
+  // Bound the batch by the number of tasks present at the start so a task
+  // that keeps rescheduling itself for "now" cannot run forever.
+  int limit = mu_sched_inst_task_count(sched);
+  if ((max_tasks > 0) && (max_tasks < limit)) {
+    limit = max_tasks;
+  }
 
-void mu_sched_set_idle_task(mu_task_t *task) { s_sched.idle_task = task; }
+  while (run_count < limit) {
+    if ((task = pop_runnable_task(sched, now)) == NULL) {
+      break;
+    }
+    run_task(sched, task);
+    run_count += 1;
+    if ((budget > 0) &&
+        (mu_time_difference(mu_sched_inst_get_current_time(sched), now) >=
+         budget)) {
+      break;
+    }
+  }
 
-mu_clock_fn mu_sched_get_clock_source(void) { return s_sched.clock_fn; }
+  task = peek_next_task(sched);
+  if ((task == NULL) || mu_time_follows(mu_task_get_time(task), now)) {
+    // every runnable task has been processed: run the idle task
+    run_idle(sched);
+  }
 
-void mu_sched_set_clock_source(mu_clock_fn clock_fn) {
-  s_sched.clock_fn = clock_fn;
+  return run_count;
 }
 
-mu_time_t mu_sched_get_current_time(void) { return s_sched.clock_fn(); }
+int mu_sched_inst_run_until_idle(mu_sched_t *sched) {
+  return mu_sched_inst_step_batch(sched, 0, 0);
+}
 
-int mu_sched_task_count(void) { return mu_dlist_length(&s_sched.task_list); }
+mu_task_t *mu_sched_inst_get_idle_task(mu_sched_t *sched) {
+  return sched->idle_task;
+}
 
-bool mu_sched_is_empty(void) { return mu_dlist_is_empty(&s_sched.task_list); }
+mu_task_t *mu_sched_inst_get_default_idle_task(mu_sched_t *sched) {
+  return &sched->default_idle_task;
+}
 
-mu_task_t *mu_sched_get_current_task(void) { return s_sched.current_task; }
+void mu_sched_inst_set_idle_task(mu_sched_t *sched, mu_task_t *task) {
+  sched->idle_task = task;
+}
 
-mu_task_t *mu_sched_get_next_task(void) { return peek_next_task(); }
+void mu_sched_inst_set_sleep_fn(mu_sched_t *sched, mu_sched_sleep_fn sleep_fn) {
+  sched->sleep_fn = sleep_fn;
+}
 
-mu_task_t *mu_sched_remove_task(mu_task_t *task) {
-  if (mu_dlist_unlink(mu_task_link(task)) == NULL) {
-    task = NULL;
+void mu_sched_inst_set_wake_fn(mu_sched_t *sched, mu_sched_wake_fn wake_fn) {
+  sched->wake_fn = wake_fn;
+}
+
+bool mu_sched_inst_isr_tasks_pending(mu_sched_t *sched) {
+  return isr_tasks_pending(sched);
+}
+
+uint32_t mu_sched_inst_isr_overflow_count(mu_sched_t *sched) {
+  return mu_mpsc_overflow_count(&sched->irq_task_queue);
+}
+
+uint16_t mu_sched_inst_isr_high_water(mu_sched_t *sched) {
+  return mu_mpsc_high_water(&sched->irq_task_queue);
+}
+
+#if (MU_SCHED_STATISTICS)
+
+void mu_sched_inst_get_stats(mu_sched_t *sched, mu_sched_stats_t *stats) {
+  *stats = sched->stats;
+  stats->isr_high_water = mu_mpsc_high_water(&sched->irq_task_queue);
+}
+
+void mu_sched_inst_reset_stats(mu_sched_t *sched) {
+  memset(&sched->stats, 0, sizeof(sched->stats));
+  mu_mpsc_reset_high_water(&sched->irq_task_queue);
+  sched->rate_start = mu_sched_inst_get_current_time(sched);
+  sched->rate_count = 0;
+}
+
+#endif
+
+mu_clock_fn mu_sched_inst_get_clock_source(mu_sched_t *sched) {
+  return sched->clock_fn;
+}
+
+void mu_sched_inst_set_clock_source(mu_sched_t *sched, mu_clock_fn clock_fn) {
+  sched->clock_fn = clock_fn;
+}
+
+mu_time_t mu_sched_inst_get_current_time(mu_sched_t *sched) {
+  return sched->clock_fn();
+}
+
+int mu_sched_inst_task_count(mu_sched_t *sched) {
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  return schedule_count(sched) + ready_count(sched);
+#else
+  return schedule_count(sched);
+#endif
+}
+
+bool mu_sched_inst_is_empty(mu_sched_t *sched) {
+  return peek_next_task(sched) == NULL;
+}
+
+mu_task_t *mu_sched_inst_get_current_task(mu_sched_t *sched) {
+  return sched->current_task;
+}
+
+mu_task_t *mu_sched_inst_get_next_task(mu_sched_t *sched) {
+  return peek_next_task(sched);
+}
+
+mu_sched_err_t mu_sched_inst_get_next_deadline(mu_sched_t *sched,
+                                               mu_time_t *deadline) {
+  mu_task_t *task = peek_next_task(sched);
+  if (task == NULL) {
+    return MU_SCHED_ERR_EMPTY;
   }
-  return task;
+  *deadline = mu_task_get_time(task);
+  return MU_SCHED_ERR_NONE;
 }
 
-mu_sched_err_t mu_sched_task_now(mu_task_t *task) {
-  mu_task_set_time(task, mu_sched_get_current_time());
-  return queue_task(task);
+mu_task_t *mu_sched_inst_remove_task(mu_sched_t *sched, mu_task_t *task) {
+  return unqueue_task(sched, task);
 }
 
-mu_sched_err_t mu_sched_task_at(mu_task_t *task, mu_time_t at) {
+mu_sched_err_t mu_sched_inst_task_now(mu_sched_t *sched, mu_task_t *task) {
+  mu_task_set_time(task, mu_sched_inst_get_current_time(sched));
+  return queue_task(sched, task);
+}
+
+mu_sched_err_t mu_sched_inst_task_at(mu_sched_t *sched,
+                                     mu_task_t *task,
+                                     mu_time_t at) {
   mu_task_set_time(task, at);
-  return queue_task(task);
+  return queue_task(sched, task);
 }
 
-mu_sched_err_t mu_sched_task_in(mu_task_t *task, mu_duration_t in) {
-  mu_task_set_time(task, mu_time_offset(mu_sched_get_current_time(), in));
-  return queue_task(task);
+mu_sched_err_t mu_sched_inst_task_in(mu_sched_t *sched,
+                                     mu_task_t *task,
+                                     mu_duration_t in) {
+  mu_task_set_time(
+      task, mu_time_offset(mu_sched_inst_get_current_time(sched), in));
+  return queue_task(sched, task);
 }
 
-mu_sched_err_t mu_sched_reschedule_now(void) {
-  mu_task_t *task = mu_sched_get_current_task();
-  return mu_sched_task_now(task);
+mu_sched_err_t mu_sched_inst_reschedule_now(mu_sched_t *sched) {
+  mu_task_t *task = mu_sched_inst_get_current_task(sched);
+  return mu_sched_inst_task_now(sched, task);
 }
 
-mu_sched_err_t mu_sched_reschedule_in(mu_duration_t in) {
-  mu_task_t *task = mu_sched_get_current_task();
+mu_sched_err_t mu_sched_inst_reschedule_in(mu_sched_t *sched,
+                                           mu_duration_t in) {
+  mu_task_t *task = mu_sched_inst_get_current_task(sched);
   mu_task_set_time(task, mu_time_offset(mu_task_get_time(task), in));
-  return queue_task(task);
+  return queue_task(sched, task);
 }
 
-mu_sched_err_t mu_sched_isr_task_now(mu_task_t *task) {
-  mu_task_set_time(task, mu_sched_get_current_time());
-  return queue_isr_task(task);
+mu_sched_err_t mu_sched_inst_isr_task_now(mu_sched_t *sched, mu_task_t *task) {
+  mu_task_set_time(task, mu_sched_inst_get_current_time(sched));
+  return queue_isr_task(sched, task);
 }
 
-mu_sched_err_t mu_sched_isr_task_at(mu_task_t *task, mu_time_t at) {
+mu_sched_err_t mu_sched_inst_isr_task_at(mu_sched_t *sched,
+                                         mu_task_t *task,
+                                         mu_time_t at) {
   mu_task_set_time(task, at);
-  return queue_isr_task(task);
+  return queue_isr_task(sched, task);
 }
 
-mu_sched_err_t mu_sched_isr_task_in(mu_task_t *task, mu_duration_t in) {
-  mu_task_set_time(task, mu_time_offset(mu_sched_get_current_time(), in));
-  return queue_isr_task(task);
+mu_sched_err_t mu_sched_inst_isr_task_in(mu_sched_t *sched,
+                                         mu_task_t *task,
+                                         mu_duration_t in) {
+  mu_task_set_time(
+      task, mu_time_offset(mu_sched_inst_get_current_time(sched), in));
+  return queue_isr_task(sched, task);
 }
 
-mu_sched_task_status_t mu_sched_get_task_status(mu_task_t *task) {
-  if (mu_sched_get_current_task() == task) {
+mu_sched_task_status_t mu_sched_inst_get_task_status(mu_sched_t *sched,
+                                                     mu_task_t *task) {
+  if (mu_sched_inst_get_current_task(sched) == task) {
     // task is the current task
     return MU_SCHED_TASK_STATUS_ACTIVE;
   }
@@ -191,7 +426,7 @@ mu_sched_task_status_t mu_sched_get_task_status(mu_task_t *task) {
     return MU_SCHED_TASK_STATUS_IDLE;
   }
 
-  mu_time_t now = mu_sched_get_current_time();
+  mu_time_t now = mu_sched_inst_get_current_time(sched);
   if (!mu_time_follows(mu_task_get_time(task), now)) {
     // task's time has arrived, but it's not yet running
     return MU_SCHED_TASK_STATUS_RUNNABLE;
@@ -202,9 +437,215 @@ mu_sched_task_status_t mu_sched_get_task_status(mu_task_t *task) {
   }
 }
 
+mu_task_t *mu_sched_inst_traverse(mu_sched_t *sched,
+                                  mu_sched_traverse_fn user_fn,
+                                  void *arg) {
+  return traverse(sched, false, false, user_fn, arg);
+}
+
+mu_task_t *mu_sched_inst_traverse_reverse(mu_sched_t *sched,
+                                          mu_sched_traverse_fn user_fn,
+                                          void *arg) {
+  return traverse(sched, true, false, user_fn, arg);
+}
+
+mu_task_t *mu_sched_inst_traverse_safe(mu_sched_t *sched,
+                                       mu_sched_traverse_fn user_fn,
+                                       void *arg) {
+  return traverse(sched, false, true, user_fn, arg);
+}
+
+mu_sched_err_t mu_sched_inst_attach_mailbox(mu_sched_t *sched,
+                                            mu_sched_mailbox_t *mailbox,
+                                            mu_spsc_item_t *store,
+                                            uint16_t capacity) {
+  if (mu_spsc_init(&mailbox->queue, store, capacity) != MU_SPSC_ERR_NONE) {
+    return MU_SCHED_ERR_SIZE;
+  }
+  mailbox->sched = sched;
+  mu_list_push(&sched->mailboxes, &mailbox->link);
+  return MU_SCHED_ERR_NONE;
+}
+
+// =============================================================================
+// public code: cross-instance mailboxes
+
+mu_sched_err_t mu_sched_mailbox_post_now(mu_sched_mailbox_t *mailbox,
+                                         mu_task_t *task) {
+  return mu_sched_mailbox_post_at(
+      mailbox, task, mu_sched_inst_get_current_time(mailbox->sched));
+}
+
+mu_sched_err_t mu_sched_mailbox_post_at(mu_sched_mailbox_t *mailbox,
+                                        mu_task_t *task,
+                                        mu_time_t at) {
+  mu_task_set_time(task, at);
+  if (mu_spsc_put(&mailbox->queue, task) != MU_SPSC_ERR_NONE) {
+    return MU_SCHED_ERR_FULL;
+  }
+  if (mailbox->sched->wake_fn != NULL) {
+    // cut short any sleep in progress on the receiving side
+    mailbox->sched->wake_fn();
+  }
+  return MU_SCHED_ERR_NONE;
+}
+
+mu_sched_err_t mu_sched_mailbox_post_in(mu_sched_mailbox_t *mailbox,
+                                        mu_task_t *task,
+                                        mu_duration_t in) {
+  return mu_sched_mailbox_post_at(
+      mailbox,
+      task,
+      mu_time_offset(mu_sched_inst_get_current_time(mailbox->sched), in));
+}
+
+// =============================================================================
+// public code: default scheduler instance
+
+mu_sched_t *mu_sched_get_default(void) { return MU_SCHED_DEFAULT(); }
+
+void mu_sched_init() { mu_sched_inst_init(MU_SCHED_DEFAULT()); }
+
+void mu_sched_reset(void) { mu_sched_inst_reset(MU_SCHED_DEFAULT()); }
+
+mu_sched_err_t mu_sched_step(void) {
+  return mu_sched_inst_step(MU_SCHED_DEFAULT());
+}
+
+int mu_sched_step_batch(int max_tasks, mu_duration_t budget) {
+  return mu_sched_inst_step_batch(MU_SCHED_DEFAULT(), max_tasks, budget);
+}
+
+int mu_sched_run_until_idle(void) {
+  return mu_sched_inst_run_until_idle(MU_SCHED_DEFAULT());
+}
+
+mu_task_t *mu_sched_get_idle_task(void) {
+  return mu_sched_inst_get_idle_task(MU_SCHED_DEFAULT());
+}
+
+mu_task_t *mu_sched_get_default_idle_task(void) {
+  return mu_sched_inst_get_default_idle_task(MU_SCHED_DEFAULT());
+}
+
+void mu_sched_set_idle_task(mu_task_t *task) {
+  mu_sched_inst_set_idle_task(MU_SCHED_DEFAULT(), task);
+}
+
+void mu_sched_set_sleep_fn(mu_sched_sleep_fn sleep_fn) {
+  mu_sched_inst_set_sleep_fn(MU_SCHED_DEFAULT(), sleep_fn);
+}
+
+void mu_sched_set_wake_fn(mu_sched_wake_fn wake_fn) {
+  mu_sched_inst_set_wake_fn(MU_SCHED_DEFAULT(), wake_fn);
+}
+
+bool mu_sched_isr_tasks_pending(void) {
+  return mu_sched_inst_isr_tasks_pending(MU_SCHED_DEFAULT());
+}
+
+uint32_t mu_sched_isr_overflow_count(void) {
+  return mu_sched_inst_isr_overflow_count(MU_SCHED_DEFAULT());
+}
+
+uint16_t mu_sched_isr_high_water(void) {
+  return mu_sched_inst_isr_high_water(MU_SCHED_DEFAULT());
+}
+
+#if (MU_SCHED_STATISTICS)
+
+void mu_sched_get_stats(mu_sched_stats_t *stats) {
+  mu_sched_inst_get_stats(MU_SCHED_DEFAULT(), stats);
+}
+
+void mu_sched_reset_stats(void) {
+  mu_sched_inst_reset_stats(MU_SCHED_DEFAULT());
+}
+
+#endif
+
+mu_clock_fn mu_sched_get_clock_source(void) {
+  return mu_sched_inst_get_clock_source(MU_SCHED_DEFAULT());
+}
+
+void mu_sched_set_clock_source(mu_clock_fn clock_fn) {
+  mu_sched_inst_set_clock_source(MU_SCHED_DEFAULT(), clock_fn);
+}
+
+mu_time_t mu_sched_get_current_time(void) {
+  return mu_sched_inst_get_current_time(MU_SCHED_DEFAULT());
+}
+
+int mu_sched_task_count(void) {
+  return mu_sched_inst_task_count(MU_SCHED_DEFAULT());
+}
+
+bool mu_sched_is_empty(void) {
+  return mu_sched_inst_is_empty(MU_SCHED_DEFAULT());
+}
+
+mu_task_t *mu_sched_get_current_task(void) {
+  return mu_sched_inst_get_current_task(MU_SCHED_DEFAULT());
+}
+
+mu_task_t *mu_sched_get_next_task(void) {
+  return mu_sched_inst_get_next_task(MU_SCHED_DEFAULT());
+}
+
+mu_sched_err_t mu_sched_get_next_deadline(mu_time_t *deadline) {
+  return mu_sched_inst_get_next_deadline(MU_SCHED_DEFAULT(), deadline);
+}
+
+mu_task_t *mu_sched_remove_task(mu_task_t *task) {
+  return mu_sched_inst_remove_task(MU_SCHED_DEFAULT(), task);
+}
+
+mu_sched_err_t mu_sched_task_now(mu_task_t *task) {
+  return mu_sched_inst_task_now(MU_SCHED_DEFAULT(), task);
+}
+
+mu_sched_err_t mu_sched_task_at(mu_task_t *task, mu_time_t at) {
+  return mu_sched_inst_task_at(MU_SCHED_DEFAULT(), task, at);
+}
+
+mu_sched_err_t mu_sched_task_in(mu_task_t *task, mu_duration_t in) {
+  return mu_sched_inst_task_in(MU_SCHED_DEFAULT(), task, in);
+}
+
+mu_sched_err_t mu_sched_reschedule_now(void) {
+  return mu_sched_inst_reschedule_now(MU_SCHED_DEFAULT());
+}
+
+mu_sched_err_t mu_sched_reschedule_in(mu_duration_t in) {
+  return mu_sched_inst_reschedule_in(MU_SCHED_DEFAULT(), in);
+}
+
+mu_sched_err_t mu_sched_isr_task_now(mu_task_t *task) {
+  return mu_sched_inst_isr_task_now(MU_SCHED_DEFAULT(), task);
+}
+
+mu_sched_err_t mu_sched_isr_task_at(mu_task_t *task, mu_time_t at) {
+  return mu_sched_inst_isr_task_at(MU_SCHED_DEFAULT(), task, at);
+}
+
+mu_sched_err_t mu_sched_isr_task_in(mu_task_t *task, mu_duration_t in) {
+  return mu_sched_inst_isr_task_in(MU_SCHED_DEFAULT(), task, in);
+}
+
+mu_sched_task_status_t mu_sched_get_task_status(mu_task_t *task) {
+  return mu_sched_inst_get_task_status(MU_SCHED_DEFAULT(), task);
+}
+
 mu_task_t *mu_sched_traverse(mu_sched_traverse_fn user_fn, void *arg) {
-  // TODO: Implement me.
-  return NULL;
+  return mu_sched_inst_traverse(MU_SCHED_DEFAULT(), user_fn, arg);
+}
+
+mu_task_t *mu_sched_traverse_reverse(mu_sched_traverse_fn user_fn, void *arg) {
+  return mu_sched_inst_traverse_reverse(MU_SCHED_DEFAULT(), user_fn, arg);
+}
+
+mu_task_t *mu_sched_traverse_safe(mu_sched_traverse_fn user_fn, void *arg) {
+  return mu_sched_inst_traverse_safe(MU_SCHED_DEFAULT(), user_fn, arg);
 }
 
 // =============================================================================
@@ -216,52 +657,482 @@ static void default_idle_fn(void *self, void *arg) {
   // the default idle task doesn't do much...
 }
 
-static mu_task_t *peek_next_task(void) {
-  mu_dlist_t *link = mu_dlist_first(&s_sched.task_list);
-  if (link != NULL) {
-    return MU_DLIST_CONTAINER(link, mu_task_t, link);
-  } else {
-    return NULL;
+static mu_task_t *peek_next_task(mu_sched_t *sched) {
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  mu_task_t *task = ready_first(sched);
+  if (task != NULL) {
+    return task;
   }
+#endif
+  return schedule_first(sched);
 }
 
-static mu_task_t *get_runnable_task(mu_time_t now) {
-  mu_task_t *task = NULL;
+static mu_task_t *pop_runnable_task(mu_sched_t *sched, mu_time_t now) {
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  promote_due_tasks(sched, now);
+  return ready_pop(sched);
+#else
+  mu_task_t *task = peek_next_task(sched); // peek at next task.
 
-  task = peek_next_task(); // peek at next task.
   if ((task != NULL) && !mu_time_follows(mu_task_get_time(task), now)) {
     // time to run the task: pop from queue
-    mu_dlist_pop(&s_sched.task_list);
+    schedule_pop(sched);
+    return task;
   } else {
-    // no runnable task in the queue: use the idle task.
-    task = mu_sched_get_idle_task();
+    return NULL;
   }
-  return task;
+#endif
+}
+
+static void transfer_isr_tasks(mu_sched_t *sched) {
+  mu_task_t *irq_task;
+
+  while (mu_mpsc_get(&sched->irq_task_queue, (mu_mpsc_item_t *)(&irq_task)) ==
+         MU_MPSC_ERR_NONE) {
+    // Clear the flag before queue_task() reads the task's time: a post that
+    // arrives after this point is queued afresh rather than coalesced.  The
+    // clear only has release semantics, so fence to keep the read of the
+    // task's time from being moved above it.
+    mu_atomic_clear(&irq_task->isr_pending);
+    mu_atomic_fence();
+    queue_task(sched, irq_task);
+  }
+  // Tasks posted by other scheduler instances
+  mu_list_traverse(&sched->mailboxes, transfer_mailbox_aux, sched);
+}
+
+static void *transfer_mailbox_aux(mu_list_t *prev, void *arg) {
+  mu_sched_t *sched = (mu_sched_t *)arg;
+  mu_list_t *link = mu_list_next_element(prev);
+
+  if (link != NULL) {
+    mu_sched_mailbox_t *mailbox =
+        MU_LIST_CONTAINER(link, mu_sched_mailbox_t, link);
+    mu_spsc_item_t batch[MAILBOX_BATCH_SIZE];
+    uint16_t n;
+    // Drain in batches so a burst of posts costs one head update per batch
+    // rather than one per task.
+    while ((n = mu_spsc_get_n(&mailbox->queue, batch, MAILBOX_BATCH_SIZE)) >
+           0) {
+      for (uint16_t i = 0; i < n; i++) {
+        queue_task(sched, (mu_task_t *)batch[i]);
+      }
+    }
+  }
+  return NULL;
 }
 
-static mu_sched_err_t queue_task(mu_task_t *task) {
-  mu_time_t time = mu_task_get_time(task);
-  if (mu_dlist_unlink(mu_task_link(task)) != NULL) {
+static void run_task(mu_sched_t *sched, mu_task_t *task) {
+#if (MU_TASK_PROFILING)
+  if (task != sched->idle_task) {
+    // scheduling latency: how late the task starts relative to its time
+    mu_task_record_latency(
+        task, mu_time_difference(sched->clock_fn(), mu_task_get_time(task)));
+  }
+#endif
+#if (MU_SCHED_STATISTICS)
+  stats_record_run(sched, task);
+#endif
+  sched->current_task = task;
+  MU_TRACE(MU_TRACE_EVENT_TASK_START, task, 0);
+  mu_task_call(task, NULL);
+  MU_TRACE(MU_TRACE_EVENT_TASK_END, task, 0);
+  sched->current_task = NULL;
+}
+
+static void run_idle(mu_sched_t *sched) {
+  run_task(sched, mu_sched_inst_get_idle_task(sched));
+
+  if (sched->sleep_fn == NULL || isr_tasks_pending(sched)) {
+    // not tickless, or an interrupt has posted work: don't sleep.
+    return;
+  }
+  mu_time_t deadline;
+  if (mu_sched_inst_get_next_deadline(sched, &deadline) == MU_SCHED_ERR_EMPTY) {
+    sched->sleep_fn(0, true);
+  } else {
+    mu_duration_t duration =
+        mu_time_difference(deadline, mu_sched_inst_get_current_time(sched));
+    if (duration > 0) {
+      sched->sleep_fn(duration, false);
+    }
+  }
+}
+
+static bool isr_tasks_pending(mu_sched_t *sched) {
+  if (!mu_mpsc_is_empty(&sched->irq_task_queue)) {
+    return true;
+  }
+  return mu_list_traverse(&sched->mailboxes, mailbox_pending_aux, NULL) != NULL;
+}
+
+static void *mailbox_pending_aux(mu_list_t *prev, void *arg) {
+  (void)(arg);
+  mu_list_t *link = mu_list_next_element(prev);
+
+  if (link != NULL) {
+    mu_sched_mailbox_t *mailbox =
+        MU_LIST_CONTAINER(link, mu_sched_mailbox_t, link);
+    if (!mu_spsc_is_empty(&mailbox->queue)) {
+      return mailbox;
+    }
+  }
+  return NULL;
+}
+
+static mu_sched_err_t queue_task(mu_sched_t *sched, mu_task_t *task) {
+  if (unqueue_task(sched, task) != NULL) {
     // here if a task was already scheduled - useful for debugging
     asm("nop");
   }
-  mu_dlist_t *list = find_insertion_point(&s_sched.task_list, time);
-  mu_dlist_insert_prev(list, mu_task_link(task));
+  task->seq = sched->seq++;
+  schedule_insert(sched, task);
+#if (MU_SCHED_STATISTICS)
+  size_t depth = (size_t)mu_sched_inst_task_count(sched);
+  if (depth > sched->stats.max_queue_depth) {
+    sched->stats.max_queue_depth = depth;
+  }
+#endif
+  MU_TRACE(MU_TRACE_EVENT_TASK_QUEUED, task, mu_task_get_priority(task));
   // mu_sched_print_state();  // ###
   return MU_SCHED_ERR_NONE;
 }
 
-static mu_sched_err_t queue_isr_task(mu_task_t *task) {
+static mu_task_t *unqueue_task(mu_sched_t *sched, mu_task_t *task) {
+  mu_task_t *removed = schedule_remove(sched, task);
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  if (removed == NULL) {
+    removed = ready_remove(sched, task);
+  }
+#endif
+  return removed;
+}
+
+static mu_task_t *traverse(mu_sched_t *sched,
+                           bool reverse,
+                           bool safe,
+                           mu_sched_traverse_fn user_fn,
+                           void *arg) {
+  traverse_ctx_t ctx = {.user_fn = user_fn,
+                        .arg = arg,
+                        .safe = safe,
+                        .seq_limit = sched->seq};
+  mu_task_t *result = NULL;
+
+  if (reverse) {
+    result = schedule_traverse(sched, true, &ctx);
+  }
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  for (int i = 0; i < MU_TASK_PRIORITY_LEVELS && result == NULL; i++) {
+    int level = reverse ? MU_TASK_PRIORITY_LEVELS - 1 - i : i;
+    result = traverse_dlist(&sched->ready_lists[level], reverse, &ctx);
+  }
+#endif
+  if (!reverse && result == NULL) {
+    result = schedule_traverse(sched, false, &ctx);
+  }
+  return result;
+}
+
+#if !(MU_SCHED_USE_PHEAP) || (MU_TASK_PRIORITY_LEVELS > 1)
+static mu_task_t *traverse_dlist(mu_dlist_t *head,
+                                 bool reverse,
+                                 traverse_ctx_t *ctx) {
+  mu_dlist_t *link = reverse ? mu_dlist_prev(head) : mu_dlist_next(head);
+  mu_task_t *result = NULL;
+
+  while (link != head && result == NULL) {
+    // fetch the following link first in case the visited task is removed
+    mu_dlist_t *following = reverse ? mu_dlist_prev(link) : mu_dlist_next(link);
+    result = visit_task(ctx, MU_DLIST_CONTAINER(link, mu_task_t, link));
+    link = following;
+  }
+  return result;
+}
+#endif
+
+static mu_task_t *visit_task(traverse_ctx_t *ctx, mu_task_t *task) {
+  if (ctx->safe && (int32_t)(task->seq - ctx->seq_limit) >= 0) {
+    // task was (re)scheduled after the traversal started: skip it
+    return NULL;
+  }
+  return ctx->user_fn(task, ctx->arg);
+}
+
+static mu_sched_err_t queue_isr_task(mu_sched_t *sched, mu_task_t *task) {
   // Add task to the ISR task queue.  This can be safely called from interrupt
-  // level because irq_task_queue is a single producer / single consumer queue
-  // designed for this purpose.
-  if (mu_spsc_put(&s_sched.irq_task_queue, task) != MU_SPSC_ERR_NONE) {
+  // level because irq_task_queue is a multiple producer / single consumer queue
+  // designed for this purpose.  (A failed put is counted by the queue.)
+  if (mu_atomic_test_and_set(&task->isr_pending)) {
+    // already in the queue: the post coalesces with the queued one, which
+    // will use the time just set.
+    MU_TRACE(MU_TRACE_EVENT_ISR_COALESCED, task, 0);
+    return MU_SCHED_ERR_NONE;
+  }
+  if (mu_mpsc_put(&sched->irq_task_queue, task) != MU_MPSC_ERR_NONE) {
+    mu_atomic_clear(&task->isr_pending);
+    MU_TRACE(MU_TRACE_EVENT_ISR_OVERFLOW, task, 0);
     return MU_SCHED_ERR_FULL;
   } else {
+    MU_TRACE(MU_TRACE_EVENT_ISR_QUEUED, task, 0);
+    if (sched->wake_fn != NULL) {
+      // cut short any sleep in progress
+      sched->wake_fn();
+    }
     return MU_SCHED_ERR_NONE;
   }
 }
 
+#if (MU_SCHED_STATISTICS)
+
+static void stats_record_step(mu_sched_t *sched, mu_time_t now) {
+  mu_duration_t second = mu_time_ms_to_duration(1000);
+  mu_duration_t elapsed = mu_time_difference(now, sched->rate_start);
+
+  sched->stats.step_count += 1;
+  if (elapsed >= second) {
+    // Scale to one second: the window may have run long if the processor
+    // slept through its end.
+    sched->stats.tasks_per_second =
+        (uint32_t)(((uint64_t)sched->rate_count * second) / elapsed);
+    sched->rate_start = now;
+    sched->rate_count = 0;
+  }
+}
+
+static void stats_record_run(mu_sched_t *sched, mu_task_t *task) {
+  if (task == sched->idle_task) {
+    sched->stats.idle_count += 1;
+  } else {
+    mu_duration_t lateness =
+        mu_time_difference(sched->clock_fn(), mu_task_get_time(task));
+    sched->stats.run_count += 1;
+    sched->rate_count += 1;
+    if (lateness > sched->stats.max_lateness) {
+      sched->stats.max_lateness = lateness;
+    }
+  }
+}
+
+#endif
+
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+
+// Tasks whose time has arrived are moved from the schedule into the ready list
+// of their priority level.  Since they are moved in time order, each ready list
+// stays in time order.  A bit is set in ready_bits for each level that may have
+// runnable tasks, so the highest ready level is found without scanning the
+// lists.  Ready tasks use the task's dlist link, which (with the dlist backend)
+// is free to reuse once the task has left the time ordered schedule.
+
+static void ready_init(mu_sched_t *sched) {
+  for (int i = 0; i < MU_TASK_PRIORITY_LEVELS; i++) {
+    mu_dlist_init(&sched->ready_lists[i]);
+  }
+  memset(sched->ready_bits, 0, sizeof(sched->ready_bits));
+  sched->ready_count = 0;
+}
+
+static mu_task_t *ready_first(mu_sched_t *sched) {
+  mu_dlist_t *list = ready_highest_list(sched);
+  if (list != NULL) {
+    return MU_DLIST_CONTAINER(mu_dlist_first(list), mu_task_t, link);
+  } else {
+    return NULL;
+  }
+}
+
+static void ready_push(mu_sched_t *sched, mu_task_t *task) {
+  uint8_t level = mu_task_get_priority(task);
+  mu_dlist_insert_prev(&sched->ready_lists[level], mu_task_link(task));
+  mu_bvec_set(level, sched->ready_bits);
+  task->is_ready = 1;
+  sched->ready_count += 1;
+}
+
+static mu_task_t *ready_remove(mu_sched_t *sched, mu_task_t *task) {
+  if (!task->is_ready) {
+    return NULL;
+  }
+  mu_dlist_unlink(mu_task_link(task));
+  task->is_ready = 0;
+  sched->ready_count -= 1;
+  // The level's bit is cleared lazily by ready_highest_list() if the list is
+  // now empty.
+  return task;
+}
+
+static mu_task_t *ready_pop(mu_sched_t *sched) {
+  mu_dlist_t *list = ready_highest_list(sched);
+  if (list != NULL) {
+    mu_task_t *task = MU_DLIST_CONTAINER(mu_dlist_pop(list), mu_task_t, link);
+    task->is_ready = 0;
+    sched->ready_count -= 1;
+    return task;
+  } else {
+    return NULL;
+  }
+}
+
+static int ready_count(mu_sched_t *sched) {
+  return sched->ready_count;
+}
+
+/**
+ * @brief Return the non-empty ready list of the highest priority, or NULL if
+ * no task is ready.
+ */
+static mu_dlist_t *ready_highest_list(mu_sched_t *sched) {
+  size_t level;
+  while ((level = mu_bvec_find_first_one(MU_TASK_PRIORITY_LEVELS,
+                                         sched->ready_bits)) != SIZE_MAX) {
+    mu_dlist_t *list = &sched->ready_lists[level];
+    if (!mu_dlist_is_empty(list)) {
+      return list;
+    }
+    // stale bit: the last task at this level was removed.
+    mu_bvec_clear(level, sched->ready_bits);
+  }
+  return NULL;
+}
+
+static void promote_due_tasks(mu_sched_t *sched, mu_time_t now) {
+  mu_task_t *task;
+  while (((task = schedule_first(sched)) != NULL) &&
+         !mu_time_follows(mu_task_get_time(task), now)) {
+    schedule_pop(sched);
+    ready_push(sched, task);
+  }
+}
+
+#endif // #if (MU_TASK_PRIORITY_LEVELS > 1)
+
+#if (MU_SCHED_USE_PHEAP)
+
+// Schedule stored as a pairing heap.  Tasks with the same time are ordered by
+// their sequence number so that they run in the order they were scheduled.
+
+static void schedule_init(mu_sched_t *sched) {
+  mu_pheap_init(&sched->task_heap, task_precedes);
+}
+
+static mu_task_t *schedule_first(mu_sched_t *sched) {
+  mu_pheap_node_t *node = mu_pheap_peek(&sched->task_heap);
+  if (node != NULL) {
+    return MU_PHEAP_CONTAINER(node, mu_task_t, heap_link);
+  } else {
+    return NULL;
+  }
+}
+
+static void schedule_insert(mu_sched_t *sched, mu_task_t *task) {
+  mu_pheap_insert(&sched->task_heap, &task->heap_link);
+}
+
+static mu_task_t *schedule_remove(mu_sched_t *sched, mu_task_t *task) {
+  if (mu_pheap_remove(&sched->task_heap, &task->heap_link) == NULL) {
+    task = NULL;
+  }
+  return task;
+}
+
+static mu_task_t *schedule_pop(mu_sched_t *sched) {
+  mu_pheap_node_t *node = mu_pheap_pop(&sched->task_heap);
+  if (node != NULL) {
+    return MU_PHEAP_CONTAINER(node, mu_task_t, heap_link);
+  } else {
+    return NULL;
+  }
+}
+
+static int schedule_count(mu_sched_t *sched) {
+  return mu_pheap_count(&sched->task_heap);
+}
+
+static mu_task_t *schedule_traverse(mu_sched_t *sched,
+                                    bool reverse,
+                                    traverse_ctx_t *ctx) {
+  if (reverse) {
+    return mu_pheap_traverse_reverse(&sched->task_heap, visit_task_aux, ctx);
+  } else {
+    return mu_pheap_traverse(&sched->task_heap, visit_task_aux, ctx);
+  }
+}
+
+static void *visit_task_aux(mu_pheap_node_t *node, void *arg) {
+  return visit_task((traverse_ctx_t *)arg,
+                    MU_PHEAP_CONTAINER(node, mu_task_t, heap_link));
+}
+
+static bool task_precedes(mu_pheap_node_t *a, mu_pheap_node_t *b) {
+  mu_task_t *ta = MU_PHEAP_CONTAINER(a, mu_task_t, heap_link);
+  mu_task_t *tb = MU_PHEAP_CONTAINER(b, mu_task_t, heap_link);
+  if (mu_time_precedes(ta->time, tb->time)) {
+    return true;
+  } else if (mu_time_precedes(tb->time, ta->time)) {
+    return false;
+  } else {
+    // same time: earlier sequence number first (tolerates wraparound)
+    return (int32_t)(ta->seq - tb->seq) < 0;
+  }
+}
+
+#else
+
+// Schedule stored as a time ordered doubly linked list.
+
+static void schedule_init(mu_sched_t *sched) {
+  mu_dlist_counted_init(&sched->task_list);
+}
+
+static mu_task_t *schedule_first(mu_sched_t *sched) {
+  mu_dlist_t *link = mu_dlist_first(mu_dlist_counted_head(&sched->task_list));
+  if (link != NULL) {
+    return MU_DLIST_CONTAINER(link, mu_task_t, link);
+  } else {
+    return NULL;
+  }
+}
+
+static void schedule_insert(mu_sched_t *sched, mu_task_t *task) {
+  mu_dlist_t *list =
+      find_insertion_point(mu_dlist_counted_head(&sched->task_list),
+                           mu_task_get_time(task));
+  mu_dlist_counted_insert_prev(&sched->task_list, list, mu_task_link(task));
+}
+
+static mu_task_t *schedule_remove(mu_sched_t *sched, mu_task_t *task) {
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  if (task->is_ready) {
+    // the task's link is in a ready list, not in the schedule
+    return NULL;
+  }
+#endif
+  if (mu_dlist_counted_unlink(&sched->task_list, mu_task_link(task)) == NULL) {
+    task = NULL;
+  }
+  return task;
+}
+
+static mu_task_t *schedule_pop(mu_sched_t *sched) {
+  mu_dlist_t *link = mu_dlist_counted_pop(&sched->task_list);
+  if (link != NULL) {
+    return MU_DLIST_CONTAINER(link, mu_task_t, link);
+  } else {
+    return NULL;
+  }
+}
+
+static int schedule_count(mu_sched_t *sched) {
+  return mu_dlist_counted_length(&sched->task_list);
+}
+
+static mu_task_t *schedule_traverse(mu_sched_t *sched,
+                                    bool reverse,
+                                    traverse_ctx_t *ctx) {
+  return traverse_dlist(mu_dlist_counted_head(&sched->task_list), reverse, ctx);
+}
+
 /**
  * @brief Return the list element that "is older" than the given time.
  *
@@ -285,3 +1156,5 @@ static mu_dlist_t *find_insertion_point(mu_dlist_t *head, mu_time_t time) {
     return list;
   }
 }
+
+#endif // #if (MU_SCHED_USE_PHEAP)
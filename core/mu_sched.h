@@ -52,6 +52,14 @@ is where all the magic happens.  The scheduler examines the first task in the
 queue, and if its start time has arrived, the task is removed from the queue and
 is called.
 
+Under burst load, the batch variants
+
+    int mu_sched_step_batch(int max_tasks, mu_duration_t budget);
+    int mu_sched_run_until_idle(void);
+
+read the clock and drain the ISR queue once, then run every task whose time has
+arrived before calling the idle task.
+
 ## Implementation of the scheduler queue
 
 mu_sched makes an conscious design choice that each task may only appear once
@@ -67,16 +75,84 @@ This approach also means that the task can encapsulate the `prev` and `next`
 link fields requires to insert it into the queue, so no additional storage is
 required.
 
+Inserting into a sorted list is O(n), which becomes costly with hundreds of
+tasks.  If MU_SCHED_USE_PHEAP is defined as 1 in mu_config.h, the queue is
+instead implemented as a pairing heap (see mu_pheap.h) whose links also live in
+the task: scheduling a task is O(1) and removing a task (including running the
+next task) is O(log n) amortized.  Tasks that are scheduled for the same time
+still run in the order in which they were scheduled.
+
+## Task priorities
+
+If MU_TASK_PRIORITY_LEVELS is defined greater than 1 in mu_config.h, each task
+has a priority (set with mu_task_set_priority(), 0 being the highest).  The
+time ordered schedule then only holds tasks whose time has not yet arrived: at
+each step, tasks that have come due are moved to a FIFO ready list for their
+priority, and a bit vector of non-empty levels lets the scheduler find the
+highest priority ready task without scanning.  A slow, low priority task can
+still delay a high priority one by the time it takes to run (tasks run to
+completion), but no longer by its position in the schedule.
+
 ## Implementation of the ISR queue
 
 mu_sched supports scheduling tasks from interrupt level via the
 `mu_sched_isr_task_xxx()` functions.  Unlike their foreground counterparts,
 these functions do not add tasks directly to the scheduler queue.  Instead,
-tasks are added to a "single produce, single consumer" isr queue, which is
-guaranteed to be interrupt safe.
+tasks are added to a "multiple producer, single consumer" isr queue (see
+mu_mpsc.h), which is guaranteed to be interrupt safe, even when interrupts of
+different priorities preempt one another while posting tasks.  If the isr queue
+is full, the post fails with MU_SCHED_ERR_FULL and the failure is counted: see
+mu_sched_isr_overflow_count().
+
+A task occupies at most one entry in the isr queue: posting a task that is
+already waiting there only updates its time, so an interrupt storm that posts
+the same task repeatedly cannot crowd out other tasks.  The queue's high-water
+mark (mu_sched_isr_high_water()) shows how close it has come to filling up.
 
 At foreground level, at the next call to mu_sched_step(), any tasks on the isr
 queue are transferred from the isr queue to the regular scheduler queue.
+
+## Health statistics
+
+If MU_SCHED_STATISTICS is defined as 1, each scheduler instance keeps a small
+block of load counters: steps taken, steps that fell through to the idle task,
+tasks run, the worst lateness of a task (how long after its scheduled time it
+started), the deepest the schedule has been and the number of tasks run in the
+most recent one second window.  mu_sched_get_stats() copies them, together with
+the isr queue high-water mark, into a mu_sched_stats_t in one call, and
+mu_sched_reset_stats() starts a new measurement period.  A falling idle ratio
+or a growing lateness is an early sign that a node is overloaded.
+
+## Tickless idle
+
+If a sleep function is installed with mu_sched_set_sleep_fn(), the scheduler
+calls it after the idle task with the time remaining until the next scheduled
+task (or "forever" if the schedule is empty), so the processor can sleep
+instead of spinning on mu_sched_step().  No sleep is requested while tasks are
+waiting in the isr queue, and an optional wake function installed with
+mu_sched_set_wake_fn() is called at interrupt level each time a task is posted.
+
+## Tracing
+
+If MU_SCHED_TRACE is defined as 1, the scheduler writes a compact binary record
+to the mu_trace ring each time a task is queued, posted from interrupt level,
+started and finished.  See mu_trace.h for the record format.
+
+## Multiple scheduler instances
+
+The mu_sched_xxx() functions operate on a default instance.  Each of them has
+a mu_sched_inst_xxx() counterpart that takes an explicit mu_sched_t, so a
+multi-core part can run an independent scheduler on each core.  A port may
+also define MU_SCHED_DEFAULT() in mu_config.h to select a per-core instance,
+in which case existing code (including mu_timer) uses the scheduler of the
+core it runs on.
+
+Instances never touch each other's schedules.  To hand a task to a scheduler
+on another core, the receiving core attaches one mu_sched_mailbox_t per
+sending core with mu_sched_inst_attach_mailbox(); the sender then calls
+mu_sched_mailbox_post_xxx().  Each mailbox is a single producer / single
+consumer queue, so no locking is needed, and posting calls the receiver's
+wake function so that a tickless receiver does not oversleep.
 */
 
 #ifndef _MU_SCHED_H_
@@ -92,6 +168,13 @@ extern "C" {
 //#include "mulib.h"
 
 
+#include "mu_bvec.h"
+#include "mu_config.h"
+#include "mu_dlist.h"
+#include "mu_list.h"
+#include "mu_mpsc.h"
+#include "mu_pheap.h"
+#include "mu_spsc.h"
 #include "mu_task.h"
 #include "mu_time.h"
 #include <stdbool.h>
@@ -101,12 +184,17 @@ extern "C" {
 // =============================================================================
 // types and definitions
 
+#ifndef MU_SCHED_STATISTICS
+#define MU_SCHED_STATISTICS 0
+#endif
+
 typedef enum {
   MU_SCHED_ERR_NONE,
   MU_SCHED_ERR_EMPTY,
   MU_SCHED_ERR_FULL,
   MU_SCHED_ERR_NOT_FOUND,
   MU_SCHED_ERR_NULL_TASK,  // return value for scheduling null task.
+  MU_SCHED_ERR_SIZE,       // mailbox capacity is not a power of two
 } mu_sched_err_t;
 
 typedef enum {
@@ -119,6 +207,26 @@ typedef enum {
 // Signature for clock source function.  Returns the current time.
 typedef mu_time_t (*mu_clock_fn)(void);
 
+/**
+ * @brief Signature for a tickless sleep function.
+ *
+ * Called after the idle task when no task is runnable.  The function may put
+ * the processor to sleep for up to `duration`, or indefinitely if `forever` is
+ * true (in which case `duration` is unused).  It must return early when an
+ * interrupt posts a task: a typical implementation disables interrupts, checks
+ * mu_sched_isr_tasks_pending(), and only then waits for an interrupt.
+ *
+ * @param duration The time until the next scheduled task.
+ * @param forever True if there are no scheduled tasks.
+ */
+typedef void (*mu_sched_sleep_fn)(mu_duration_t duration, bool forever);
+
+/**
+ * @brief Signature for a wake function, called from interrupt level whenever
+ * a task is posted to the ISR queue.
+ */
+typedef void (*mu_sched_wake_fn)(void);
+
 /**
  * @brief Signature for a function passed to mu_sched_traverse.
  *
@@ -128,6 +236,70 @@ typedef mu_time_t (*mu_clock_fn)(void);
  */
 typedef mu_task_t *(*mu_sched_traverse_fn)(mu_task_t *task, void *arg);
 
+#if (MU_SCHED_STATISTICS)
+
+/**
+ * @brief Scheduler load counters, as returned by mu_sched_get_stats().  All
+ * values cover the period since the statistics were last reset.
+ */
+typedef struct {
+  uint32_t step_count;        // calls to mu_sched_step() and its batch variants
+  uint32_t idle_count;        // steps that ran the idle task
+  uint32_t run_count;         // tasks run, not counting the idle task
+  mu_duration_t max_lateness; // longest delay from a task's time to its start
+  size_t max_queue_depth;     // largest number of tasks scheduled at once
+  uint16_t isr_high_water;    // largest number of tasks in the isr queue
+  uint32_t tasks_per_second;  // tasks run during the last complete second
+} mu_sched_stats_t;
+
+#endif
+
+/**
+ * @brief A scheduler instance.
+ *
+ * Treat the fields as private: use the mu_sched_inst_xxx() functions.
+ */
+typedef struct {
+#if (MU_SCHED_USE_PHEAP)
+  mu_pheap_t task_heap;     // heap ordered tasks (soonest at the root)
+#else
+  mu_dlist_counted_t task_list; // time ordered list of tasks (soonest first)
+#endif
+  uint32_t seq;             // sequence number for the next queued task
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  mu_dlist_t ready_lists[MU_TASK_PRIORITY_LEVELS]; // runnable tasks by priority
+  mu_bvec_t ready_bits[MU_BVEC_COUNT_TO_BYTE_COUNT(MU_TASK_PRIORITY_LEVELS)];
+  size_t ready_count;       // number of tasks in the ready lists
+#endif
+  mu_clock_fn clock_fn;     // function to call to get the current time
+  mu_task_t *idle_task;     // the idle task
+  mu_task_t default_idle_task; // idle task used when none has been set
+  mu_sched_sleep_fn sleep_fn; // called to sleep until the next task, or NULL
+  mu_sched_wake_fn wake_fn; // called at interrupt level on ISR posts, or NULL
+  mu_task_t *current_task;  // the task currently being processed
+  mu_mpsc_t irq_task_queue; // Tasks queued at interrupt level
+  mu_mpsc_cell_t irq_task_queue_store[MU_IRQ_TASK_QUEUE_SIZE];
+  mu_list_t mailboxes;      // mailboxes attached to this instance
+#if (MU_SCHED_STATISTICS)
+  mu_sched_stats_t stats;   // load counters (isr_high_water filled on read)
+  mu_time_t rate_start;     // start of the current tasks per second window
+  uint32_t rate_count;      // tasks run in the current window
+#endif
+} mu_sched_t;
+
+/**
+ * @brief A single producer / single consumer channel for posting tasks to a
+ * scheduler instance from another core (or another scheduler instance).
+ *
+ * Each posting core needs its own mailbox.  The receiving instance drains its
+ * mailboxes along with its ISR queue at each step.
+ */
+typedef struct {
+  mu_list_t link;           // links the mailboxes of one receiving instance
+  mu_spsc_t queue;          // tasks posted to the receiving instance
+  mu_sched_t *sched;        // the receiving instance
+} mu_sched_mailbox_t;
+
 // =============================================================================
 // declarations
 
@@ -147,6 +319,35 @@ void mu_sched_reset(void);
  */
 mu_sched_err_t mu_sched_step(void);
 
+/**
+ * @brief Process every runnable task, then the idle task.
+ *
+ * Unlike mu_sched_step(), this reads the clock and drains the interrupt queue
+ * only once, then runs every task whose time has arrived as of that moment.
+ * Once no runnable task remains, the idle task is called.  The batch is
+ * bounded by the number of tasks in the schedule when it starts, so a task
+ * that reschedules itself "now" will run at most a few times per batch.
+ *
+ * If the batch stops early because of max_tasks or budget, the idle task is
+ * not called.
+ *
+ * @param max_tasks The maximum number of tasks to run, or 0 for no limit.
+ * @param budget Stop the batch once this much time has elapsed since it
+ *        started, or 0 for no limit.  The clock is only re-read after each task
+ *        when a budget is given.
+ * @return The number of tasks that were run, not counting the idle task.
+ */
+int mu_sched_step_batch(int max_tasks, mu_duration_t budget);
+
+/**
+ * @brief Process every runnable task, then the idle task.
+ *
+ * Equivalent to mu_sched_step_batch(0, 0).
+ *
+ * @return The number of tasks that were run, not counting the idle task.
+ */
+int mu_sched_run_until_idle(void);
+
 /**
  * @brief Return the default idle task (which does nothing but return).
  */
@@ -162,6 +363,58 @@ mu_task_t *mu_sched_get_idle_task(void);
  */
 void mu_sched_set_idle_task(mu_task_t *task);
 
+/**
+ * @brief Set the function to call to sleep when no tasks are runnable.
+ *
+ * When set, the scheduler calls sleep_fn after the idle task with the time
+ * remaining until the next scheduled task (or "forever" if there are none), so
+ * the processor can sleep rather than spin on mu_sched_step().  Pass NULL to
+ * disable tickless operation.
+ */
+void mu_sched_set_sleep_fn(mu_sched_sleep_fn sleep_fn);
+
+/**
+ * @brief Set the function to call at interrupt level when a task is posted
+ * via mu_sched_isr_task_xxx(), e.g. to cancel a low-power timer.  Pass NULL to
+ * disable.
+ */
+void mu_sched_set_wake_fn(mu_sched_wake_fn wake_fn);
+
+/**
+ * @brief Return true if tasks posted from interrupt level are waiting to be
+ * transferred to the schedule.
+ */
+bool mu_sched_isr_tasks_pending(void);
+
+/**
+ * @brief Return the number of mu_sched_isr_task_xxx() calls that failed
+ * because the isr queue was full since the scheduler was last reset.
+ *
+ * A non-zero count means MU_IRQ_TASK_QUEUE_SIZE is too small for the
+ * interrupt load.
+ */
+uint32_t mu_sched_isr_overflow_count(void);
+
+/**
+ * @brief Return the largest number of tasks waiting in the isr queue at once
+ * since the scheduler was last reset.  Use this to size MU_IRQ_TASK_QUEUE_SIZE.
+ */
+uint16_t mu_sched_isr_high_water(void);
+
+#if (MU_SCHED_STATISTICS)
+
+/**
+ * @brief Copy the scheduler's load counters into stats.
+ */
+void mu_sched_get_stats(mu_sched_stats_t *stats);
+
+/**
+ * @brief Zero the scheduler's load counters and the isr queue high-water mark.
+ */
+void mu_sched_reset_stats(void);
+
+#endif
+
 /**
  * @brief Return the current clock souce.
  */
@@ -199,6 +452,15 @@ mu_task_t *mu_sched_get_current_task(void);
  */
 mu_task_t *mu_sched_get_next_task(void);
 
+/**
+ * @brief Get the time at which the next scheduled task will become runnable.
+ *
+ * @param deadline Receives the time of the next scheduled task.
+ * @return MU_SCHED_ERR_EMPTY if there are no scheduled tasks (deadline is left
+ *         unchanged), MU_SCHED_ERR_NONE otherwise.
+ */
+mu_sched_err_t mu_sched_get_next_deadline(mu_time_t *deadline);
+
 /**
  * @brief Remove a scheduled task.
  *
@@ -330,6 +592,15 @@ mu_sched_task_status_t mu_sched_get_task_status(mu_task_t *task);
  * Traversing the list continues until the end of the list is reached, or the
  * user function returns a non-null value.
  *
+ * Runnable tasks waiting at a priority level (see MU_TASK_PRIORITY_LEVELS) are
+ * visited first, highest priority first, followed by the time ordered
+ * schedule.  With the default list backend, tasks are therefore visited in the
+ * order in which they will run.  With MU_SCHED_USE_PHEAP, the time ordered
+ * schedule is visited in heap order, which is not sorted.
+ *
+ * The user function must not modify the schedule: use mu_sched_traverse_safe()
+ * for that.
+ *
  * @param user_fn The function to call with each element of the schedule.
  * @param arg The value supplies as the second argument to the user fun.
  * @return A non-null value returned by the user function, or NULL if the end of
@@ -337,6 +608,179 @@ mu_sched_task_status_t mu_sched_get_task_status(mu_task_t *task);
  */
 mu_task_t *mu_sched_traverse(mu_sched_traverse_fn user_fn, void *arg);
 
+/**
+ * @brief Like mu_sched_traverse(), but visits tasks in the opposite order.
+ *
+ * The user function must not modify the schedule.
+ */
+mu_task_t *mu_sched_traverse_reverse(mu_sched_traverse_fn user_fn, void *arg);
+
+/**
+ * @brief Like mu_sched_traverse(), but the user function may remove or
+ * reschedule the task it is given, or schedule tasks that are not yet in the
+ * schedule.  It must not remove or reschedule any other task.
+ *
+ * Each task that is in the schedule when the traversal starts is visited at
+ * most once, and tasks that the user function (re)schedules are not visited.
+ * No copy of the schedule is made.
+ */
+mu_task_t *mu_sched_traverse_safe(mu_sched_traverse_fn user_fn, void *arg);
+
+/**
+ * @brief Return the instance used by the mu_sched_xxx() functions.
+ *
+ * This is a private singleton unless mu_config.h defines MU_SCHED_DEFAULT().
+ */
+mu_sched_t *mu_sched_get_default(void);
+
+// =============================================================================
+// declarations: explicit scheduler instances
+//
+// Each of the following behaves exactly like the mu_sched_xxx() function of
+// the same name, but operates on the given scheduler instance.
+
+mu_sched_t *mu_sched_inst_init(mu_sched_t *sched);
+
+void mu_sched_inst_reset(mu_sched_t *sched);
+
+mu_sched_err_t mu_sched_inst_step(mu_sched_t *sched);
+
+int mu_sched_inst_step_batch(mu_sched_t *sched,
+                             int max_tasks,
+                             mu_duration_t budget);
+
+int mu_sched_inst_run_until_idle(mu_sched_t *sched);
+
+mu_task_t *mu_sched_inst_get_default_idle_task(mu_sched_t *sched);
+
+mu_task_t *mu_sched_inst_get_idle_task(mu_sched_t *sched);
+
+void mu_sched_inst_set_idle_task(mu_sched_t *sched, mu_task_t *task);
+
+void mu_sched_inst_set_sleep_fn(mu_sched_t *sched, mu_sched_sleep_fn sleep_fn);
+
+void mu_sched_inst_set_wake_fn(mu_sched_t *sched, mu_sched_wake_fn wake_fn);
+
+bool mu_sched_inst_isr_tasks_pending(mu_sched_t *sched);
+
+uint32_t mu_sched_inst_isr_overflow_count(mu_sched_t *sched);
+
+uint16_t mu_sched_inst_isr_high_water(mu_sched_t *sched);
+
+#if (MU_SCHED_STATISTICS)
+
+void mu_sched_inst_get_stats(mu_sched_t *sched, mu_sched_stats_t *stats);
+
+void mu_sched_inst_reset_stats(mu_sched_t *sched);
+
+#endif
+
+mu_clock_fn mu_sched_inst_get_clock_source(mu_sched_t *sched);
+
+void mu_sched_inst_set_clock_source(mu_sched_t *sched, mu_clock_fn clock_fn);
+
+mu_time_t mu_sched_inst_get_current_time(mu_sched_t *sched);
+
+int mu_sched_inst_task_count(mu_sched_t *sched);
+
+bool mu_sched_inst_is_empty(mu_sched_t *sched);
+
+mu_task_t *mu_sched_inst_get_current_task(mu_sched_t *sched);
+
+mu_task_t *mu_sched_inst_get_next_task(mu_sched_t *sched);
+
+mu_sched_err_t mu_sched_inst_get_next_deadline(mu_sched_t *sched,
+                                               mu_time_t *deadline);
+
+mu_task_t *mu_sched_inst_remove_task(mu_sched_t *sched, mu_task_t *task);
+
+mu_sched_err_t mu_sched_inst_task_now(mu_sched_t *sched, mu_task_t *task);
+
+mu_sched_err_t mu_sched_inst_task_at(mu_sched_t *sched,
+                                     mu_task_t *task,
+                                     mu_time_t at);
+
+mu_sched_err_t mu_sched_inst_task_in(mu_sched_t *sched,
+                                     mu_task_t *task,
+                                     mu_duration_t in);
+
+mu_sched_err_t mu_sched_inst_reschedule_now(mu_sched_t *sched);
+
+mu_sched_err_t mu_sched_inst_reschedule_in(mu_sched_t *sched,
+                                           mu_duration_t in);
+
+mu_sched_err_t mu_sched_inst_isr_task_now(mu_sched_t *sched, mu_task_t *task);
+
+mu_sched_err_t mu_sched_inst_isr_task_at(mu_sched_t *sched,
+                                         mu_task_t *task,
+                                         mu_time_t at);
+
+mu_sched_err_t mu_sched_inst_isr_task_in(mu_sched_t *sched,
+                                         mu_task_t *task,
+                                         mu_duration_t in);
+
+mu_sched_task_status_t mu_sched_inst_get_task_status(mu_sched_t *sched,
+                                                     mu_task_t *task);
+
+mu_task_t *mu_sched_inst_traverse(mu_sched_t *sched,
+                                  mu_sched_traverse_fn user_fn,
+                                  void *arg);
+
+mu_task_t *mu_sched_inst_traverse_reverse(mu_sched_t *sched,
+                                          mu_sched_traverse_fn user_fn,
+                                          void *arg);
+
+mu_task_t *mu_sched_inst_traverse_safe(mu_sched_t *sched,
+                                       mu_sched_traverse_fn user_fn,
+                                       void *arg);
+
+/**
+ * @brief Attach a mailbox to a scheduler instance.  Not interrupt safe: call
+ * on the receiving core before any other core posts to the mailbox.
+ *
+ * @param sched The receiving scheduler instance.
+ * @param mailbox The mailbox to attach.
+ * @param store Storage for the mailbox queue.
+ * @param capacity Number of elements in store.  Must be a power of two.
+ * @return MU_SCHED_ERR_SIZE if capacity is not a power of two,
+ *         MU_SCHED_ERR_NONE otherwise.
+ */
+mu_sched_err_t mu_sched_inst_attach_mailbox(mu_sched_t *sched,
+                                            mu_sched_mailbox_t *mailbox,
+                                            mu_spsc_item_t *store,
+                                            uint16_t capacity);
+
+// =============================================================================
+// declarations: cross-instance posting
+//
+// These may be called from the single core (or interrupt level) that owns the
+// producing side of the mailbox.  The task must not be scheduled in any other
+// instance, and is owned by the receiving instance once posted.
+
+/**
+ * @brief Post a task to run as soon as possible in the mailbox's instance.
+ *
+ * @return MU_SCHED_ERR_FULL if the mailbox is full, MU_SCHED_ERR_NONE
+ *         otherwise.
+ */
+mu_sched_err_t mu_sched_mailbox_post_now(mu_sched_mailbox_t *mailbox,
+                                         mu_task_t *task);
+
+/**
+ * @brief Post a task to run at the given time in the mailbox's instance.
+ */
+mu_sched_err_t mu_sched_mailbox_post_at(mu_sched_mailbox_t *mailbox,
+                                        mu_task_t *task,
+                                        mu_time_t at);
+
+/**
+ * @brief Post a task to run after the given interval in the mailbox's
+ * instance.
+ */
+mu_sched_err_t mu_sched_mailbox_post_in(mu_sched_mailbox_t *mailbox,
+                                        mu_task_t *task,
+                                        mu_duration_t in);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,208 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Typed, comparator-inlined sorting.
+ *
+ * mu_vect_sort() and mu_pstore_sort() work on any element type, which costs a
+ * call through a function pointer for every comparison.  MU_SORT_DEFINE()
+ * instead generates a sort function for one element type with the comparison
+ * written out in place, so the compiler can inline it:
+ *
+ *     typedef struct { uint32_t timestamp; int16_t value; } sample_t;
+ *     #define SAMPLE_LESS(a, b) ((a).timestamp < (b).timestamp)
+ *     MU_SORT_DEFINE(sort_samples, sample_t, SAMPLE_LESS)
+ *     ...
+ *     sort_samples(samples, n_samples);
+ *
+ * The less argument names a function-like macro (or function) taking two
+ * elements by value and returning true if the first sorts before the second.
+ * Elements are moved by assignment.
+ *
+ * All of the mulib sorts are introsorts tuned for data that arrives nearly in
+ * order: an already sorted input is detected in a single pass, partitions of
+ * up to MU_SORT_INSERTION_THRESHOLD elements are left to a final insertion
+ * sort pass (which is linear on nearly sorted data), and a quicksort that
+ * recurses too deeply falls back to heapsort, bounding the worst case at
+ * O(N log N).  Like heapsort before them, they are not stable.
+ *
+ * Sorts for the common integer key types are provided below.
+ */
+
+#ifndef _MU_SORT_H_
+#define _MU_SORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+// Partitions of this many elements or fewer are finished by insertion sort.
+#ifndef MU_SORT_INSERTION_THRESHOLD
+#define MU_SORT_INSERTION_THRESHOLD 16
+#endif
+
+/**
+ * @brief The ascending comparison used by the predefined sorts.
+ */
+#define MU_SORT_LESS(_a, _b) ((_a) < (_b))
+
+/**
+ * @brief Declare a sort function generated by MU_SORT_DEFINE().
+ */
+#define MU_SORT_DECLARE(_name, _type) void _name(_type *items, size_t count)
+
+/**
+ * @brief Define `void _name(_type *items, size_t count)`, sorting items into
+ * ascending order according to _less.
+ */
+#define MU_SORT_DEFINE(_name, _type, _less)                                    \
+  static void _name##_insertion(_type *items, size_t count) {                  \
+    for (size_t i = 1; i < count; i++) {                                       \
+      _type x = items[i];                                                      \
+      size_t j = i;                                                            \
+      while (j > 0 && _less(x, items[j - 1])) {                                \
+        items[j] = items[j - 1];                                               \
+        j--;                                                                   \
+      }                                                                        \
+      items[j] = x;                                                            \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static void _name##_sift_down(_type *items, size_t root, size_t count) {     \
+    _type x = items[root];                                                     \
+    size_t child;                                                              \
+    while ((child = root * 2 + 1) < count) {                                   \
+      if (child + 1 < count && _less(items[child], items[child + 1])) {        \
+        child += 1;                                                            \
+      }                                                                        \
+      if (!_less(x, items[child])) {                                           \
+        break;                                                                 \
+      }                                                                        \
+      items[root] = items[child];                                              \
+      root = child;                                                            \
+    }                                                                          \
+    items[root] = x;                                                           \
+  }                                                                            \
+                                                                               \
+  static void _name##_heapsort(_type *items, size_t count) {                   \
+    for (size_t start = count / 2; start-- > 0;) {                             \
+      _name##_sift_down(items, start, count);                                  \
+    }                                                                          \
+    while (count > 1) {                                                        \
+      _type x = items[--count];                                                \
+      items[count] = items[0];                                                 \
+      items[0] = x;                                                            \
+      _name##_sift_down(items, 0, count);                                      \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static void _name##_sort3(_type *a, _type *b, _type *c) {                    \
+    _type x;                                                                   \
+    if (_less(*b, *a)) {                                                       \
+      x = *a, *a = *b, *b = x;                                                 \
+    }                                                                          \
+    if (_less(*c, *b)) {                                                       \
+      x = *b, *b = *c, *c = x;                                                 \
+      if (_less(*b, *a)) {                                                     \
+        x = *a, *a = *b, *b = x;                                               \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static void _name##_quicksort(_type *items, size_t count, int depth) {       \
+    while (count > MU_SORT_INSERTION_THRESHOLD) {                              \
+      if (depth-- == 0) {                                                      \
+        _name##_heapsort(items, count);                                        \
+        return;                                                                \
+      }                                                                        \
+      /* median of three, which also places sentinels at both ends */          \
+      _name##_sort3(&items[0], &items[count / 2], &items[count - 1]);          \
+      _type pivot = items[count / 2];                                          \
+      size_t i = 0;                                                            \
+      size_t j = count - 1;                                                    \
+      for (;;) {                                                               \
+        do {                                                                   \
+          i++;                                                                 \
+        } while (_less(items[i], pivot));                                      \
+        do {                                                                   \
+          j--;                                                                 \
+        } while (_less(pivot, items[j]));                                      \
+        if (i >= j) {                                                          \
+          break;                                                               \
+        }                                                                      \
+        _type x = items[i];                                                    \
+        items[i] = items[j];                                                   \
+        items[j] = x;                                                          \
+      }                                                                        \
+      /* recurse into the smaller part, iterate on the larger */               \
+      if (i < count - i) {                                                     \
+        _name##_quicksort(items, i, depth);                                    \
+        items += i;                                                            \
+        count -= i;                                                            \
+      } else {                                                                 \
+        _name##_quicksort(&items[i], count - i, depth);                        \
+        count = i;                                                             \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void _name(_type *items, size_t count) {                                     \
+    size_t i = 1;                                                              \
+    int depth = 0;                                                             \
+    while (i < count && !_less(items[i], items[i - 1])) {                      \
+      i++;                                                                     \
+    }                                                                          \
+    if (i >= count) {                                                          \
+      return; /* already sorted */                                             \
+    }                                                                          \
+    for (size_t n = count; n > 1; n >>= 1) {                                   \
+      depth += 2;                                                              \
+    }                                                                          \
+    _name##_quicksort(items, count, depth);                                    \
+    _name##_insertion(items, count);                                           \
+  }
+
+// =============================================================================
+// declarations
+
+MU_SORT_DECLARE(mu_sort_int16, int16_t);
+MU_SORT_DECLARE(mu_sort_uint16, uint16_t);
+MU_SORT_DECLARE(mu_sort_int32, int32_t);
+MU_SORT_DECLARE(mu_sort_uint32, uint32_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _MU_SORT_H_ */
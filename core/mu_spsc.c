@@ -26,6 +26,7 @@
 // includes
 
 #include "mulib.h"
+#include "mu_atomic.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -38,6 +39,18 @@
 
 #define IS_POWER_OF_TWO(n) (((n) & ((n)-1)) == 0)
 
+/**
+ * @brief Return the number of free slots as seen by the producer, refreshing
+ * the producer's view of head only if it shows fewer than wanted.
+ */
+static uint16_t put_available(mu_spsc_t *q, uint16_t tail, uint16_t wanted);
+
+/**
+ * @brief Return the number of filled slots as seen by the consumer, refreshing
+ * the consumer's view of tail only if it shows fewer than wanted.
+ */
+static uint16_t get_available(mu_spsc_t *q, uint16_t head, uint16_t wanted);
+
 // =============================================================================
 // local storage
 
@@ -57,21 +70,34 @@ mu_spsc_err_t mu_spsc_init(mu_spsc_t *q, mu_spsc_item_t *store,
 mu_spsc_err_t mu_spsc_reset(mu_spsc_t *q) {
   q->head = 0;
   q->tail = 0;
+#if (MU_SPSC_MULTICORE)
+  q->head_cache = 0;
+  q->tail_cache = 0;
+#endif
   return MU_SPSC_ERR_NONE;
 }
 
+uint16_t mu_spsc_capacity(mu_spsc_t *q) { return q->mask; }
+
+bool mu_spsc_is_empty(mu_spsc_t *q) {
+  // Load both indices rather than going through get_available(): the cached
+  // copies belong to the producer and consumer, and this may be called by
+  // either.
+  return mu_atomic_load_u16(&q->tail) == mu_atomic_load_u16(&q->head);
+}
+
 /**
  * @brief To be called by Producer only: update tail only after setting item.
  */
 mu_spsc_err_t mu_spsc_put(mu_spsc_t *q, mu_spsc_item_t item) {
   mu_spsc_err_t err = MU_SPSC_ERR_NONE;
-  uint16_t next_tail = (q->tail + 1) & q->mask;
+  uint16_t tail = q->tail;
 
-  if (next_tail == q->head) {
+  if (put_available(q, tail, 1) == 0) {
     err = MU_SPSC_ERR_FULL;
   } else {
-    q->store[q->tail] = item;
-    q->tail = next_tail;
+    q->store[tail] = item;
+    mu_atomic_store_u16(&q->tail, (tail + 1) & q->mask);
   }
 
   return err;
@@ -82,16 +108,121 @@ mu_spsc_err_t mu_spsc_put(mu_spsc_t *q, mu_spsc_item_t item) {
  */
 mu_spsc_err_t mu_spsc_get(mu_spsc_t *q, mu_spsc_item_t *item) {
   mu_spsc_err_t err = MU_SPSC_ERR_NONE;
+  uint16_t head = q->head;
 
-  if (q->head == q->tail) {
+  if (get_available(q, head, 1) == 0) {
     err = MU_SPSC_ERR_EMPTY;
   } else {
-    *item = q->store[q->head];
-    q->head = (q->head + 1) & q->mask;
+    *item = q->store[head];
+    mu_atomic_store_u16(&q->head, (head + 1) & q->mask);
   }
 
   return err;
 }
 
+uint16_t mu_spsc_put_n(mu_spsc_t *q,
+                       const mu_spsc_item_t *items,
+                       uint16_t count) {
+  uint16_t tail = q->tail;
+  uint16_t available = put_available(q, tail, count);
+
+  if (count > available) {
+    count = available;
+  }
+  for (uint16_t i = 0; i < count; i++) {
+    q->store[(tail + i) & q->mask] = items[i];
+  }
+  mu_atomic_store_u16(&q->tail, (tail + count) & q->mask);
+  return count;
+}
+
+uint16_t mu_spsc_get_n(mu_spsc_t *q, mu_spsc_item_t *items, uint16_t count) {
+  uint16_t head = q->head;
+  uint16_t available = get_available(q, head, count);
+
+  if (count > available) {
+    count = available;
+  }
+  for (uint16_t i = 0; i < count; i++) {
+    items[i] = q->store[(head + i) & q->mask];
+  }
+  mu_atomic_store_u16(&q->head, (head + count) & q->mask);
+  return count;
+}
+
+void mu_spsc_put_reserve(mu_spsc_t *q, mu_spsc_item_t **ptr, uint16_t *len) {
+  uint16_t tail = q->tail;
+  uint16_t available = put_available(q, tail, 1);
+  uint16_t contiguous = q->mask + 1 - tail;
+
+  *ptr = &q->store[tail];
+  *len = (available < contiguous) ? available : contiguous;
+}
+
+void mu_spsc_put_commit(mu_spsc_t *q, uint16_t n) {
+  uint16_t tail = q->tail;
+  uint16_t available = put_available(q, tail, n);
+
+  if (n > available) {
+    n = available;
+  }
+  mu_atomic_store_u16(&q->tail, (tail + n) & q->mask);
+}
+
+void mu_spsc_get_peek(mu_spsc_t *q, mu_spsc_item_t **ptr, uint16_t *len) {
+  uint16_t head = q->head;
+  uint16_t available = get_available(q, head, 1);
+  uint16_t contiguous = q->mask + 1 - head;
+
+  *ptr = &q->store[head];
+  *len = (available < contiguous) ? available : contiguous;
+}
+
+void mu_spsc_get_release(mu_spsc_t *q, uint16_t n) {
+  uint16_t head = q->head;
+  uint16_t available = get_available(q, head, n);
+
+  if (n > available) {
+    n = available;
+  }
+  mu_atomic_store_u16(&q->head, (head + n) & q->mask);
+}
+
 // =============================================================================
 // private code
+
+#if (MU_SPSC_MULTICORE)
+
+static uint16_t put_available(mu_spsc_t *q, uint16_t tail, uint16_t wanted) {
+  uint16_t available = (q->head_cache - tail - 1) & q->mask;
+
+  if (available < wanted) {
+    q->head_cache = mu_atomic_load_u16(&q->head);
+    available = (q->head_cache - tail - 1) & q->mask;
+  }
+  return available;
+}
+
+static uint16_t get_available(mu_spsc_t *q, uint16_t head, uint16_t wanted) {
+  uint16_t available = (q->tail_cache - head) & q->mask;
+
+  if (available < wanted) {
+    q->tail_cache = mu_atomic_load_u16(&q->tail);
+    available = (q->tail_cache - head) & q->mask;
+  }
+  return available;
+}
+
+#else
+
+static uint16_t put_available(mu_spsc_t *q, uint16_t tail, uint16_t wanted) {
+  (void)wanted;
+  return (mu_atomic_load_u16(&q->head) - tail - 1) & q->mask;
+}
+
+static uint16_t get_available(mu_spsc_t *q, uint16_t head, uint16_t wanted) {
+  (void)wanted;
+  return (mu_atomic_load_u16(&q->tail) - head) & q->mask;
+}
+
+#endif
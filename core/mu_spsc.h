@@ -26,7 +26,19 @@
  * @brief Implementation of a lock-free Single Producer / Single Consumer queue.
  *
  * spsc stores pointer sized objects in a queue.  In mulib, the scheduler uses
- * an instance of spsc to mediate between interrupt and foreground levels.
+ * instances of spsc to pass tasks between scheduler instances.
+ *
+ * The producer publishes tail with release semantics after writing an item,
+ * and the consumer publishes head with release semantics after reading one
+ * (see mu_atomic.h), so the queue is safe between an interrupt and the
+ * foreground as well as between cores.
+ *
+ * On multicore targets, define MU_SPSC_MULTICORE as 1 to place head and tail
+ * on separate cache lines (of MU_SPSC_CACHE_LINE_SIZE bytes) and to have each
+ * side keep a private copy of the other side's index, re-reading the shared
+ * index only when the copy says the queue is full (or empty).  This avoids
+ * false sharing and most cross-core cache traffic at the cost of a larger
+ * mu_spsc_t.
  */
 
 #ifndef _MU_SPSC_H_
@@ -45,6 +57,14 @@ extern "C" {
 // =============================================================================
 // types and definitions
 
+#ifndef MU_SPSC_MULTICORE
+#define MU_SPSC_MULTICORE 0
+#endif
+
+#ifndef MU_SPSC_CACHE_LINE_SIZE
+#define MU_SPSC_CACHE_LINE_SIZE 64
+#endif
+
 typedef enum {
   MU_SPSC_ERR_NONE,
   MU_SPSC_ERR_EMPTY,
@@ -55,6 +75,22 @@ typedef enum {
 // mu_spsc manages pointer-sized objects
 typedef void * mu_spsc_item_t;
 
+#if (MU_SPSC_MULTICORE)
+
+typedef struct {
+  uint16_t mask;          // read-only after init
+  mu_spsc_item_t *store;  // read-only after init
+  uint8_t _pad0[MU_SPSC_CACHE_LINE_SIZE];
+  volatile uint16_t head; // written by the consumer
+  uint16_t tail_cache;    // consumer's copy of tail
+  uint8_t _pad1[MU_SPSC_CACHE_LINE_SIZE];
+  volatile uint16_t tail; // written by the producer
+  uint16_t head_cache;    // producer's copy of head
+  uint8_t _pad2[MU_SPSC_CACHE_LINE_SIZE];
+} mu_spsc_t;
+
+#else
+
 typedef struct {
   uint16_t mask;
   volatile uint16_t head;
@@ -62,6 +98,8 @@ typedef struct {
   mu_spsc_item_t *store;
 } mu_spsc_t;
 
+#endif
+
 // =============================================================================
 // declarations
 
@@ -82,6 +120,13 @@ mu_spsc_err_t mu_spsc_reset(mu_spsc_t *q);
  */
 uint16_t mu_spsc_capacity(mu_spsc_t *q);
 
+/**
+ * @brief Return true if the queue is empty.  May be called by the producer or
+ * the consumer, and has no side effects on either.  Exact when called by the
+ * consumer; advisory otherwise.
+ */
+bool mu_spsc_is_empty(mu_spsc_t *q);
+
 /**
  * @brief Insert an item at the tail of the queue.  May only be called by the
  * producer (interrupt level).
@@ -94,6 +139,54 @@ mu_spsc_err_t mu_spsc_put(mu_spsc_t *q, mu_spsc_item_t item);
  */
 mu_spsc_err_t mu_spsc_get(mu_spsc_t *q, mu_spsc_item_t *item);
 
+/**
+ * @brief Insert up to count items at the tail of the queue, publishing tail
+ * once for the whole run.  May only be called by the producer.
+ *
+ * @return The number of items inserted, which is less than count if the queue
+ *         filled.
+ */
+uint16_t mu_spsc_put_n(mu_spsc_t *q,
+                       const mu_spsc_item_t *items,
+                       uint16_t count);
+
+/**
+ * @brief Remove up to count items from the head of the queue, publishing head
+ * once for the whole run.  May only be called by the consumer.
+ *
+ * @return The number of items removed, which is less than count if the queue
+ *         emptied.
+ */
+uint16_t mu_spsc_get_n(mu_spsc_t *q, mu_spsc_item_t *items, uint16_t count);
+
+/**
+ * @brief Expose the contiguous free slots at the tail of the queue so the
+ * producer can fill them in place.  *len may be less than the total free space
+ * when the free region wraps; commit and reserve again for the remainder.  May
+ * only be called by the producer.
+ */
+void mu_spsc_put_reserve(mu_spsc_t *q, mu_spsc_item_t **ptr, uint16_t *len);
+
+/**
+ * @brief Publish n items written into slots from mu_spsc_put_reserve().  n is
+ * clamped to the free space.  May only be called by the producer.
+ */
+void mu_spsc_put_commit(mu_spsc_t *q, uint16_t n);
+
+/**
+ * @brief Expose the contiguous filled slots at the head of the queue so the
+ * consumer can read them in place.  *len may be less than the number of items
+ * when the filled region wraps.  May only be called by the consumer.
+ */
+void mu_spsc_get_peek(mu_spsc_t *q, mu_spsc_item_t **ptr, uint16_t *len);
+
+/**
+ * @brief Release n items read from slots from mu_spsc_get_peek().  n is
+ * clamped to the number of items in the queue.  May only be called by the
+ * consumer.
+ */
+void mu_spsc_get_release(mu_spsc_t *q, uint16_t n);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,19 +35,116 @@
 #include <stdio.h>
 #include <string.h>
 
+#if (MU_STR_FORMAT_FLOAT)
+#include <math.h> // signbit
+#endif
+
 // =============================================================================
 // local types and definitions
 
+// Enough digits for a uintmax_t in octal, the most verbose supported radix.
+#define FORMAT_DIGITS_MAX ((sizeof(uintmax_t) * 8 + 2) / 3)
+
+// %f renders at most this many fraction digits (10^9 fits in a uint32_t).
+#define FORMAT_FLOAT_MAX_PRECISION 9
+
+typedef enum {
+  FORMAT_LENGTH_NONE,
+  FORMAT_LENGTH_HH,
+  FORMAT_LENGTH_H,
+  FORMAT_LENGTH_L,
+  FORMAT_LENGTH_LL,
+  FORMAT_LENGTH_J,
+  FORMAT_LENGTH_Z,
+  FORMAT_LENGTH_T,
+  FORMAT_LENGTH_LONG_DOUBLE,
+} format_length_t;
+
+typedef struct {
+  bool left;                // '-' flag: left justify within the width
+  bool zero;                // '0' flag: pad with zeros instead of spaces
+  bool alt;                 // '#' flag: alternate form
+  char sign;                // '+' or ' ' flag, or 0 if neither
+  int width;                // minimum field width
+  int precision;            // precision, or -1 if not given
+  format_length_t length;   // length modifier
+} format_spec_t;
+
 // =============================================================================
 // local (forward) declarations
 
 static size_t str_capacity(const mu_str_t *str);
 
-static uint8_t str_append(mu_str_t *dst, const uint8_t *src, int count);
+static size_t str_append(mu_str_t *dst, const uint8_t *src, size_t count);
+
+/**
+ * @brief Return a pointer to the first occurrence of byte in the n bytes at p,
+ * or NULL if there is none.
+ */
+static const uint8_t *str_find_byte(const uint8_t *p, size_t n, uint8_t byte);
+
+/**
+ * @brief Parse the flags, width, precision and length modifier that follow a
+ * '%', consuming any '*' arguments.  Returns a pointer to the conversion
+ * character.
+ */
+static const char *format_parse_spec(const char *p,
+                                     format_spec_t *spec,
+                                     va_list *ap);
+
+static intmax_t format_signed_arg(format_length_t length, va_list *ap);
+
+static uintmax_t format_unsigned_arg(format_length_t length, va_list *ap);
+
+/**
+ * @brief Write prefix, zeros and body, padded out to the spec's width.
+ */
+static void format_field(mu_str_t *dst,
+                         const format_spec_t *spec,
+                         bool zero_fill,
+                         const char *prefix,
+                         size_t prefix_len,
+                         size_t zeros,
+                         const char *body,
+                         size_t body_len);
+
+static void format_integer(mu_str_t *dst,
+                           const format_spec_t *spec,
+                           uintmax_t magnitude,
+                           bool negative,
+                           unsigned int base,
+                           bool upper,
+                           const char *radix);
+
+#if (MU_STR_FORMAT_FLOAT)
+static void format_float(mu_str_t *dst,
+                         const format_spec_t *spec,
+                         double value);
+
+static double product_error(double a, double b, double product);
+
+static double split_double(double a, double *lo);
+#endif
+
+static void format_repeat(mu_str_t *dst, char ch, size_t count);
 
 // =============================================================================
 // local storage
 
+// "00" through "99": lets mu_str_append_uint() emit two digits per division.
+static const char s_digit_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint32_t s_powers_of_ten[] = {
+    10u,      100u,      1000u,      10000u,      100000u,
+    1000000u, 10000000u, 100000000u, 1000000000u};
+
+static const char s_hex_digits[16] = "0123456789abcdef";
+
 // =============================================================================
 // public code
 
@@ -115,6 +212,57 @@ mu_str_t *mu_str_slice(mu_str_t *dst, const mu_str_t *src, int start, int end) {
   return dst;
 }
 
+int mu_str_find_byte(const mu_str_t *str, uint8_t byte) {
+  const uint8_t *p = mu_str_read_ref(str);
+  const uint8_t *found = str_find_byte(p, mu_str_read_available(str), byte);
+
+  return (found == NULL) ? MU_STR_NOT_FOUND : found - p;
+}
+
+int mu_str_find_substr(const mu_str_t *str, const mu_str_t *substr) {
+  const uint8_t *p = mu_str_read_ref(str);
+  const uint8_t *needle = mu_str_read_ref(substr);
+  size_t needle_len = mu_str_read_available(substr);
+  const uint8_t *q = p;
+  size_t remaining = mu_str_read_available(str);
+
+  if (needle_len == 0) {
+    return 0;
+  }
+  // Skip to each occurrence of the first byte, then compare the rest.
+  while (remaining >= needle_len) {
+    const uint8_t *candidate =
+        str_find_byte(q, remaining - needle_len + 1, needle[0]);
+    if (candidate == NULL) {
+      break;
+    }
+    if (memcmp(candidate + 1, needle + 1, needle_len - 1) == 0) {
+      return candidate - p;
+    }
+    remaining -= candidate + 1 - q;
+    q = candidate + 1;
+  }
+  return MU_STR_NOT_FOUND;
+}
+
+bool mu_str_split_next(mu_str_t *str, uint8_t delim, mu_str_t *token) {
+  size_t len = mu_str_read_available(str);
+  int index;
+
+  if (len == 0) {
+    return false;
+  }
+  index = mu_str_find_byte(str, delim);
+  if (index == MU_STR_NOT_FOUND) {
+    mu_str_copy(token, str);
+    str->s = str->e;
+  } else {
+    mu_str_slice(token, str, 0, index);
+    str->s += index + 1;
+  }
+  return true;
+}
+
 size_t mu_str_read_available(const mu_str_t *str) { return str->e - str->s; }
 
 size_t mu_str_write_available(const mu_str_t *str) {
@@ -122,23 +270,24 @@ size_t mu_str_write_available(const mu_str_t *str) {
 }
 
 size_t mu_str_read_increment(mu_str_t *str, size_t n_bytes) {
-  size_t s1 = str->s;
+  size_t available = mu_str_read_available(str);
 
-  str->s += n_bytes;
-  if (str->s > str->e) {
-    str->s = str->e;
+  // Clamp before adding so that a huge n_bytes cannot wrap the index.
+  if (n_bytes > available) {
+    n_bytes = available;
   }
-  return str->s = s1; // return amount by which s incremented
+  str->s += n_bytes;
+  return n_bytes; // return amount by which s incremented
 }
 
 size_t mu_str_write_increment(mu_str_t *str, size_t n_bytes) {
-  size_t e1 = str->e;
+  size_t available = mu_str_write_available(str);
 
-  str->e += n_bytes;
-  if (str->e > str_capacity(str)) {
-    str->e = str_capacity(str);
+  if (n_bytes > available) {
+    n_bytes = available;
   }
-  return str->e - e1; // return amount by which e incremented
+  str->e += n_bytes;
+  return n_bytes; // return amount by which e incremented
 }
 
 const uint8_t *mu_str_read_ref(const mu_str_t *str) {
@@ -158,6 +307,22 @@ bool mu_str_read_byte(mu_str_t *str, uint8_t *byte) {
   return true;
 }
 
+bool mu_str_read_bytes(mu_str_t *str, void *dst, size_t n_bytes) {
+  if (!mu_str_peek_bytes(str, dst, n_bytes)) {
+    return false;
+  }
+  str->s += n_bytes;
+  return true;
+}
+
+bool mu_str_peek_bytes(const mu_str_t *str, void *dst, size_t n_bytes) {
+  if (mu_str_read_available(str) < n_bytes) {
+    return false;
+  }
+  memcpy(dst, mu_str_read_ref(str), n_bytes);
+  return true;
+}
+
 bool mu_str_write_byte(mu_str_t *str, uint8_t byte) {
   if (mu_str_write_available(str) == 0) {
     return false;
@@ -175,7 +340,133 @@ size_t mu_str_append_cstr(mu_str_t *dst, const char *cstr) {
   return str_append(dst, (const uint8_t *)cstr, strlen(cstr));
 }
 
+size_t mu_str_parse_int(mu_str_t *str, int32_t *value) {
+  const uint8_t *p = mu_str_read_ref(str);
+  const uint8_t *end = p + mu_str_read_available(str);
+  const uint8_t *q = p;
+  const uint8_t *digits;
+  bool negative = false;
+  uint32_t limit;
+  uint32_t acc = 0;
+
+  if (q < end && (*q == '-' || *q == '+')) {
+    negative = (*q == '-');
+    q++;
+  }
+  limit = negative ? (uint32_t)INT32_MAX + 1 : (uint32_t)INT32_MAX;
+  digits = q;
+  while (q < end) {
+    uint32_t d = (uint32_t)(*q - '0'); // non-digits wrap to large values
+    if (d > 9) {
+      break;
+    }
+    if (acc > (limit - d) / 10) {
+      return 0; // overflow
+    }
+    acc = acc * 10 + d;
+    q++;
+  }
+  if (q == digits) {
+    return 0;
+  }
+  *value = negative ? -(int32_t)(acc - 1) - 1 : (int32_t)acc;
+  str->s += q - p;
+  return q - p;
+}
+
+size_t mu_str_parse_hex(mu_str_t *str, uint32_t *value) {
+  const uint8_t *p = mu_str_read_ref(str);
+  const uint8_t *end = p + mu_str_read_available(str);
+  const uint8_t *q = p;
+  uint32_t acc = 0;
+
+  while (q < end) {
+    uint32_t d = (uint32_t)(*q - '0');
+    if (d > 9) {
+      d = (uint32_t)((*q | 0x20) - 'a'); // fold to lower case
+      if (d > 5) {
+        break;
+      }
+      d += 10;
+    }
+    if (acc > (UINT32_MAX >> 4)) {
+      return 0; // overflow
+    }
+    acc = (acc << 4) | d;
+    q++;
+  }
+  if (q == p) {
+    return 0;
+  }
+  *value = acc;
+  str->s += q - p;
+  return q - p;
+}
+
+size_t mu_str_append_uint(mu_str_t *dst, uint32_t value) {
+  size_t n_digits = 1;
+  uint8_t *d;
+
+  while (n_digits <= sizeof(s_powers_of_ten) / sizeof(s_powers_of_ten[0]) &&
+         value >= s_powers_of_ten[n_digits - 1]) {
+    n_digits++;
+  }
+  if (mu_str_write_available(dst) < n_digits) {
+    return 0;
+  }
+  // Write backwards from the last digit, two digits at a time.
+  d = mu_str_write_ref(dst) + n_digits;
+  while (value >= 100) {
+    const char *pair = &s_digit_pairs[(value % 100) * 2];
+    value /= 100;
+    *--d = pair[1];
+    *--d = pair[0];
+  }
+  if (value >= 10) {
+    *--d = s_digit_pairs[value * 2 + 1];
+    *--d = s_digit_pairs[value * 2];
+  } else {
+    *--d = '0' + value;
+  }
+  dst->e += n_digits;
+  return n_digits;
+}
+
+size_t mu_str_append_hex(mu_str_t *dst, uint32_t value, uint8_t min_digits) {
+  size_t n_digits = 1;
+  uint8_t *d;
+
+  while (n_digits < 8 && (value >> (4 * n_digits)) != 0) {
+    n_digits++;
+  }
+  if (min_digits > 8) {
+    min_digits = 8;
+  }
+  if (n_digits < min_digits) {
+    n_digits = min_digits;
+  }
+  if (mu_str_write_available(dst) < n_digits) {
+    return 0;
+  }
+  d = mu_str_write_ref(dst) + n_digits;
+  for (size_t i = 0; i < n_digits; i++) {
+    *--d = s_hex_digits[value & 0x0f];
+    value >>= 4;
+  }
+  dst->e += n_digits;
+  return n_digits;
+}
+
 size_t mu_str_printf(mu_str_t *dst, const char *fmt, ...) {
+#if (MU_STR_PRINTF_USE_FORMAT)
+  size_t written;
+  va_list ap;
+
+  va_start(ap, fmt);
+  written = mu_str_vformat(dst, fmt, ap);
+  va_end(ap);
+  return written;
+#else
   size_t avail = mu_str_write_available(dst);
   size_t written = 0;
 
@@ -192,6 +483,147 @@ size_t mu_str_printf(mu_str_t *dst, const char *fmt, ...) {
     mu_str_write_increment(dst, written);
   }
   return written;
+#endif
+}
+
+size_t mu_str_format(mu_str_t *dst, const char *fmt, ...) {
+  size_t written;
+  va_list ap;
+
+  va_start(ap, fmt);
+  written = mu_str_vformat(dst, fmt, ap);
+  va_end(ap);
+  return written;
+}
+
+size_t mu_str_vformat(mu_str_t *dst, const char *fmt, va_list ap) {
+  size_t start = dst->e;
+  const char *p = fmt;
+  va_list args;
+
+  // Work on a copy so the helpers can consume arguments through a pointer.
+  va_copy(args, ap);
+
+  while (*p != '\0' && mu_str_write_available(dst) > 0) {
+    const char *pct = strchr(p, '%');
+    if (pct == NULL) {
+      str_append(dst, (const uint8_t *)p, strlen(p));
+      break;
+    }
+    if (pct != p) {
+      str_append(dst, (const uint8_t *)p, pct - p);
+    }
+
+    format_spec_t spec;
+    p = format_parse_spec(pct + 1, &spec, &args);
+    char conversion = *p;
+    if (conversion == '\0') {
+      break; // truncated specification
+    }
+    p++;
+
+    switch (conversion) {
+    case 'd':
+    case 'i': {
+      intmax_t value = format_signed_arg(spec.length, &args);
+      uintmax_t magnitude = (value < 0) ? -(uintmax_t)value : (uintmax_t)value;
+      format_integer(dst, &spec, magnitude, value < 0, 10, false, "");
+    } break;
+    case 'u':
+      spec.sign = 0; // '+' and ' ' apply to signed conversions only
+      format_integer(dst, &spec, format_unsigned_arg(spec.length, &args),
+                     false, 10, false, "");
+      break;
+    case 'x':
+    case 'X': {
+      uintmax_t value = format_unsigned_arg(spec.length, &args);
+      const char *radix = "";
+      spec.sign = 0;
+      if (spec.alt && value != 0) {
+        radix = (conversion == 'x') ? "0x" : "0X";
+      }
+      format_integer(dst, &spec, value, false, 16, conversion == 'X', radix);
+    } break;
+    case 'o': {
+      uintmax_t value = format_unsigned_arg(spec.length, &args);
+      const char *radix = "";
+      spec.sign = 0;
+      if (spec.alt) {
+        // '#' only guarantees a leading zero: skip it if the precision
+        // already zero-pads the digits.
+        int n_digits = 0;
+        for (uintmax_t v = value; v != 0; v >>= 3) {
+          n_digits++;
+        }
+        if ((value == 0) ? (spec.precision == 0)
+                         : (spec.precision <= n_digits)) {
+          radix = "0";
+        }
+      }
+      format_integer(dst, &spec, value, false, 8, false, radix);
+    } break;
+    case 'p':
+      spec.sign = 0;
+      format_integer(dst, &spec, (uintptr_t)va_arg(args, void *), false, 16,
+                     false, "0x");
+      break;
+    case 'c': {
+      char ch = (char)va_arg(args, int);
+      format_field(dst, &spec, false, "", 0, 0, &ch, 1);
+    } break;
+    case 's': {
+      const char *str = va_arg(args, const char *);
+      size_t len = 0;
+      if (str == NULL) {
+        str = "(null)";
+      }
+      // Don't read past the precision: the string need not be terminated.
+      while ((spec.precision < 0 || len < (size_t)spec.precision) &&
+             str[len] != '\0') {
+        len++;
+      }
+      format_field(dst, &spec, false, "", 0, 0, str, len);
+    } break;
+#if (MU_STR_FORMAT_FLOAT)
+    case 'f':
+    case 'F':
+      if (spec.length == FORMAT_LENGTH_LONG_DOUBLE) {
+        format_float(dst, &spec, (double)va_arg(args, long double));
+      } else {
+        format_float(dst, &spec, va_arg(args, double));
+      }
+      break;
+#else
+    case 'f':
+    case 'F':
+#endif
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      // Unsupported floating point conversion: consume the argument so the
+      // ones that follow stay in step, then copy the specification verbatim.
+      if (spec.length == FORMAT_LENGTH_LONG_DOUBLE) {
+        (void)va_arg(args, long double);
+      } else {
+        (void)va_arg(args, double);
+      }
+      str_append(dst, (const uint8_t *)pct, p - pct);
+      break;
+    case '%':
+      mu_str_write_byte(dst, '%');
+      break;
+    default:
+      // Unsupported conversion: copy the specification verbatim.
+      str_append(dst, (const uint8_t *)pct, p - pct);
+      break;
+    }
+  }
+
+  va_end(args);
+  return dst->e - start;
 }
 
 size_t mu_str_to_cstr(const mu_str_t *src, char *cstr, size_t len) {
@@ -212,7 +644,7 @@ static size_t str_capacity(const mu_str_t *str) {
   return mu_strbuf_capacity(str->buf);
 }
 
-static uint8_t str_append(mu_str_t *dst, const uint8_t *src, int count) {
+static size_t str_append(mu_str_t *dst, const uint8_t *src, size_t count) {
   size_t available = mu_str_write_available(dst);
   if (count > available) {
     count = available;
@@ -221,3 +653,366 @@ static uint8_t str_append(mu_str_t *dst, const uint8_t *src, int count) {
   mu_str_write_increment(dst, count);
   return count;
 }
+
+static const char *format_parse_spec(const char *p,
+                                     format_spec_t *spec,
+                                     va_list *ap) {
+  spec->left = false;
+  spec->zero = false;
+  spec->alt = false;
+  spec->sign = 0;
+  spec->width = 0;
+  spec->precision = -1;
+  spec->length = FORMAT_LENGTH_NONE;
+
+  for (;; p++) {
+    if (*p == '-') {
+      spec->left = true;
+    } else if (*p == '0') {
+      spec->zero = true;
+    } else if (*p == '#') {
+      spec->alt = true;
+    } else if (*p == '+') {
+      spec->sign = '+';
+    } else if (*p == ' ') {
+      if (spec->sign == 0) {
+        spec->sign = ' '; // '+' takes priority over ' '
+      }
+    } else {
+      break;
+    }
+  }
+
+  if (*p == '*') {
+    spec->width = va_arg(*ap, int);
+    if (spec->width < 0) {
+      // a negative '*' width is a '-' flag followed by a positive width
+      spec->left = true;
+      spec->width = -spec->width;
+    }
+    p++;
+  } else {
+    while (*p >= '0' && *p <= '9') {
+      spec->width = spec->width * 10 + (*p++ - '0');
+    }
+  }
+
+  if (*p == '.') {
+    p++;
+    spec->precision = 0;
+    if (*p == '*') {
+      spec->precision = va_arg(*ap, int);
+      if (spec->precision < 0) {
+        spec->precision = -1; // taken as if omitted
+      }
+      p++;
+    } else {
+      while (*p >= '0' && *p <= '9') {
+        spec->precision = spec->precision * 10 + (*p++ - '0');
+      }
+    }
+  }
+
+  switch (*p) {
+  case 'h':
+    p++;
+    if (*p == 'h') {
+      p++;
+      spec->length = FORMAT_LENGTH_HH;
+    } else {
+      spec->length = FORMAT_LENGTH_H;
+    }
+    break;
+  case 'l':
+    p++;
+    if (*p == 'l') {
+      p++;
+      spec->length = FORMAT_LENGTH_LL;
+    } else {
+      spec->length = FORMAT_LENGTH_L;
+    }
+    break;
+  case 'j':
+    p++;
+    spec->length = FORMAT_LENGTH_J;
+    break;
+  case 'z':
+    p++;
+    spec->length = FORMAT_LENGTH_Z;
+    break;
+  case 't':
+    p++;
+    spec->length = FORMAT_LENGTH_T;
+    break;
+  case 'L':
+    p++;
+    spec->length = FORMAT_LENGTH_LONG_DOUBLE;
+    break;
+  default:
+    break;
+  }
+  return p;
+}
+
+static intmax_t format_signed_arg(format_length_t length, va_list *ap) {
+  switch (length) {
+  case FORMAT_LENGTH_HH:
+    return (signed char)va_arg(*ap, int);
+  case FORMAT_LENGTH_H:
+    return (short)va_arg(*ap, int);
+  case FORMAT_LENGTH_L:
+    return va_arg(*ap, long);
+  case FORMAT_LENGTH_LL:
+    return va_arg(*ap, long long);
+  case FORMAT_LENGTH_J:
+    return va_arg(*ap, intmax_t);
+  case FORMAT_LENGTH_Z:
+    return (intmax_t)va_arg(*ap, size_t);
+  case FORMAT_LENGTH_T:
+    return va_arg(*ap, ptrdiff_t);
+  default:
+    return va_arg(*ap, int);
+  }
+}
+
+static uintmax_t format_unsigned_arg(format_length_t length, va_list *ap) {
+  switch (length) {
+  case FORMAT_LENGTH_HH:
+    return (unsigned char)va_arg(*ap, unsigned int);
+  case FORMAT_LENGTH_H:
+    return (unsigned short)va_arg(*ap, unsigned int);
+  case FORMAT_LENGTH_L:
+    return va_arg(*ap, unsigned long);
+  case FORMAT_LENGTH_LL:
+    return va_arg(*ap, unsigned long long);
+  case FORMAT_LENGTH_J:
+    return va_arg(*ap, uintmax_t);
+  case FORMAT_LENGTH_Z:
+    return va_arg(*ap, size_t);
+  case FORMAT_LENGTH_T:
+    return (uintmax_t)va_arg(*ap, ptrdiff_t);
+  default:
+    return va_arg(*ap, unsigned int);
+  }
+}
+
+static void format_field(mu_str_t *dst,
+                         const format_spec_t *spec,
+                         bool zero_fill,
+                         const char *prefix,
+                         size_t prefix_len,
+                         size_t zeros,
+                         const char *body,
+                         size_t body_len) {
+  size_t total = prefix_len + zeros + body_len;
+  size_t pad = ((size_t)spec->width > total) ? spec->width - total : 0;
+
+  if (!spec->left && !zero_fill) {
+    format_repeat(dst, ' ', pad);
+  }
+  str_append(dst, (const uint8_t *)prefix, prefix_len);
+  if (!spec->left && zero_fill) {
+    zeros += pad; // zero padding goes between the sign and the digits
+  }
+  format_repeat(dst, '0', zeros);
+  str_append(dst, (const uint8_t *)body, body_len);
+  if (spec->left) {
+    format_repeat(dst, ' ', pad);
+  }
+}
+
+static void format_integer(mu_str_t *dst,
+                           const format_spec_t *spec,
+                           uintmax_t magnitude,
+                           bool negative,
+                           unsigned int base,
+                           bool upper,
+                           const char *radix) {
+  const char *digit_chars = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char digits[FORMAT_DIGITS_MAX];
+  char *d = &digits[sizeof(digits)];
+  char prefix[3];
+  size_t prefix_len = 0;
+  size_t n_digits;
+  size_t zeros = 0;
+
+  if (magnitude <= UINT32_MAX) {
+    // 32 bit division is far cheaper than 64 bit division on small cores.
+    uint32_t v = (uint32_t)magnitude;
+    do {
+      *--d = digit_chars[v % base];
+      v /= base;
+    } while (v != 0);
+  } else {
+    uintmax_t v = magnitude;
+    do {
+      *--d = digit_chars[v % base];
+      v /= base;
+    } while (v != 0);
+  }
+  n_digits = &digits[sizeof(digits)] - d;
+  if (spec->precision == 0 && magnitude == 0) {
+    n_digits = 0; // an explicit zero precision prints no digits for zero
+  }
+
+  if (negative) {
+    prefix[prefix_len++] = '-';
+  } else if (spec->sign != 0) {
+    prefix[prefix_len++] = spec->sign;
+  }
+  while (*radix != '\0') {
+    prefix[prefix_len++] = *radix++;
+  }
+
+  if (spec->precision > 0 && (size_t)spec->precision > n_digits) {
+    zeros = spec->precision - n_digits;
+  }
+  // As in C, the '0' flag is ignored when a precision is given.
+  format_field(dst, spec, spec->zero && spec->precision < 0, prefix,
+               prefix_len, zeros, &digits[sizeof(digits)] - n_digits,
+               n_digits);
+}
+
+#if (MU_STR_FORMAT_FLOAT)
+static void format_float(mu_str_t *dst,
+                         const format_spec_t *spec,
+                         double value) {
+  static const uint32_t s_pow10[FORMAT_FLOAT_MAX_PRECISION + 1] = {
+      1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+      1000000000};
+  char body[FORMAT_DIGITS_MAX + 2 + FORMAT_FLOAT_MAX_PRECISION];
+  char *d = &body[sizeof(body)];
+  char prefix[1];
+  size_t prefix_len = 0;
+  bool negative = signbit(value) != 0;
+  double magnitude = negative ? -value : value;
+  int precision = spec->precision < 0 ? 6 : spec->precision;
+
+  if (precision > FORMAT_FLOAT_MAX_PRECISION) {
+    precision = FORMAT_FLOAT_MAX_PRECISION;
+  }
+  if (negative) {
+    prefix[prefix_len++] = '-';
+  } else if (spec->sign != 0) {
+    prefix[prefix_len++] = spec->sign;
+  }
+
+  if (value != value) {
+    format_field(dst, spec, false, "", 0, 0, "nan", 3);
+    return;
+  } else if (magnitude >= 18446744073709551616.0) {
+    // beyond the range of the fixed-point conversion (which includes inf)
+    format_field(dst, spec, false, prefix, prefix_len, 0, "inf", 3);
+    return;
+  }
+
+  // Split into integer and fraction parts, scale the fraction to a fixed
+  // point integer with `precision` digits and round, carrying into the
+  // integer part if the fraction rounds up to 1.  Scaling rounds, and can land
+  // a value that is not a tie exactly on x.5, so that case is decided by the
+  // exact error of the product.  True ties round to even, as in the C library.
+  uint64_t integer = (uint64_t)magnitude;
+  uint32_t scale = s_pow10[precision];
+  double part = magnitude - (double)integer;
+  double scaled = part * scale;
+  uint32_t fraction = (uint32_t)scaled;
+  double remainder = scaled - (double)fraction;
+  bool round_up = remainder > 0.5;
+  if (remainder == 0.5) {
+    double error = product_error(part, (double)scale, scaled);
+    if (error != 0) {
+      round_up = error > 0;
+    } else {
+      round_up = precision > 0 ? (fraction & 1) != 0 : (integer & 1) != 0;
+    }
+  }
+  if (round_up) {
+    fraction += 1;
+  }
+  if (fraction >= scale) {
+    fraction -= scale;
+    integer += 1;
+  }
+
+  for (int i = 0; i < precision; i++) {
+    *--d = '0' + (fraction % 10);
+    fraction /= 10;
+  }
+  if (precision > 0 || spec->alt) {
+    *--d = '.';
+  }
+  do {
+    *--d = '0' + (integer % 10);
+    integer /= 10;
+  } while (integer != 0);
+
+  format_field(dst, spec, spec->zero, prefix, prefix_len, 0, d,
+               &body[sizeof(body)] - d);
+}
+
+// Return the rounding error of product = a * b, i.e. the exact a * b less
+// product, using Dekker's algorithm.  (fma() would do, but it isn't correctly
+// rounded in every embedded C library.)
+static double product_error(double a, double b, double product) {
+  double a_lo, b_lo;
+  double a_hi = split_double(a, &a_lo);
+  double b_hi = split_double(b, &b_lo);
+  return ((a_hi * b_hi - product) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+}
+
+// Split a into high and low halves of at most 26 significant bits each, so
+// that the product of any two halves is exact.
+static double split_double(double a, double *lo) {
+  double t = 134217729.0 * a; // 2^27 + 1
+  double hi = t - (t - a);
+  *lo = a - hi;
+  return hi;
+}
+#endif
+
+static void format_repeat(mu_str_t *dst, char ch, size_t count) {
+  while (count-- > 0 && mu_str_write_byte(dst, ch)) {
+  }
+}
+
+static const uint8_t *str_find_byte(const uint8_t *p, size_t n, uint8_t byte) {
+#if (MU_STR_WORD_SEARCH)
+  // Each byte of `ones` is 0x01 and each byte of `highs` is 0x80.
+  const uintptr_t ones = (uintptr_t)-1 / 0xff;
+  const uintptr_t highs = ones << 7;
+  const uintptr_t pattern = ones * byte;
+
+  // Byte at a time up to a word boundary...
+  while (n > 0 && ((uintptr_t)p & (sizeof(uintptr_t) - 1)) != 0) {
+    if (*p == byte) {
+      return p;
+    }
+    p++;
+    n--;
+  }
+  // ... then a word at a time until a word contains the byte: XOR turns
+  // matching bytes into zero bytes, and (w - ones) & ~w & highs is non-zero
+  // iff w has a zero byte ...
+  while (n >= sizeof(uintptr_t)) {
+    uintptr_t w;
+    memcpy(&w, p, sizeof(w)); // aligned: compiles to a single load
+    w ^= pattern;
+    if (((w - ones) & ~w & highs) != 0) {
+      break;
+    }
+    p += sizeof(uintptr_t);
+    n -= sizeof(uintptr_t);
+  }
+  // ... and byte at a time to locate it within the word (or the tail).
+  while (n > 0) {
+    if (*p == byte) {
+      return p;
+    }
+    p++;
+    n--;
+  }
+  return NULL;
+#else
+  return (const uint8_t *)memchr(p, byte, n);
+#endif
+}
@@ -33,12 +33,45 @@ extern "C" {
 // Includes
 
 #include "mu_strbuf.h"
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 // =============================================================================
 // Types and definitions
 
+/**
+ * When MU_STR_PRINTF_USE_FORMAT is non-zero, mu_str_printf() is implemented
+ * with the native mu_str_vformat() rather than vsnprintf(), so that a build
+ * that uses no other printf-family function need not link the C library's
+ * formatter at all.
+ */
+#ifndef MU_STR_PRINTF_USE_FORMAT
+#define MU_STR_PRINTF_USE_FORMAT 0
+#endif
+
+/**
+ * When MU_STR_FORMAT_FLOAT is non-zero, mu_str_vformat() also accepts %f.  It
+ * is off by default since it pulls in double-precision arithmetic, which is
+ * emulated in software on most small targets.
+ */
+#ifndef MU_STR_FORMAT_FLOAT
+#define MU_STR_FORMAT_FLOAT 0
+#endif
+
+/**
+ * The byte searches below use the C library's memchr(), which is word-at-a-time
+ * in most C libraries.  Set MU_STR_WORD_SEARCH non-zero to use mulib's own
+ * word-at-a-time search instead, e.g. with a size-optimized C library whose
+ * memchr() tests one byte at a time.
+ */
+#ifndef MU_STR_WORD_SEARCH
+#define MU_STR_WORD_SEARCH 0
+#endif
+
+// Returned by the mu_str_find_xxx() functions when there is no match.
+#define MU_STR_NOT_FOUND (-1)
+
 typedef struct {
   mu_strbuf_t *buf; // reference to underlying buffer
   size_t s;          // index of next byte to be read, or start of string
@@ -120,6 +153,48 @@ mu_str_t *mu_str_copy(mu_str_t *dst, const mu_str_t *src);
 mu_str_t *mu_str_slice(mu_str_t *dst, const mu_str_t *src, int start, int end);
 
 
+/**
+ * @brief Find the first occurrence of a byte in a mu_str.
+ *
+ * @param str The mu_str to search.
+ * @param byte The byte to search for.
+ * @return The index of the byte relative to the start of str, or
+ *         MU_STR_NOT_FOUND.
+ */
+int mu_str_find_byte(const mu_str_t *str, uint8_t byte);
+
+/**
+ * @brief Find the first occurrence of a substring in a mu_str.
+ *
+ * An empty substring matches at index 0.
+ *
+ * @param str The mu_str to search.
+ * @param substr The substring to search for.
+ * @return The index of the substring relative to the start of str, or
+ *         MU_STR_NOT_FOUND.
+ */
+int mu_str_find_substr(const mu_str_t *str, const mu_str_t *substr);
+
+/**
+ * @brief Split the next token from the start of a mu_str.
+ *
+ * token is set to the bytes of str up to (but not including) the first delim,
+ * and str is advanced past the delim.  If str has no delim, token receives all
+ * of str and str is left empty.  No bytes are copied: token refers to the same
+ * underlying buffer as str.  Typical use:
+ *
+ *   mu_str_t line;
+ *   while (mu_str_split_next(&input, '\n', &line)) {
+ *     handle_line(&line);
+ *   }
+ *
+ * @param str The mu_str to split.  Modified to refer to the remainder.
+ * @param delim The delimiting byte.
+ * @param token Receives the token.
+ * @return false if str was empty (and token was not modified), true otherwise.
+ */
+bool mu_str_split_next(mu_str_t *str, uint8_t delim, mu_str_t *token);
+
 /**
  * @brief Return the number of bytes available for reading.
  *
@@ -188,6 +263,26 @@ uint8_t *mu_str_write_ref(const mu_str_t *str);
  */
 bool mu_str_read_byte(mu_str_t *str, uint8_t *byte);
 
+/**
+ * @brief Read n_bytes from the underlying string into dst.
+ *
+ * Either all n_bytes are copied and consumed or, if fewer than n_bytes are
+ * available, nothing is copied or consumed.  This lets a streaming decoder
+ * take a whole field with one bounds check and retry once more bytes arrive.
+ *
+ * @param str The mu_str
+ * @param dst Receives the bytes.
+ * @param n_bytes The number of bytes to read.
+ * @return True if the bytes were read, false if fewer than n_bytes were
+ *         available.
+ */
+bool mu_str_read_bytes(mu_str_t *str, void *dst, size_t n_bytes);
+
+/**
+ * @brief Like mu_str_read_bytes(), but leaves the bytes in str.
+ */
+bool mu_str_peek_bytes(const mu_str_t *str, void *dst, size_t n_bytes);
+
 /**
  * @brief Write one byte to the underlying string.
  *
@@ -218,6 +313,60 @@ size_t mu_str_append(mu_str_t *dst, const mu_str_t *src);
  */
 size_t mu_str_append_cstr(mu_str_t *dst, const char *cstr);
 
+/**
+ * @brief Parse a signed decimal integer from the start of a mu_str.
+ *
+ * Accepts an optional '+' or '-' followed by one or more decimal digits and
+ * stops at the first non-digit.  On success, the parsed bytes are consumed
+ * from str.  If there are no digits or the value does not fit in an int32_t,
+ * nothing is consumed and value is not modified.
+ *
+ * @param str The mu_str to parse from.
+ * @param value Receives the parsed value.
+ * @return The number of bytes consumed, or 0 on failure.
+ */
+size_t mu_str_parse_int(mu_str_t *str, int32_t *value);
+
+/**
+ * @brief Parse an unsigned hexadecimal integer from the start of a mu_str.
+ *
+ * Accepts one or more hex digits (either case, no "0x" prefix) and stops at
+ * the first non-hex byte.  On success, the parsed bytes are consumed from
+ * str.  If there are no digits or the value does not fit in a uint32_t,
+ * nothing is consumed and value is not modified.
+ *
+ * @param str The mu_str to parse from.
+ * @param value Receives the parsed value.
+ * @return The number of bytes consumed, or 0 on failure.
+ */
+size_t mu_str_parse_hex(mu_str_t *str, uint32_t *value);
+
+/**
+ * @brief Append the decimal representation of an unsigned integer.
+ *
+ * Either the whole number is written or, if there is not enough room, nothing
+ * is written.
+ *
+ * @param dst The mu_str to receive the digits.
+ * @param value The value to write.
+ * @return The number of bytes written, or 0 if dst lacks room.
+ */
+size_t mu_str_append_uint(mu_str_t *dst, uint32_t value);
+
+/**
+ * @brief Append the lower-case hexadecimal representation of an unsigned
+ * integer, zero-padded to at least min_digits (at most 8) digits.
+ *
+ * Either the whole number is written or, if there is not enough room, nothing
+ * is written.
+ *
+ * @param dst The mu_str to receive the digits.
+ * @param value The value to write.
+ * @param min_digits The minimum number of digits to write.
+ * @return The number of bytes written, or 0 if dst lacks room.
+ */
+size_t mu_str_append_hex(mu_str_t *dst, uint32_t value, uint8_t min_digits);
+
 /**
  * @brief Printf to a mu_str.
  *
@@ -228,6 +377,42 @@ size_t mu_str_append_cstr(mu_str_t *dst, const char *cstr);
  */
 size_t mu_str_printf(mu_str_t *dst, const char *fmt, ...);
 
+/**
+ * @brief Format to a mu_str using mulib's own formatter.
+ *
+ * Characters are written directly into the mu_str's underlying buffer: no
+ * intermediate buffer is used, and output stops quietly when the mu_str is
+ * full.  The supported subset of printf is:
+ *
+ *   conversions:  %d %i %u %x %X %o %c %s %p %% (and %f, see below)
+ *   flags:        '-' (left justify), '0' (zero pad), '+', ' ', '#'
+ *   width:        decimal digits or '*'
+ *   precision:    '.' followed by digits or '*' (minimum digits for integers,
+ *                 maximum characters for %s, fraction digits for %f)
+ *   length:       hh h l ll j z t (and L for floating point)
+ *
+ * %f is only available when MU_STR_FORMAT_FLOAT is non-zero.  It is rendered
+ * by scaling to a fixed-point integer, so the precision is limited to 9
+ * fraction digits and magnitudes of 2^64 or more print as "inf".  Rounding
+ * follows the exact binary value as in the C library: "%.1f" of 0.15 (just
+ * below 0.15) gives "0.1", and exact ties round to even, so "%.1f" of 1.25
+ * gives "1.2".  Unsupported conversions are copied to the
+ * output verbatim; the floating point ones (%e, %g, %a, and %f when disabled)
+ * still consume their double or long double argument so the conversions that
+ * follow stay aligned.
+ *
+ * @param dst The mu_str to receive the bytes.
+ * @param fmt The printf-style format string
+ * @param ... Arguments to the format
+ * @return The number of bytes written.
+ */
+size_t mu_str_format(mu_str_t *dst, const char *fmt, ...);
+
+/**
+ * @brief Like mu_str_format(), but takes a va_list.
+ */
+size_t mu_str_vformat(mu_str_t *dst, const char *fmt, va_list ap);
+
 /**
  * @brief Copy the contents of a mu_str to a C-style string
  *
@@ -245,7 +430,6 @@ size_t mu_str_to_cstr(const mu_str_t *src, char *cstr, size_t len);
 // mu_str_cmp -- compare two strings
 // mu_str_equals -- mu_str_cmp() == 0
 // mu_str_eq ? -- do two mu_str object point to the same bytes?
-// mu_str_find -- find first occurance of a substring within a mu_str
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,147 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_str_chain.h"
+#include "mu_str.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// private types and definitions
+
+// =============================================================================
+// private declarations
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+mu_str_chain_t *mu_str_chain_init(mu_str_chain_t *chain,
+                                  mu_str_t *segments,
+                                  size_t capacity) {
+  chain->segments = segments;
+  chain->capacity = capacity;
+  return mu_str_chain_reset(chain);
+}
+
+mu_str_chain_t *mu_str_chain_reset(mu_str_chain_t *chain) {
+  chain->count = 0;
+  chain->first = 0;
+  return chain;
+}
+
+mu_str_chain_err_t mu_str_chain_append(mu_str_chain_t *chain,
+                                       const mu_str_t *src) {
+  if (chain->count >= chain->capacity) {
+    return MU_STR_CHAIN_ERR_FULL;
+  }
+  mu_str_copy(&chain->segments[chain->count++], src);
+  return MU_STR_CHAIN_ERR_NONE;
+}
+
+size_t mu_str_chain_count(const mu_str_chain_t *chain) {
+  return chain->count - chain->first;
+}
+
+size_t mu_str_chain_length(const mu_str_chain_t *chain) {
+  size_t length = 0;
+
+  for (size_t i = chain->first; i < chain->count; i++) {
+    length += mu_str_read_available(&chain->segments[i]);
+  }
+  return length;
+}
+
+const mu_str_t *mu_str_chain_segment(const mu_str_chain_t *chain,
+                                     size_t index) {
+  if (index >= mu_str_chain_count(chain)) {
+    return NULL;
+  }
+  return &chain->segments[chain->first + index];
+}
+
+size_t mu_str_chain_write(const mu_str_chain_t *chain,
+                          mu_str_chain_writer_t writer,
+                          void *ctx) {
+  size_t total = 0;
+
+  for (size_t i = chain->first; i < chain->count; i++) {
+    const mu_str_t *segment = &chain->segments[i];
+    size_t len = mu_str_read_available(segment);
+    size_t accepted;
+
+    if (len == 0) {
+      continue;
+    }
+    accepted = writer(ctx, mu_str_read_ref(segment), len);
+    total += accepted;
+    if (accepted < len) {
+      break; // writer is full
+    }
+  }
+  return total;
+}
+
+size_t mu_str_chain_read_increment(mu_str_chain_t *chain, size_t n_bytes) {
+  size_t consumed = 0;
+
+  while (chain->first < chain->count) {
+    mu_str_t *segment = &chain->segments[chain->first];
+    size_t len = mu_str_read_available(segment);
+
+    if (len > n_bytes - consumed) {
+      // partially consume this segment and stop
+      segment->s += n_bytes - consumed;
+      return n_bytes;
+    }
+    // drop this segment (and any empty segments that follow it)
+    consumed += len;
+    chain->first += 1;
+  }
+  return consumed;
+}
+
+size_t mu_str_chain_flatten(const mu_str_chain_t *chain, mu_str_t *dst) {
+  size_t total = 0;
+
+  for (size_t i = chain->first; i < chain->count; i++) {
+    const mu_str_t *segment = &chain->segments[i];
+    size_t copied = mu_str_append(dst, segment);
+
+    total += copied;
+    if (copied < mu_str_read_available(segment)) {
+      break; // dst is full
+    }
+  }
+  return total;
+}
+
+// =============================================================================
+// private code
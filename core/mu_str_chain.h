@@ -0,0 +1,192 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief A scatter-gather list of mu_str segments.
+ *
+ * Assembling a protocol frame -- status line, headers, payload -- by
+ * mu_str_append()-ing each piece into one buffer copies every byte.  A
+ * mu_str_chain instead records each piece as a mu_str segment: appending a
+ * segment copies only the mu_str_t (a buffer reference and two indices), never
+ * the bytes it refers to.  The assembled chain can then be:
+ *
+ * * handed to a writer callback, one call per segment (mu_str_chain_write()),
+ * * walked segment by segment to fill in a DMA descriptor list, using
+ *   mu_str_chain_segment() with mu_str_read_ref() / mu_str_read_available(),
+ * * or, only when explicitly asked, copied into a single mu_str
+ *   (mu_str_chain_flatten()).
+ *
+ * For a transport that accepts only part of a chain at a time, such as a
+ * non-blocking UART, mu_str_chain_read_increment() consumes bytes from the
+ * front so the next mu_str_chain_write() resumes where the last one stopped.
+ *
+ * The chain does not own the bytes: each segment's underlying mu_strbuf must
+ * remain valid and unmodified until the chain has been written.  Segment
+ * storage is supplied by the caller:
+ *
+ *     static mu_str_t s_segments[4];
+ *     mu_str_chain_init(&chain, s_segments, 4);
+ *     mu_str_chain_append(&chain, &status_line);
+ *     mu_str_chain_append(&chain, &headers);
+ *     mu_str_chain_append(&chain, &body);
+ *     mu_str_chain_write(&chain, uart_write, &uart);
+ */
+
+#ifndef _MU_STR_CHAIN_H_
+#define _MU_STR_CHAIN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_str.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  MU_STR_CHAIN_ERR_NONE,
+  MU_STR_CHAIN_ERR_FULL,
+} mu_str_chain_err_t;
+
+typedef struct {
+  mu_str_t *segments; // caller-supplied segment storage
+  size_t capacity;    // number of elements in segments[]
+  size_t count;       // number of segments in use
+  size_t first;       // index of the first segment not yet fully consumed
+} mu_str_chain_t;
+
+/**
+ * @brief Signature of a function that accepts bytes from mu_str_chain_write().
+ *
+ * @param ctx The ctx argument passed to mu_str_chain_write().
+ * @param data Pointer to the bytes to write.
+ * @param len The number of bytes to write.
+ * @return The number of bytes accepted.  Returning fewer than len stops the
+ *         write.
+ */
+typedef size_t (*mu_str_chain_writer_t)(void *ctx,
+                                        const uint8_t *data,
+                                        size_t len);
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize an empty chain over caller-supplied segment storage.
+ *
+ * @param chain The chain to initialize.
+ * @param segments Storage for up to capacity segments.
+ * @param capacity The number of elements in segments.
+ * @return chain
+ */
+mu_str_chain_t *mu_str_chain_init(mu_str_chain_t *chain,
+                                  mu_str_t *segments,
+                                  size_t capacity);
+
+/**
+ * @brief Remove all segments from a chain.
+ */
+mu_str_chain_t *mu_str_chain_reset(mu_str_chain_t *chain);
+
+/**
+ * @brief Append a segment to the end of a chain.
+ *
+ * Only the mu_str_t is copied: the segment refers to the same bytes as src.
+ * Empty segments are accepted but contribute nothing when written.
+ *
+ * @param chain The chain.
+ * @param src The mu_str whose readable bytes form the segment.
+ * @return MU_STR_CHAIN_ERR_NONE on success, MU_STR_CHAIN_ERR_FULL if the chain
+ *         already holds capacity segments.
+ */
+mu_str_chain_err_t mu_str_chain_append(mu_str_chain_t *chain,
+                                       const mu_str_t *src);
+
+/**
+ * @brief Return the number of segments not yet fully consumed.
+ */
+size_t mu_str_chain_count(const mu_str_chain_t *chain);
+
+/**
+ * @brief Return the total number of unconsumed bytes in a chain.
+ */
+size_t mu_str_chain_length(const mu_str_chain_t *chain);
+
+/**
+ * @brief Return the index'th unconsumed segment, or NULL if index is out of
+ * range.
+ */
+const mu_str_t *mu_str_chain_segment(const mu_str_chain_t *chain,
+                                     size_t index);
+
+/**
+ * @brief Pass each segment of a chain to a writer, in order.
+ *
+ * Empty segments are skipped.  Writing stops early if the writer accepts
+ * fewer bytes than it was offered.  The chain itself is not modified: call
+ * mu_str_chain_read_increment() with the result to consume what was written.
+ *
+ * @param chain The chain.
+ * @param writer The function to receive the bytes.
+ * @param ctx Passed as the first argument to writer.
+ * @return The total number of bytes accepted by the writer.
+ */
+size_t mu_str_chain_write(const mu_str_chain_t *chain,
+                          mu_str_chain_writer_t writer,
+                          void *ctx);
+
+/**
+ * @brief Consume bytes from the front of a chain.
+ *
+ * @param chain The chain.
+ * @param n_bytes The number of bytes to consume.  Never consumes more than
+ *        mu_str_chain_length().
+ * @return The number of bytes consumed.
+ */
+size_t mu_str_chain_read_increment(mu_str_chain_t *chain, size_t n_bytes);
+
+/**
+ * @brief Copy the bytes of a chain into a single mu_str.
+ *
+ * This is the only mu_str_chain operation that copies data.  Copying stops
+ * when dst is full.  The chain is not modified.
+ *
+ * @param chain The chain.
+ * @param dst The mu_str to append to.
+ * @return The number of bytes copied.
+ */
+size_t mu_str_chain_flatten(const mu_str_chain_t *chain, mu_str_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _MU_STR_CHAIN_H_ */
@@ -58,6 +58,16 @@ mu_strbuf_t *mu_strbuf_init_wr(mu_strbuf_t *buf,
   return buf;
 }
 
+mu_strbuf_t *mu_strbuf_init_from_arena(mu_strbuf_t *buf,
+                                       mu_arena_t *arena,
+                                       size_t capacity) {
+  uint8_t *wdata = mu_arena_alloc_aligned(arena, capacity, 1);
+  if (wdata == NULL) {
+    return NULL;
+  }
+  return mu_strbuf_init_wr(buf, wdata, capacity);
+}
+
 mu_strbuf_t *mu_strbuf_init_from_cstr(mu_strbuf_t *buf,
                                       const char *const cstr) {
   return mu_strbuf_init_ro(buf, (const uint8_t *const)cstr, strlen(cstr));
@@ -32,6 +32,7 @@ extern "C" {
 // =============================================================================
 // Includes
 
+#include "mu_arena.h"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -57,6 +58,17 @@ mu_strbuf_t *mu_strbuf_init_wr(mu_strbuf_t *buf,
                                uint8_t *wdata,
                                size_t capacity);
 
+/**
+ * @brief Initialize a writeable strbuf whose storage is carved from an arena.
+ *
+ * The storage is released when the arena is rewound past it or reset.
+ *
+ * @return buf, or NULL if the arena cannot supply capacity bytes.
+ */
+mu_strbuf_t *mu_strbuf_init_from_arena(mu_strbuf_t *buf,
+                                       mu_arena_t *arena,
+                                       size_t capacity);
+
 mu_strbuf_t *mu_strbuf_init_from_cstr(mu_strbuf_t *buf, const char *const cstr);
 
 const uint8_t *const mu_strbuf_rdata(const mu_strbuf_t *buf);
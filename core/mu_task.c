@@ -28,7 +28,10 @@
 #include "mulib.h"
 #include "mu_task.h"
 #include "mu_thunk.h"
+#include <limits.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 // =============================================================================
 // private types and definitions
@@ -36,9 +39,23 @@
 // =============================================================================
 // private declarations
 
+#if (MU_TASK_PROFILING)
+static uint32_t profiling_now(void);
+
+static void histogram_add(uint16_t *histogram, uint32_t interval);
+
+static size_t histogram_dump(const char *label,
+                             const uint16_t *histogram,
+                             mu_str_t *dst);
+#endif
+
 // =============================================================================
 // local storage
 
+#if (MU_TASK_PROFILING)
+static mu_task_profiling_clock_fn s_profiling_clock;
+#endif
+
 // =============================================================================
 // public code
 
@@ -47,13 +64,20 @@ mu_task_t *mu_task_init(mu_task_t *task,
                         void *ctx,
                         const char *name) {
   mu_dlist_init(&task->link);
+#if (MU_SCHED_USE_PHEAP)
+  mu_pheap_node_init(&task->heap_link);
+#endif
+  task->seq = 0;
+  task->isr_pending = 0;
   task->time = 0;
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  task->priority = 0;
+  task->is_ready = 0;
+#endif
   mu_thunk_init(&task->thunk, fn, ctx);
 #if (MU_TASK_PROFILING)
   task->name = name;
-  task->call_count = 0;
-  task->runtime = 0;
-  task->max_duration = 0;
+  mu_task_profile_reset(task);
 #endif
   return task;
 }
@@ -93,19 +117,48 @@ void mu_task_call(mu_task_t *task, void *arg) {
   }
 
 #if (MU_TASK_PROFILING)
-  mu_time_t called_at = mu_time_now();
+  uint32_t called_at = profiling_now();
 #endif
   mu_thunk_call(&task->thunk, arg);
 #if (MU_TASK_PROFILING)
+  // unsigned difference tolerates wraparound of the profiling clock
+  uint32_t duration = profiling_now() - called_at;
   task->call_count += 1;
-  mu_duration_t duration = mu_time_difference(mu_time_now(), called_at);
   task->runtime += duration;
   if (duration > task->max_duration) task->max_duration = duration;
+  histogram_add(task->duration_hist, duration);
 #endif
 }
 
 bool mu_task_is_scheduled(mu_task_t *task) {
+#if (MU_SCHED_USE_PHEAP)
+  // a runnable task waiting in a priority ready queue uses the dlist link
+  return mu_pheap_node_is_linked(&task->heap_link) ||
+         mu_dlist_is_linked(&task->link);
+#else
   return mu_dlist_is_linked(&task->link);
+#endif
+}
+
+uint8_t mu_task_get_priority(mu_task_t *task) {
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  return task->priority;
+#else
+  (void)(task);
+  return 0;
+#endif
+}
+
+void mu_task_set_priority(mu_task_t *task, uint8_t priority) {
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  if (priority >= MU_TASK_PRIORITY_LEVELS) {
+    priority = MU_TASK_PRIORITY_LEVELS - 1;
+  }
+  task->priority = priority;
+#else
+  (void)(task);
+  (void)(priority);
+#endif
 }
 
 #if (MU_TASK_PROFILING)
@@ -122,6 +175,55 @@ mu_duration_t mu_task_max_duration_ms(mu_task_t *task) {
   return mu_time_duration_to_ms(task->max_duration);
 }
 
+void mu_task_set_profiling_clock(mu_task_profiling_clock_fn clock_fn) {
+  s_profiling_clock = clock_fn;
+}
+
+void mu_task_profile_reset(mu_task_t *task) {
+  task->call_count = 0;
+  task->runtime = 0;
+  task->max_duration = 0;
+  task->max_latency = 0;
+  memset(task->duration_hist, 0, sizeof(task->duration_hist));
+  memset(task->latency_hist, 0, sizeof(task->latency_hist));
+}
+
+void mu_task_record_latency(mu_task_t *task, mu_duration_t latency) {
+  if (latency < 0) {
+    latency = 0;
+  }
+  if (latency > task->max_latency) {
+    task->max_latency = latency;
+  }
+  histogram_add(task->latency_hist, latency);
+}
+
+mu_duration_t mu_task_max_latency(mu_task_t *task) {
+  return task->max_latency;
+}
+
+const uint16_t *mu_task_duration_histogram(mu_task_t *task) {
+  return task->duration_hist;
+}
+
+const uint16_t *mu_task_latency_histogram(mu_task_t *task) {
+  return task->latency_hist;
+}
+
+size_t mu_task_profile_dump(mu_task_t *task, mu_str_t *dst) {
+  size_t written = mu_str_printf(dst,
+                                 "%s calls=%u runtime=%lu max=%lu "
+                                 "max_latency=%ld\n",
+                                 mu_task_name(task),
+                                 task->call_count,
+                                 (unsigned long)task->runtime,
+                                 (unsigned long)task->max_duration,
+                                 (long)task->max_latency);
+  written += histogram_dump("  run:", task->duration_hist, dst);
+  written += histogram_dump("  lat:", task->latency_hist, dst);
+  return written;
+}
+
 #ifdef MU_FLOAT
 MU_FLOAT mu_task_runtime_s(mu_task_t *task) {
   return mu_time_duration_to_s(task->runtime);
@@ -136,3 +238,49 @@ MU_FLOAT mu_task_max_duration_s(mu_task_t *task) {
 
 // =============================================================================
 // private functions
+
+#if (MU_TASK_PROFILING)
+
+static uint32_t profiling_now(void) {
+  if (s_profiling_clock != NULL) {
+    return s_profiling_clock();
+  } else {
+    return (uint32_t)mu_time_now();
+  }
+}
+
+static void histogram_add(uint16_t *histogram, uint32_t interval) {
+  // bucket = number of significant bits in interval, so 0 => 0, 1 => 1,
+  // 2..3 => 2, 4..7 => 3 etc.
+#if defined(__GNUC__)
+  // clzl, not clz: unsigned int may be only 16 bits wide
+  int bucket = (interval == 0) ? 0
+                               : (int)(sizeof(unsigned long) * CHAR_BIT) -
+                                     __builtin_clzl(interval);
+#else
+  int bucket = 0;
+  while (interval != 0) {
+    bucket++;
+    interval >>= 1;
+  }
+#endif
+  if (bucket >= MU_TASK_HISTOGRAM_BUCKETS) {
+    bucket = MU_TASK_HISTOGRAM_BUCKETS - 1;
+  }
+  if (histogram[bucket] < UINT16_MAX) {
+    histogram[bucket] += 1;
+  }
+}
+
+static size_t histogram_dump(const char *label,
+                             const uint16_t *histogram,
+                             mu_str_t *dst) {
+  size_t written = mu_str_append_cstr(dst, label);
+  for (int i = 0; i < MU_TASK_HISTOGRAM_BUCKETS; i++) {
+    written += mu_str_printf(dst, " %u", histogram[i]);
+  }
+  written += mu_str_append_cstr(dst, "\n");
+  return written;
+}
+
+#endif
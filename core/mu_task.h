@@ -34,11 +34,48 @@ extern "C" {
 
 #include "mu_config.h"
 #include "mu_dlist.h"
+#include "mu_pheap.h"
+#include "mu_str.h"
 #include "mu_thunk.h"
+#include <stdint.h>
 
 // =============================================================================
 // types and definitions
 
+// By default, the scheduler keeps its tasks in a time-ordered doubly linked
+// list, which is compact and fast for small schedules.  Define
+// MU_SCHED_USE_PHEAP as 1 in mu_config.h to keep the schedule in a pairing heap
+// instead: scheduling a task becomes O(1) and removing one O(log n), at the
+// cost of a few more bytes per task.
+#ifndef MU_SCHED_USE_PHEAP
+#define MU_SCHED_USE_PHEAP 0
+#endif
+
+// Number of task priority levels.  Level 0 is the highest priority.  With the
+// default of a single level, runnable tasks are served strictly in time order.
+// With more than one level, the scheduler runs the highest priority runnable
+// task first, and tasks of equal priority in time order.
+#ifndef MU_TASK_PRIORITY_LEVELS
+#define MU_TASK_PRIORITY_LEVELS 1
+#endif
+
+#if (MU_TASK_PROFILING)
+
+// Number of buckets in each profiling histogram.  Bucket 0 counts intervals of
+// 0 ticks, bucket i counts intervals of 2^(i-1) up to 2^i - 1 ticks, and the
+// last bucket also counts everything longer.
+#ifndef MU_TASK_HISTOGRAM_BUCKETS
+#define MU_TASK_HISTOGRAM_BUCKETS 16
+#endif
+
+/**
+ * @brief Signature for a profiling clock: returns a free running tick count,
+ * e.g. the DWT cycle counter on a Cortex-M.
+ */
+typedef uint32_t (*mu_task_profiling_clock_fn)(void);
+
+#endif
+
 /**
  * A `mu_task` is a mu_thunk (deferrable function) with a time and a link field
  * ddded, primarily for the benefit of the scheduler.
@@ -46,13 +83,25 @@ extern "C" {
 
 typedef struct _mu_task {
   mu_dlist_t link;         // link into the schedule
+#if (MU_SCHED_USE_PHEAP)
+  mu_pheap_node_t heap_link; // link into the schedule (pairing heap)
+#endif
+  uint32_t seq;            // order in which the task was scheduled
+  volatile uint8_t isr_pending; // set while the task is in an ISR queue
   mu_time_t time;          // time at which this task fires
+#if (MU_TASK_PRIORITY_LEVELS > 1)
+  uint8_t priority;        // 0 = highest priority
+  uint8_t is_ready;        // set while the task is in a ready list
+#endif
   mu_thunk_t thunk;        // function to be scheduled
 #if (MU_TASK_PROFILING)
   const char *name;        // user defined task name
   unsigned int call_count; // # of times task is called
   MU_FLOAT runtime;        // accumulated time spent running the task
   MU_FLOAT max_duration;   // max time spend running the task
+  mu_duration_t max_latency; // max delay between task time and start time
+  uint16_t duration_hist[MU_TASK_HISTOGRAM_BUCKETS]; // log2 run times
+  uint16_t latency_hist[MU_TASK_HISTOGRAM_BUCKETS];  // log2 start latencies
 #endif
 } mu_task_t;
 
@@ -74,6 +123,22 @@ void mu_task_call(mu_task_t *task, void *arg);
 
 bool mu_task_is_scheduled(mu_task_t *task);
 
+/**
+ * @brief Return the task's priority, 0 being the highest.
+ *
+ * Always 0 unless MU_TASK_PRIORITY_LEVELS is greater than 1.
+ */
+uint8_t mu_task_get_priority(mu_task_t *task);
+
+/**
+ * @brief Set the task's priority, 0 being the highest.  Values beyond the last
+ * level are clamped to MU_TASK_PRIORITY_LEVELS - 1.  Tasks are initialized at
+ * priority 0.
+ *
+ * The new priority takes effect the next time the task is scheduled.
+ */
+void mu_task_set_priority(mu_task_t *task, uint8_t priority);
+
 #if (MU_TASK_PROFILING)
 
 unsigned int mu_task_call_count(mu_task_t *task);
@@ -82,6 +147,54 @@ mu_duration_t mu_task_runtime_ms(mu_task_t *task);
 
 mu_duration_t mu_task_max_duration_ms(mu_task_t *task);
 
+/**
+ * @brief Set the clock used to time each call of a task, or NULL to use
+ * mu_time_now() (the default).
+ *
+ * With a profiling clock installed, run times (including mu_task_runtime_ms()
+ * and friends, which assume mu_time units) are measured in its ticks.
+ * Scheduling latencies are always measured by the scheduler's clock.
+ */
+void mu_task_set_profiling_clock(mu_task_profiling_clock_fn clock_fn);
+
+/**
+ * @brief Clear the profiling statistics of a task.
+ */
+void mu_task_profile_reset(mu_task_t *task);
+
+/**
+ * @brief Record the interval between the time a task was scheduled for and the
+ * time it actually started.  Called by the scheduler.
+ */
+void mu_task_record_latency(mu_task_t *task, mu_duration_t latency);
+
+mu_duration_t mu_task_max_latency(mu_task_t *task);
+
+/**
+ * @brief Return the task's run time histogram (MU_TASK_HISTOGRAM_BUCKETS
+ * counts).  Counts saturate at UINT16_MAX.
+ */
+const uint16_t *mu_task_duration_histogram(mu_task_t *task);
+
+/**
+ * @brief Return the task's latency histogram (MU_TASK_HISTOGRAM_BUCKETS
+ * counts).  Counts saturate at UINT16_MAX.
+ */
+const uint16_t *mu_task_latency_histogram(mu_task_t *task);
+
+/**
+ * @brief Write a text summary of the task's profiling statistics to dst.
+ *
+ * The output has the form:
+ *
+ *    <name> calls=<n> runtime=<ticks> max=<ticks> max_latency=<ticks>
+ *      run: <count of bucket 0> <count of bucket 1> ...
+ *      lat: <count of bucket 0> <count of bucket 1> ...
+ *
+ * @return The number of bytes written.
+ */
+size_t mu_task_profile_dump(mu_task_t *task, mu_str_t *dst);
+
 #ifdef MU_FLOAT
 MU_FLOAT mu_task_runtime_s(mu_task_t *task);
 
@@ -43,6 +43,10 @@ static void one_shot_fn(void *ctx, void *arg);
 static void periodic_fn(void *ctx, void *arg);
 static void trigger_aux(void *ctx, void *arg, bool repeat);
 
+static void wheel_task_fn(void *ctx, void *arg);
+static void wheel_insert(mu_timer_wheel_t *wheel, mu_wheel_timer_t *timer);
+static void wheel_schedule(mu_timer_wheel_t *wheel);
+
 // =============================================================================
 // local storage
 
@@ -77,6 +81,88 @@ bool mu_timer_is_running(mu_timer_t *timer) {
          MU_SCHED_TASK_STATUS_IDLE;
 }
 
+mu_timer_wheel_t *mu_timer_wheel_init(mu_timer_wheel_t *wheel,
+                                      mu_dlist_t *slots,
+                                      size_t n_slots,
+                                      mu_duration_t tick) {
+  if ((n_slots == 0) || ((n_slots & (n_slots - 1)) != 0) || (tick <= 0)) {
+    return NULL;
+  }
+  for (size_t i = 0; i < n_slots; i++) {
+    mu_dlist_init(&slots[i]);
+  }
+  wheel->slots = slots;
+  wheel->mask = n_slots - 1;
+  wheel->tick = tick;
+  wheel->time = mu_time_now();
+  wheel->current = 0;
+  wheel->count = 0;
+  mu_task_init(&wheel->task, wheel_task_fn, wheel, "Timer Wheel");
+  return wheel;
+}
+
+size_t mu_timer_wheel_count(mu_timer_wheel_t *wheel) { return wheel->count; }
+
+mu_wheel_timer_t *mu_wheel_timer_one_shot(mu_wheel_timer_t *timer,
+                                          mu_timer_wheel_t *wheel,
+                                          mu_task_t *target_task) {
+  mu_dlist_init(&timer->link);
+  timer->wheel = wheel;
+  timer->target_task = target_task;
+  timer->expiry = 0;
+  timer->period = 0;
+  timer->periodic = false;
+  return timer;
+}
+
+mu_wheel_timer_t *mu_wheel_timer_periodic(mu_wheel_timer_t *timer,
+                                          mu_timer_wheel_t *wheel,
+                                          mu_task_t *target_task) {
+  mu_wheel_timer_one_shot(timer, wheel, target_task);
+  timer->periodic = true;
+  return timer;
+}
+
+mu_wheel_timer_t *mu_wheel_timer_start(mu_wheel_timer_t *timer,
+                                       mu_duration_t interval) {
+  mu_timer_wheel_t *wheel = timer->wheel;
+
+  mu_wheel_timer_stop(timer);
+  if (wheel->count == 0 && !mu_task_is_scheduled(&wheel->task)) {
+    // The wheel has been idle: restart its clock from the present.
+    wheel->time = mu_time_now();
+  }
+  if (interval < 0) {
+    interval = 0;
+  }
+  // The current tick started at wheel->time, which may be up to a tick (or
+  // more, if the wheel's task is running late) in the past.  Count from there
+  // so that the timer never fires before now + interval.
+  mu_duration_t elapsed = mu_time_difference(mu_time_now(), wheel->time);
+  if (elapsed < 0) {
+    elapsed = 0;
+  }
+  // Round up to whole ticks, and always wait at least one tick.
+  uint32_t ticks = (elapsed + interval + wheel->tick - 1) / wheel->tick;
+  timer->expiry = wheel->current + ((ticks == 0) ? 1 : ticks);
+  // Later periods are counted from the expiry, which lies on a tick boundary.
+  ticks = (interval + wheel->tick - 1) / wheel->tick;
+  timer->period = (ticks == 0) ? 1 : ticks;
+  wheel_insert(wheel, timer);
+  return timer;
+}
+
+mu_wheel_timer_t *mu_wheel_timer_stop(mu_wheel_timer_t *timer) {
+  if (mu_dlist_unlink(&timer->link) != NULL) {
+    timer->wheel->count -= 1;
+  }
+  return timer;
+}
+
+bool mu_wheel_timer_is_running(mu_wheel_timer_t *timer) {
+  return mu_dlist_is_linked(&timer->link);
+}
+
 // =============================================================================
 // static (local) code
 
@@ -97,3 +183,67 @@ static void trigger_aux(void *ctx, void *arg, bool repeat) {
   }
   mu_task_call(timer->target_task, timer);
 }
+
+/**
+ * @brief Advance the wheel by every tick that has elapsed, firing the timers
+ * that expire on each.
+ */
+static void wheel_task_fn(void *ctx, void *arg) {
+  mu_timer_wheel_t *wheel = (mu_timer_wheel_t *)ctx;
+  mu_time_t now = mu_time_now();
+  (void)(arg);
+
+  while ((wheel->count > 0) &&
+         !mu_time_follows(mu_time_offset(wheel->time, wheel->tick), now)) {
+    wheel->time = mu_time_offset(wheel->time, wheel->tick);
+    wheel->current += 1;
+
+    // Move this tick's timers to a private list first, so that target tasks
+    // may freely start and stop timers, including ones in this slot.
+    mu_dlist_t *slot = &wheel->slots[wheel->current & wheel->mask];
+    mu_dlist_t expired;
+    mu_dlist_init(&expired);
+    mu_dlist_t *link = mu_dlist_next(slot);
+    while (link != slot) {
+      mu_dlist_t *next = mu_dlist_next(link);
+      mu_wheel_timer_t *timer = MU_DLIST_CONTAINER(link, mu_wheel_timer_t, link);
+      if (timer->expiry == wheel->current) {
+        mu_dlist_unlink(link);
+        mu_dlist_push_prev(&expired, link);
+      }
+      link = next;
+    }
+
+    while ((link = mu_dlist_pop(&expired)) != NULL) {
+      mu_wheel_timer_t *timer = MU_DLIST_CONTAINER(link, mu_wheel_timer_t, link);
+      wheel->count -= 1;
+      if (timer->periodic) {
+        // Relative to the expiry rather than to now, so periods don't drift.
+        timer->expiry = wheel->current + timer->period;
+        wheel_insert(wheel, timer);
+      }
+      mu_task_call(timer->target_task, timer);
+    }
+  }
+  if (wheel->count > 0) {
+    // A target task may already have scheduled us for an earlier tick.
+    mu_sched_task_at(&wheel->task, mu_time_offset(wheel->time, wheel->tick));
+  } else {
+    mu_sched_remove_task(&wheel->task);
+  }
+}
+
+static void wheel_insert(mu_timer_wheel_t *wheel, mu_wheel_timer_t *timer) {
+  mu_dlist_push_prev(&wheel->slots[timer->expiry & wheel->mask], &timer->link);
+  wheel->count += 1;
+  wheel_schedule(wheel);
+}
+
+/**
+ * @brief Schedule the wheel's task for the next tick if any timer is running.
+ */
+static void wheel_schedule(mu_timer_wheel_t *wheel) {
+  if ((wheel->count > 0) && !mu_task_is_scheduled(&wheel->task)) {
+    mu_sched_task_at(&wheel->task, mu_time_offset(wheel->time, wheel->tick));
+  }
+}
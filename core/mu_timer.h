@@ -26,15 +26,18 @@
 #define _MU_TIMER_H_
 
 #ifdef __cplusplus
-extern "C";
+extern "C" {
 #endif
 
 // =============================================================================
 // includes
 
+#include "mu_dlist.h"
 #include "mu_task.h"
 #include "mu_time.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // =============================================================================
 // types and definitions
@@ -45,6 +48,36 @@ typedef struct {
   mu_duration_t interval;
 } mu_timer_t;
 
+// Each mu_timer_t is a scheduler task, so starting one costs a sorted insert
+// into the schedule.  For large numbers of timers that are frequently
+// restarted (e.g. retransmit timers), use a timer wheel instead: a hashed
+// wheel of n_slots lists, advanced once per tick by a single scheduler task.
+// A wheel timer lives in slot (expiry tick % n_slots), so starting, stopping
+// and restarting one is O(1) regardless of how many timers are running, and
+// the scheduler sees only the wheel's task.  Expiry times are rounded up to
+// the next tick, so a timer never fires before its interval has elapsed, and
+// fires at most one tick late.  The wheel's task is only scheduled while at
+// least one of its timers is running.
+
+typedef struct {
+  mu_dlist_t *slots;   // one list of timers per slot
+  size_t mask;         // number of slots - 1
+  mu_duration_t tick;  // wheel resolution
+  mu_time_t time;      // time of the current tick
+  uint32_t current;    // the current tick
+  size_t count;        // number of running timers
+  mu_task_t task;      // advances the wheel
+} mu_timer_wheel_t;
+
+typedef struct {
+  mu_dlist_t link;          // link into a wheel slot
+  mu_timer_wheel_t *wheel;  // the wheel that runs the timer
+  mu_task_t *target_task;   // task to call on expiry
+  uint32_t expiry;          // tick at which the timer fires
+  uint32_t period;          // interval in ticks
+  bool periodic;            // restart after firing
+} mu_wheel_timer_t;
+
 // =============================================================================
 // declarations
 
@@ -58,6 +91,59 @@ mu_timer_t *mu_timer_stop(mu_timer_t *timer);
 
 bool mu_timer_is_running(mu_timer_t *timer);
 
+/**
+ * @brief Initialize a timer wheel.
+ *
+ * @param wheel The wheel to initialize.
+ * @param slots Storage for n_slots list heads.
+ * @param n_slots Number of slots.  Must be a non-zero power of two.
+ * @param tick The wheel resolution.  Must be positive.
+ * @return wheel on success, NULL if n_slots or tick is invalid.
+ */
+mu_timer_wheel_t *mu_timer_wheel_init(mu_timer_wheel_t *wheel,
+                                      mu_dlist_t *slots,
+                                      size_t n_slots,
+                                      mu_duration_t tick);
+
+/**
+ * @brief Return the number of timers running in the wheel.
+ */
+size_t mu_timer_wheel_count(mu_timer_wheel_t *wheel);
+
+/**
+ * @brief Initialize a wheel timer that calls target_task once when it expires.
+ *
+ * As with mu_timer_t, target_task is called with the timer as its argument.
+ */
+mu_wheel_timer_t *mu_wheel_timer_one_shot(mu_wheel_timer_t *timer,
+                                          mu_timer_wheel_t *wheel,
+                                          mu_task_t *target_task);
+
+/**
+ * @brief Initialize a wheel timer that calls target_task each time its
+ * interval elapses.
+ */
+mu_wheel_timer_t *mu_wheel_timer_periodic(mu_wheel_timer_t *timer,
+                                          mu_timer_wheel_t *wheel,
+                                          mu_task_t *target_task);
+
+/**
+ * @brief Start or restart a wheel timer in constant time.
+ *
+ * @param timer The timer.  If it is already running, it is restarted.
+ * @param interval Time until the timer fires, rounded up to the next tick.
+ */
+mu_wheel_timer_t *mu_wheel_timer_start(mu_wheel_timer_t *timer,
+                                       mu_duration_t interval);
+
+/**
+ * @brief Stop a wheel timer in constant time.  Has no effect if the timer is
+ * not running.
+ */
+mu_wheel_timer_t *mu_wheel_timer_stop(mu_wheel_timer_t *timer);
+
+bool mu_wheel_timer_is_running(mu_wheel_timer_t *timer);
+
 #ifdef __cplusplus
 }
 #endif
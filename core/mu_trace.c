@@ -0,0 +1,119 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "mu_trace.h"
+#include "mu_atomic.h"
+#include "mu_cirq.h"
+#include "mu_time.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// private types and definitions
+
+typedef struct {
+  mu_cirq_t ring;            // records, oldest first
+  mu_trace_clock_fn clock_fn; // timestamp source, or NULL for mu_time_now()
+  uint32_t dropped_count;    // records lost because the ring was full
+  uint16_t seq;              // sequence number of the next record
+} mu_trace_t;
+
+// =============================================================================
+// private declarations
+
+// =============================================================================
+// local storage
+
+static mu_trace_t s_trace;
+
+// =============================================================================
+// public code
+
+bool mu_trace_init(mu_trace_record_t *store, size_t n_records) {
+  if (mu_cirq_init(&s_trace.ring, store, n_records) == NULL) {
+    s_trace.ring.store = NULL;
+    return false;
+  }
+  mu_trace_reset();
+  return true;
+}
+
+void mu_trace_reset(void) {
+  MU_CRITICAL_ENTER();
+  mu_cirq_reset(&s_trace.ring);
+  s_trace.dropped_count = 0;
+  s_trace.seq = 0;
+  MU_CRITICAL_EXIT();
+}
+
+void mu_trace_set_clock(mu_trace_clock_fn clock_fn) {
+  s_trace.clock_fn = clock_fn;
+}
+
+void mu_trace_record(uint8_t event, const void *id, uint8_t arg) {
+  mu_trace_record_t record;
+
+  if (s_trace.ring.store == NULL) {
+    return;
+  }
+  record.id = (uint32_t)(uintptr_t)id;
+  record.event = event;
+  record.arg = arg;
+
+  // Producers may be at foreground or interrupt level, so the ring is only
+  // touched with interrupts disabled.
+  MU_CRITICAL_ENTER();
+  if (s_trace.clock_fn != NULL) {
+    record.timestamp = s_trace.clock_fn();
+  } else {
+    record.timestamp = (uint32_t)mu_time_now();
+  }
+  record.seq = s_trace.seq++;
+  if (mu_cirq_is_full(&s_trace.ring)) {
+    mu_trace_record_t discard;
+    mu_cirq_read_n(&s_trace.ring, &discard, 1, sizeof(mu_trace_record_t));
+    s_trace.dropped_count += 1;
+  }
+  mu_cirq_write_n(&s_trace.ring, &record, 1, sizeof(mu_trace_record_t));
+  MU_CRITICAL_EXIT();
+}
+
+size_t mu_trace_read(mu_trace_record_t *dst, size_t count) {
+  size_t n_read;
+
+  MU_CRITICAL_ENTER();
+  n_read = mu_cirq_read_n(&s_trace.ring, dst, count, sizeof(mu_trace_record_t));
+  MU_CRITICAL_EXIT();
+  return n_read;
+}
+
+uint32_t mu_trace_dropped_count(void) {
+  return s_trace.dropped_count;
+}
+
+// =============================================================================
+// private code
@@ -0,0 +1,151 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file Binary trace recorder for post-mortem timeline analysis.
+ *
+ * When MU_SCHED_TRACE is defined as 1 in mu_config.h, the scheduler records an
+ * event each time a task is queued, posted from interrupt level, started or
+ * finished.  Each event is a fixed size record written into a preallocated
+ * ring (built on mu_cirq): no formatting happens on the target, and when the
+ * ring is full the oldest record is dropped.  When MU_SCHED_TRACE is 0 (the
+ * default), the MU_TRACE() calls compile to nothing.
+ *
+ * # Record format
+ *
+ * Records are read with mu_trace_read() and may be shipped to a host verbatim.
+ * Each record is 12 bytes in the target's byte order (little-endian on
+ * Cortex-M), with no padding:
+ *
+ *    offset  size  field
+ *         0     4  timestamp   trace clock ticks (see mu_trace_set_clock())
+ *         4     4  id          address of the task (or other object)
+ *         8     1  event       one of mu_trace_event_t
+ *         9     1  arg         event-specific argument
+ *        10     2  seq         incremented for each record, including dropped
+ *                              ones, so gaps in seq reveal lost records
+ *
+ * For example, a Python decoder can use struct.unpack("<IIBBH", record), and
+ * map ids to task names using the firmware's symbol table.
+ */
+
+#ifndef _MU_TRACE_H_
+#define _MU_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "mu_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// types and definitions
+
+#ifndef MU_SCHED_TRACE
+#define MU_SCHED_TRACE 0
+#endif
+
+typedef enum {
+  MU_TRACE_EVENT_NONE,
+  MU_TRACE_EVENT_TASK_QUEUED,   // task added to the schedule, arg = priority
+  MU_TRACE_EVENT_ISR_QUEUED,    // task posted from interrupt level
+  MU_TRACE_EVENT_ISR_COALESCED, // task posted while already in the isr queue
+  MU_TRACE_EVENT_ISR_OVERFLOW,  // isr queue was full: post failed
+  MU_TRACE_EVENT_TASK_START,    // task (or idle task) called
+  MU_TRACE_EVENT_TASK_END,      // task (or idle task) returned
+} mu_trace_event_t;
+
+typedef struct {
+  uint32_t timestamp;
+  uint32_t id;
+  uint8_t event;
+  uint8_t arg;
+  uint16_t seq;
+} mu_trace_record_t;
+
+/**
+ * @brief Signature for the trace clock: returns a free running tick count.
+ */
+typedef uint32_t (*mu_trace_clock_fn)(void);
+
+#if (MU_SCHED_TRACE)
+#define MU_TRACE(_event, _id, _arg) mu_trace_record((_event), (_id), (_arg))
+#else
+#define MU_TRACE(_event, _id, _arg) do {} while (0)
+#endif
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set up the trace ring.  Not interrupt safe.
+ *
+ * @param store Storage for the records.
+ * @param n_records Number of records in store.  As with mu_cirq, this must be
+ *        a power of two, and the ring holds one less.
+ * @return false (leaving tracing disabled) if n_records is unsuitable.
+ */
+bool mu_trace_init(mu_trace_record_t *store, size_t n_records);
+
+/**
+ * @brief Discard all records and clear the dropped count.
+ */
+void mu_trace_reset(void);
+
+/**
+ * @brief Set the clock used to timestamp records, or NULL to use mu_time_now()
+ * (the default).
+ */
+void mu_trace_set_clock(mu_trace_clock_fn clock_fn);
+
+/**
+ * @brief Append a record to the trace, dropping the oldest record if the ring
+ * is full.  May be called from interrupt level.  Does nothing if the trace has
+ * not been initialized.
+ */
+void mu_trace_record(uint8_t event, const void *id, uint8_t arg);
+
+/**
+ * @brief Remove up to count of the oldest records from the trace.
+ *
+ * @return The number of records copied to dst.
+ */
+size_t mu_trace_read(mu_trace_record_t *dst, size_t count);
+
+/**
+ * @brief Return the number of records dropped because the ring was full.
+ */
+uint32_t mu_trace_dropped_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef _MU_TRACE_H_
@@ -47,12 +47,31 @@ static void *ref(mu_vect_t *vect, size_t index);
  */
 static size_t find_insertion_index(mu_vect_t *vect, void *e, mu_vect_cmp_fn cmp);
 
+/**
+ * @brief Introsort the count elements starting at index lo, leaving partitions
+ * of MU_SORT_INSERTION_THRESHOLD or fewer elements for insertion_sort().
+ */
+static void quicksort(mu_vect_t *vect,
+                      mu_vect_cmp_fn cmp,
+                      size_t lo,
+                      size_t count,
+                      int depth);
+
+static void insertion_sort(mu_vect_t *vect, mu_vect_cmp_fn cmp);
+
+static void heapsort(mu_vect_t *vect, mu_vect_cmp_fn cmp);
+
 static void heapify(mu_vect_t *vect, mu_vect_cmp_fn cmp);
 
 static void sift_down(mu_vect_t *vect, mu_vect_cmp_fn cmp, int start, int end);
 
 static void swap(mu_vect_t *vect, int a, int b);
 
+/**
+ * @brief Quicksort recursion limit for count elements: 2 * floor(log2(count)).
+ */
+static int sort_depth(size_t count);
+
 // =============================================================================
 // local storage
 
@@ -172,17 +191,69 @@ mu_vect_err_t mu_vect_insert_sorted(mu_vect_t *vect, void *e, mu_vect_cmp_fn cmp
   return mu_vect_insert_at(vect, index, e);
 }
 
+mu_vect_err_t mu_vect_insert_sorted_n(mu_vect_t *vect,
+                                      void *elements,
+                                      size_t n,
+                                      mu_vect_cmp_fn cmp) {
+  mu_vect_t batch = *vect;
+  size_t i = mu_vect_count(vect);
+  size_t j = n;
+  size_t k = i + n;
+
+  if (n > mu_vect_capacity(vect) - mu_vect_count(vect)) {
+    return MU_VECT_ERR_FULL;
+  }
+  // sort the batch through a mu_vect view of it
+  batch.elements = elements;
+  batch.capacity = n;
+  batch.count = n;
+  mu_vect_sort(&batch, cmp);
+
+  // Merge from the top down, so each element is moved at most once and the
+  // unmerged existing elements are never overwritten.
+  while (j > 0) {
+    if (i > 0 && cmp(ref(vect, i - 1), ref(&batch, j - 1)) > 0) {
+      memcpy(ref(vect, --k), ref(vect, --i), mu_vect_element_size(vect));
+    } else {
+      memcpy(ref(vect, --k), ref(&batch, --j), mu_vect_element_size(vect));
+    }
+  }
+  vect->count += n;
+  return MU_VECT_ERR_NONE;
+}
+
 mu_vect_err_t mu_vect_sort(mu_vect_t *vect, mu_vect_cmp_fn cmp) {
-  heapify(vect, cmp);
-  size_t end = mu_vect_count(vect) - 1;
-  while (end > 0) {
-    swap(vect, end, 0);
-    end -= 1;
-    sift_down(vect, cmp, 0, end);
+  size_t count = mu_vect_count(vect);
+  size_t i = 1;
+
+  // Nearly-sorted input is common: check for already-sorted in one pass.
+  while (i < count && cmp(ref(vect, i), ref(vect, i - 1)) >= 0) {
+    i++;
+  }
+  if (i < count) {
+    quicksort(vect, cmp, 0, count, sort_depth(count));
+    insertion_sort(vect, cmp);
   }
   return MU_VECT_ERR_NONE;
 }
 
+size_t mu_vect_delete_if(mu_vect_t *vect, mu_vect_pred_fn pred, void *arg) {
+  size_t count = mu_vect_count(vect);
+  size_t kept = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    void *e = ref(vect, i);
+    if (!pred(e, arg)) {
+      if (kept != i) {
+        memcpy(ref(vect, kept), e, mu_vect_element_size(vect));
+      }
+      kept += 1;
+    }
+  }
+  vect->count = kept;
+  return count - kept;
+}
+
 void *mu_vect_traverse(mu_vect_t *vect, mu_vect_find_fn find_fn, void *arg) {
   for (size_t i = 0; i<mu_vect_count(vect); i++) {
     void *result = find_fn(ref(vect, i), arg);
@@ -228,6 +299,83 @@ static size_t find_insertion_index(mu_vect_t *vect, void *e, mu_vect_cmp_fn cmp)
   return low;
 }
 
+static void quicksort(mu_vect_t *vect,
+                      mu_vect_cmp_fn cmp,
+                      size_t lo,
+                      size_t count,
+                      int depth) {
+  while (count > MU_SORT_INSERTION_THRESHOLD) {
+    size_t hi = lo + count - 1;
+    size_t pivot = lo + count / 2;
+    size_t i = lo;
+    size_t j = hi;
+
+    if (depth-- == 0) {
+      // Too many bad partitions: heapsort a view of this range.
+      mu_vect_t view = *vect;
+      view.elements = ref(vect, lo);
+      view.count = count;
+      heapsort(&view, cmp);
+      return;
+    }
+    // Median of three, which also leaves sentinels at both ends.
+    if (cmp(ref(vect, pivot), ref(vect, lo)) < 0) {
+      swap(vect, pivot, lo);
+    }
+    if (cmp(ref(vect, hi), ref(vect, pivot)) < 0) {
+      swap(vect, hi, pivot);
+      if (cmp(ref(vect, pivot), ref(vect, lo)) < 0) {
+        swap(vect, pivot, lo);
+      }
+    }
+    for (;;) {
+      do {
+        i++;
+      } while (cmp(ref(vect, i), ref(vect, pivot)) < 0);
+      do {
+        j--;
+      } while (cmp(ref(vect, pivot), ref(vect, j)) < 0);
+      if (i >= j) {
+        break;
+      }
+      swap(vect, i, j);
+      // the pivot is compared in place, so follow it when it moves
+      if (pivot == i) {
+        pivot = j;
+      } else if (pivot == j) {
+        pivot = i;
+      }
+    }
+    // Recurse into the smaller part and iterate on the larger.
+    if (i - lo < count - (i - lo)) {
+      quicksort(vect, cmp, lo, i - lo, depth);
+      count -= i - lo;
+      lo = i;
+    } else {
+      quicksort(vect, cmp, i, count - (i - lo), depth);
+      count = i - lo;
+    }
+  }
+}
+
+static void insertion_sort(mu_vect_t *vect, mu_vect_cmp_fn cmp) {
+  for (size_t i = 1; i < mu_vect_count(vect); i++) {
+    for (size_t j = i; j > 0 && cmp(ref(vect, j), ref(vect, j - 1)) < 0; j--) {
+      swap(vect, j, j - 1);
+    }
+  }
+}
+
+static void heapsort(mu_vect_t *vect, mu_vect_cmp_fn cmp) {
+  heapify(vect, cmp);
+  size_t end = mu_vect_count(vect) - 1;
+  while (end > 0) {
+    swap(vect, end, 0);
+    end -= 1;
+    sift_down(vect, cmp, 0, end);
+  }
+}
+
 static void heapify(mu_vect_t *vect, mu_vect_cmp_fn cmp) {
   int count = mu_vect_count(vect);
   int start = (count - 2) / 2; // index of last parent node
@@ -259,13 +407,29 @@ static void sift_down(mu_vect_t *vect, mu_vect_cmp_fn cmp, int start, int end) {
 }
 
 static void swap(mu_vect_t *vect, int a, int b) {
-  char temp;
+  char temp[16];
   char *pa = (char *)ref(vect, a);
   char *pb = (char *)ref(vect, b);
+  size_t remaining = mu_vect_element_size(vect);
+
+  // exchange in chunks so that memcpy can move whole words
+  while (remaining > 0) {
+    size_t n = (remaining < sizeof(temp)) ? remaining : sizeof(temp);
+    memcpy(temp, pa, n);
+    memcpy(pa, pb, n);
+    memcpy(pb, temp, n);
+    pa += n;
+    pb += n;
+    remaining -= n;
+  }
+}
+
+static int sort_depth(size_t count) {
+  int depth = 0;
 
-  for (size_t i=0; i<mu_vect_element_size(vect); i++) {
-    temp = pa[i];
-    pa[i] = pb[i];
-    pb[i] = temp;
+  while (count > 1) {
+    depth += 2;
+    count >>= 1;
   }
+  return depth;
 }
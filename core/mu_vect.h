@@ -34,6 +34,7 @@ extern "C" {
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 
 // =============================================================================
 // types and definitions
@@ -56,6 +57,11 @@ typedef int (*mu_vect_cmp_fn)(void *e1, void *e2);
  */
 typedef void *(*mu_vect_find_fn)(void *e, void *arg);
 
+/**
+ * @brief Signature of a predicate function.
+ */
+typedef bool (*mu_vect_pred_fn)(void *e, void *arg);
+
 typedef enum {
   MU_VECT_ERR_NONE,
   MU_VECT_ERR_EMPTY,
@@ -64,6 +70,150 @@ typedef enum {
   MU_VECT_ERR_NOT_FOUND,
 } mu_vect_err_t;
 
+/**
+ * @brief Define a mu_vect specialized for one element type.
+ *
+ * A mu_vect_t records its element size at runtime, so every access multiplies
+ * by it and every copy is a memcpy() of unknown length.
+ * MU_VECT_DEFINE(name, type) generates a name_t vector with the same semantics
+ * and error codes as mu_vect, but whose elements are a `type *`: a push of a
+ * small struct compiles to a few stores, and loops over name_elements() can be
+ * unrolled or vectorized by the compiler.  Elements are passed by value.
+ *
+ *     typedef struct { uint16_t channel; int16_t value; } sample_t;
+ *     MU_VECT_DEFINE(sample_vect, sample_t)
+ *
+ *     static sample_t s_sample_store[32];
+ *     static sample_vect_t s_samples;
+ *
+ *     sample_vect_init(&s_samples, s_sample_store, 32);
+ *     sample_vect_push(&s_samples, (sample_t){.channel = 2, .value = v});
+ *
+ * The generated functions are static inline, so MU_VECT_DEFINE() may appear in
+ * a header shared by several files.  They are:
+ *
+ *     name_t *name_init(name_t *v, type *elements, size_t capacity);
+ *     name_t *name_reset(name_t *v);
+ *     type *name_elements(name_t *v);
+ *     size_t name_capacity(name_t *v);
+ *     size_t name_count(name_t *v);
+ *     bool name_is_empty(name_t *v);
+ *     bool name_is_full(name_t *v);
+ *     type *name_ref(name_t *v, size_t index);
+ *     mu_vect_err_t name_peek(name_t *v, type *e);
+ *     mu_vect_err_t name_insert_at(name_t *v, size_t index, type e);
+ *     mu_vect_err_t name_push(name_t *v, type e);
+ *     mu_vect_err_t name_delete_at(name_t *v, size_t index, type *e);
+ *     mu_vect_err_t name_pop(name_t *v, type *e);
+ *
+ * As with mu_vect, e may be NULL for peek, delete_at and pop.
+ */
+#define MU_VECT_DEFINE(_name, _type)                                           \
+  typedef struct {                                                             \
+    _type *elements;                                                           \
+    size_t capacity;                                                           \
+    size_t count;                                                              \
+  } _name##_t;                                                                 \
+                                                                               \
+  static inline _name##_t *_name##_reset(_name##_t *v) {                       \
+    memset(v->elements, 0, v->capacity * sizeof(_type));                       \
+    v->count = 0;                                                              \
+    return v;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline _name##_t *_name##_init(_name##_t *v,                          \
+                                        _type *elements,                       \
+                                        size_t capacity) {                     \
+    v->elements = elements;                                                    \
+    v->capacity = capacity;                                                    \
+    return _name##_reset(v);                                                   \
+  }                                                                            \
+                                                                               \
+  static inline _type *_name##_elements(_name##_t *v) { return v->elements; }  \
+                                                                               \
+  static inline size_t _name##_capacity(_name##_t *v) { return v->capacity; }  \
+                                                                               \
+  static inline size_t _name##_count(_name##_t *v) { return v->count; }        \
+                                                                               \
+  static inline bool _name##_is_empty(_name##_t *v) { return v->count == 0; }  \
+                                                                               \
+  static inline bool _name##_is_full(_name##_t *v) {                           \
+    return v->count == v->capacity;                                            \
+  }                                                                            \
+                                                                               \
+  static inline _type *_name##_ref(_name##_t *v, size_t index) {               \
+    return (index < v->count) ? &v->elements[index] : NULL;                    \
+  }                                                                            \
+                                                                               \
+  static inline mu_vect_err_t _name##_peek(_name##_t *v, _type *e) {           \
+    if (v->count == 0) {                                                       \
+      return MU_VECT_ERR_EMPTY;                                                \
+    }                                                                          \
+    if (e) {                                                                   \
+      *e = v->elements[v->count - 1];                                          \
+    }                                                                          \
+    return MU_VECT_ERR_NONE;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline mu_vect_err_t _name##_insert_at(_name##_t *v,                  \
+                                                size_t index,                  \
+                                                _type e) {                     \
+    if (v->count == v->capacity) {                                             \
+      return MU_VECT_ERR_FULL;                                                 \
+    }                                                                          \
+    if (index > v->count) {                                                    \
+      return MU_VECT_ERR_INDEX;                                                \
+    }                                                                          \
+    if (index < v->count) {                                                    \
+      memmove(&v->elements[index + 1],                                         \
+              &v->elements[index],                                             \
+              (v->count - index) * sizeof(_type));                             \
+    }                                                                          \
+    v->elements[index] = e;                                                    \
+    v->count += 1;                                                             \
+    return MU_VECT_ERR_NONE;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline mu_vect_err_t _name##_push(_name##_t *v, _type e) {            \
+    if (v->count == v->capacity) {                                             \
+      return MU_VECT_ERR_FULL;                                                 \
+    }                                                                          \
+    v->elements[v->count++] = e;                                               \
+    return MU_VECT_ERR_NONE;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline mu_vect_err_t _name##_delete_at(_name##_t *v,                  \
+                                                size_t index,                  \
+                                                _type *e) {                    \
+    if (v->count == 0) {                                                       \
+      return MU_VECT_ERR_EMPTY;                                                \
+    }                                                                          \
+    if (index >= v->count) {                                                   \
+      return MU_VECT_ERR_INDEX;                                                \
+    }                                                                          \
+    if (e) {                                                                   \
+      *e = v->elements[index];                                                 \
+    }                                                                          \
+    if (index + 1 < v->count) {                                                \
+      memmove(&v->elements[index],                                             \
+              &v->elements[index + 1],                                         \
+              (v->count - index - 1) * sizeof(_type));                         \
+    }                                                                          \
+    v->count -= 1;                                                             \
+    return MU_VECT_ERR_NONE;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline mu_vect_err_t _name##_pop(_name##_t *v, _type *e) {            \
+    if (v->count == 0) {                                                       \
+      return MU_VECT_ERR_EMPTY;                                                \
+    }                                                                          \
+    v->count -= 1;                                                             \
+    if (e) {                                                                   \
+      *e = v->elements[v->count];                                              \
+    }                                                                          \
+    return MU_VECT_ERR_NONE;                                                   \
+  }
+
 // =============================================================================
 // declarations
 
@@ -238,12 +388,37 @@ mu_vect_err_t mu_vect_pop(mu_vect_t *vect, void *e);
  */
 mu_vect_err_t mu_vect_insert_sorted(mu_vect_t *vect, void *e, mu_vect_cmp_fn cmp);
 
+/**
+ * @brief Insert a batch of elements into a sorted mu_vect.
+ *
+ * Equivalent to calling mu_vect_insert_sorted() for each of the n elements,
+ * but linear rather than quadratic in the size of the mu_vect: the batch is
+ * sorted (in place, so its order is not preserved) and then merged into the
+ * mu_vect in a single backwards pass, moving each existing element at most
+ * once.  As with mu_vect_insert_sorted(), the mu_vect must already be sorted,
+ * and a new element is placed after any existing elements that compare equal
+ * to it.
+ *
+ * @param mu_vect The mu_vect structure.
+ * @param elements Array of n elements to insert.  Reordered by the call.
+ * @param n The number of elements to insert.
+ * @param cmp The user supplied comparison function.
+ * @return MU_VECT_ERR_FULL (and nothing is inserted) if there is not room for
+ *         all n elements, MU_VECT_ERR_NONE otherwise.
+ */
+mu_vect_err_t mu_vect_insert_sorted_n(mu_vect_t *vect,
+                                      void *elements,
+                                      size_t n,
+                                      mu_vect_cmp_fn cmp);
+
 /**
  * @brief In-place sorting of a elements in a mu_vect.
  *
- * mu_vect_sort() performs an in-place heapsort on its elements according to
- * a user-supplied comparison function.  The heapsort operation is O(log N)
- * with very low overhead.
+ * mu_vect_sort() performs an in-place introsort on its elements according to
+ * a user-supplied comparison function: already sorted input is detected in
+ * one pass, nearly sorted input is finished by insertion sort in close to
+ * linear time, and the worst case is O(N log N).  The sort is not stable.
+ * See mu_sort.h for sorts that inline the comparison for a given type.
  *
  * The user-supplied comparison function is called with two void * arguments,
  * and should return an integer less than, equal to, or greater than zero if
@@ -256,6 +431,19 @@ mu_vect_err_t mu_vect_insert_sorted(mu_vect_t *vect, void *e, mu_vect_cmp_fn cmp
  */
 mu_vect_err_t mu_vect_sort(mu_vect_t *vect, mu_vect_cmp_fn cmp);
 
+/**
+ * @brief Delete every element for which pred returns true.
+ *
+ * The remaining elements keep their order.  The mu_vect is compacted in a
+ * single pass, moving each surviving element at most once.
+ *
+ * @param mu_vect The mu_vect structure.
+ * @param pred The user-supplied predicate, called once per element, in order.
+ * @param arg Passed as the second argument to pred.
+ * @return The number of elements deleted.
+ */
+size_t mu_vect_delete_if(mu_vect_t *vect, mu_vect_pred_fn pred, void *arg);
+
 /**
  * @brief Traverse the mu_vect with a user-supplied function.
  *
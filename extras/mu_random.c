@@ -26,7 +26,9 @@
 // Includes
 
 #include "mu_random.h"
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 // =============================================================================
 // Local types and definitions
@@ -34,9 +36,25 @@
 #define RAND_A ((uint32_t)1103515245)
 #define RAND_C ((uint32_t)12345)
 
+#define PCG32_MULTIPLIER 6364136223846793005ull
+
 // =============================================================================
 // Local (forward) declarations
 
+// Map a 32 bit random value onto [0, range) without bias (Lemire, "Fast
+// Random Integer Generation in an Interval", 2019).  Draws further values
+// through next(ctx) on the rare occasions that the first one is rejected.
+static uint32_t lemire_reduce(uint32_t x,
+                              uint32_t range,
+                              uint32_t (*next)(void *ctx),
+                              void *ctx);
+
+static uint32_t pcg32_next_fn(void *ctx);
+
+static uint32_t xorshift128p_next32(void *ctx);
+
+static uint64_t splitmix64(uint64_t *state);
+
 // =============================================================================
 // Local storage
 
@@ -51,12 +69,145 @@ uint32_t mu_random(void) {
 }
 
 uint32_t mu_random_range(uint32_t min, uint32_t max) {
-  return min + (mu_random() % (max - min));
+  // mu_random() yields 31 bits: scale them onto the range
+  return min + (uint32_t)(((uint64_t)mu_random() * (max - min)) >> 31);
 }
 
 void mu_random_seed(uint32_t seed) {
   s_random_seed = seed;
 }
 
+mu_random_pcg32_t *mu_random_pcg32_init(mu_random_pcg32_t *rng,
+                                        uint64_t seed,
+                                        uint64_t stream) {
+  // the reference pcg32_srandom_r() sequence
+  rng->state = 0;
+  rng->inc = (stream << 1) | 1;
+  mu_random_pcg32_next(rng);
+  rng->state += seed;
+  mu_random_pcg32_next(rng);
+  return rng;
+}
+
+uint32_t mu_random_pcg32_next(mu_random_pcg32_t *rng) {
+  uint64_t old = rng->state;
+  uint32_t xorshifted;
+  uint32_t rot;
+
+  rng->state = old * PCG32_MULTIPLIER + rng->inc;
+  // output permutation XSH RR: xorshift high bits, then a random rotation
+  xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+  rot = (uint32_t)(old >> 59);
+  return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+uint32_t mu_random_pcg32_range(mu_random_pcg32_t *rng,
+                               uint32_t min,
+                               uint32_t max) {
+  if (max <= min) {
+    return min;
+  }
+  return min + lemire_reduce(mu_random_pcg32_next(rng), max - min,
+                             pcg32_next_fn, rng);
+}
+
+void mu_random_pcg32_fill(mu_random_pcg32_t *rng, void *buf, size_t n) {
+  uint8_t *p = (uint8_t *)buf;
+
+  while (n >= sizeof(uint32_t)) {
+    uint32_t r = mu_random_pcg32_next(rng);
+    memcpy(p, &r, sizeof(r));
+    p += sizeof(r);
+    n -= sizeof(r);
+  }
+  if (n > 0) {
+    uint32_t r = mu_random_pcg32_next(rng);
+    memcpy(p, &r, n);
+  }
+}
+
+mu_random_xorshift128p_t *mu_random_xorshift128p_init(
+    mu_random_xorshift128p_t *rng,
+    uint64_t seed) {
+  // SplitMix64 never yields two consecutive zeros, so the state is non-zero.
+  rng->s[0] = splitmix64(&seed);
+  rng->s[1] = splitmix64(&seed);
+  return rng;
+}
+
+uint64_t mu_random_xorshift128p_next(mu_random_xorshift128p_t *rng) {
+  uint64_t s1 = rng->s[0];
+  const uint64_t s0 = rng->s[1];
+  uint64_t result = s0 + s1;
+
+  rng->s[0] = s0;
+  s1 ^= s1 << 23;
+  rng->s[1] = s1 ^ s0 ^ (s1 >> 18) ^ (s0 >> 5);
+  return result;
+}
+
+uint32_t mu_random_xorshift128p_range(mu_random_xorshift128p_t *rng,
+                                      uint32_t min,
+                                      uint32_t max) {
+  if (max <= min) {
+    return min;
+  }
+  return min + lemire_reduce(xorshift128p_next32(rng), max - min,
+                             xorshift128p_next32, rng);
+}
+
+void mu_random_xorshift128p_fill(mu_random_xorshift128p_t *rng,
+                                 void *buf,
+                                 size_t n) {
+  uint8_t *p = (uint8_t *)buf;
+
+  while (n >= sizeof(uint64_t)) {
+    uint64_t r = mu_random_xorshift128p_next(rng);
+    memcpy(p, &r, sizeof(r));
+    p += sizeof(r);
+    n -= sizeof(r);
+  }
+  if (n > 0) {
+    uint64_t r = mu_random_xorshift128p_next(rng);
+    memcpy(p, &r, n);
+  }
+}
+
 // =============================================================================
 // Local (static) code
+
+static uint32_t lemire_reduce(uint32_t x,
+                              uint32_t range,
+                              uint32_t (*next)(void *ctx),
+                              void *ctx) {
+  uint64_t m = (uint64_t)x * range;
+  uint32_t low = (uint32_t)m;
+
+  if (low < range) {
+    // Only here, with probability range / 2^32, is a division needed: reject
+    // the values that would make some results more likely than others.
+    uint32_t threshold = (0u - range) % range;
+    while (low < threshold) {
+      m = (uint64_t)next(ctx) * range;
+      low = (uint32_t)m;
+    }
+  }
+  return (uint32_t)(m >> 32);
+}
+
+static uint32_t pcg32_next_fn(void *ctx) {
+  return mu_random_pcg32_next((mu_random_pcg32_t *)ctx);
+}
+
+static uint32_t xorshift128p_next32(void *ctx) {
+  // the high bits of xorshift128+ are the stronger ones
+  return (uint32_t)(mu_random_xorshift128p_next(
+                        (mu_random_xorshift128p_t *)ctx) >> 32);
+}
+
+static uint64_t splitmix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
@@ -32,11 +32,37 @@ extern "C" {
 // =============================================================================
 // Includes
 
+#include <stddef.h>
 #include <stdint.h>
 
 // =============================================================================
 // Types and definitions
 
+/**
+ * mu_random() and friends share one global seed, so an interrupt handler and
+ * a task that both draw numbers disturb each other's sequences, and the LCG
+ * behind them yields only 31 bits of modest quality.  The engines below keep
+ * their state in a caller-supplied struct instead:
+ *
+ * * PCG32 (O'Neill): 64 bits of state, 32 bits of output per step, and
+ *   independent streams selected at init time.  A good default.
+ * * xorshift128+ (Vigna): 128 bits of state, 64 bits of output per step using
+ *   only shifts, XORs and one add.  The fastest way to fill large buffers.
+ *
+ * Each engine has a _range() function that maps its output onto [min, max)
+ * without bias using Lemire's multiply-shift method, which divides only on
+ * the rare rejection path, and a _fill() function that writes n random bytes.
+ */
+
+typedef struct {
+  uint64_t state; // advanced by the LCG step
+  uint64_t inc;   // stream selector: always odd
+} mu_random_pcg32_t;
+
+typedef struct {
+  uint64_t s[2]; // never all zero
+} mu_random_xorshift128p_t;
+
 // =============================================================================
 // Declarations
 
@@ -50,6 +76,9 @@ uint32_t mu_random(void);
 /**
  * @brief Return a random integer between min (inclusive) and max (exclusive).
  *
+ * The result is scaled with a multiply and shift rather than a modulo, so no
+ * division is needed.  For unbiased results use one of the engines below.
+ *
  * @param min The minimum (inclusive) value to return.
  * @param max The maximum (exclusive) value to return.
  * @return A pseudo random integer between min (inclusive) and max (exclusive).
@@ -63,6 +92,73 @@ uint32_t mu_random_range(uint32_t min, uint32_t max);
  */
 void mu_random_seed(uint32_t seed);
 
+/**
+ * @brief Initialize a PCG32 generator.
+ *
+ * Generators with the same seed but different streams produce unrelated
+ * sequences.
+ *
+ * @param rng The generator state to initialize.
+ * @param seed The starting state.
+ * @param stream Selects one of 2^63 independent sequences.
+ * @return rng
+ */
+mu_random_pcg32_t *mu_random_pcg32_init(mu_random_pcg32_t *rng,
+                                        uint64_t seed,
+                                        uint64_t stream);
+
+/**
+ * @brief Return the next 32 bit output of a PCG32 generator.
+ */
+uint32_t mu_random_pcg32_next(mu_random_pcg32_t *rng);
+
+/**
+ * @brief Return an unbiased integer between min (inclusive) and max
+ * (exclusive) from a PCG32 generator.  Returns min if max <= min.
+ */
+uint32_t mu_random_pcg32_range(mu_random_pcg32_t *rng,
+                               uint32_t min,
+                               uint32_t max);
+
+/**
+ * @brief Fill n bytes at buf from a PCG32 generator.
+ */
+void mu_random_pcg32_fill(mu_random_pcg32_t *rng, void *buf, size_t n);
+
+/**
+ * @brief Initialize an xorshift128+ generator.
+ *
+ * The seed is expanded into the 128 bit state with SplitMix64, so any seed
+ * (including zero) is acceptable.
+ *
+ * @param rng The generator state to initialize.
+ * @param seed The seed.
+ * @return rng
+ */
+mu_random_xorshift128p_t *mu_random_xorshift128p_init(
+    mu_random_xorshift128p_t *rng,
+    uint64_t seed);
+
+/**
+ * @brief Return the next 64 bit output of an xorshift128+ generator.
+ */
+uint64_t mu_random_xorshift128p_next(mu_random_xorshift128p_t *rng);
+
+/**
+ * @brief Return an unbiased integer between min (inclusive) and max
+ * (exclusive) from an xorshift128+ generator.  Returns min if max <= min.
+ */
+uint32_t mu_random_xorshift128p_range(mu_random_xorshift128p_t *rng,
+                                      uint32_t min,
+                                      uint32_t max);
+
+/**
+ * @brief Fill n bytes at buf from an xorshift128+ generator.
+ */
+void mu_random_xorshift128p_fill(mu_random_xorshift128p_t *rng,
+                                 void *buf,
+                                 size_t n);
+
 #ifdef __cplusplus
 }
 #endif
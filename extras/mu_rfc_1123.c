@@ -76,25 +76,60 @@
 #define TM_FIELD_LARGE int16_t
 #endif
 
+// Length of "Tue, 18 Jun 2019 16:06:21 GMT"
+#define RFC_1123_LEN (MU_RFC_1123_MAX_LEN - 1)
+
+#define EPOCH_YEAR 1970
+#define EPOCH_MAX_YEAR 2105 // last full year representable in a uint32_t
+#define EPOCH_WDAY 4        // 1 Jan 1970 was a Thursday
+#define SECONDS_PER_DAY 86400ul
+
+typedef struct {
+  uint16_t year;
+  uint8_t mon;  // 0-11
+  uint8_t mday; // 1-31
+  uint8_t wday; // 0-6, Sunday = 0
+  uint8_t hour;
+  uint8_t min;
+  uint8_t sec;
+} fields_t;
+
 // =============================================================================
 // Local (forward) declarations
 
-// tokens is a denseely packed string of tokens, where each token is token_len
-// characters long.  If s equals the Nth token, set dst to N (by reference)
-// and return s incremented by token_len.  else return NULL
-static const char *parse_tokens(const char *s, TM_FIELD_SMALL *dst, const char *tokens, int token_len);
+// Check s against the fixed 29 byte RFC 1123 layout in a single pass, map the
+// day and month names through perfect hashes and decode the numeric fields.
+// Return s + 29 on success, NULL if any byte does not fit the layout.  Stops at
+// the first mismatch, so never reads past a null terminator.
+static const char *parse_fields(const char *s, fields_t *fields);
+
+// Return the index of the three character token at s within tokens (which
+// holds 3-character tokens back to back), or -1.  hash_table maps a token's
+// hash to 1 + its index, or 0 for no token.
+static int lookup_token(const char *s,
+                        const char *tokens,
+                        const uint8_t *hash_table,
+                        uint8_t hash);
+
+static uint8_t month_hash(const char *s);
+
+static uint8_t day_hash(const char *s);
+
+static bool is_leap_year(uint16_t year);
+
+// Days from 1 Jan 1970 to the given date (mon is 0-11).
+static uint32_t days_since_epoch(uint16_t year, uint8_t mon, uint8_t mday);
 
-// parse N digits as a base-10 number and return it by reference in dst, then
-// return s incremented by n_digits.  Return NULL if s does not contain digits.
-static const char *parse_int_small(const char *s, TM_FIELD_SMALL *dst, int n_digits);
+// Write the layout and the day name, day, month and year for the given number
+// of days since 1 Jan 1970 into s, which must hold MU_RFC_1123_MAX_LEN bytes.
+// The time fields are left for render_time().
+static void render_date(char *s, uint32_t days);
 
-// parse N digits as a base-10 number and return it by reference in dst, then
-// return s incremented by n_digits.  Return NULL if s does not contain digits.
-static const char *parse_int_large(const char *s, TM_FIELD_LARGE *dst, int n_digits);
+// Write hours, minutes and seconds for the given second of the day into s.
+static void render_time(char *s, uint32_t second_of_day);
 
-// Skip over the given literal, return s incremented by strlen(literal), else
-// return NULL if s does not match literal.
-static const char *skip_literal(const char *s, const char *literal);
+// Write v (0-99) as two decimal digits at s.
+static void put_2_digits(char *s, uint8_t v);
 
 // =============================================================================
 // Local storage
@@ -102,27 +137,62 @@ static const char *skip_literal(const char *s, const char *literal);
 static const char *const s_months = "JanFebMarAprMayJunJulAugSepOctNovDec";
 static const char *const s_days = "SunMonTueWedThuFriSat";
 
+// One character per byte of an RFC 1123 date: '0' marks a digit, '_' a letter
+// of the day or month name, anything else must match exactly.
+static const char s_layout[] = "___, 00 ___ 0000 00:00:00 GMT";
+
+// month_hash() of each month name maps to 1 + the month's index (found by
+// exhaustive search: the hash is collision-free over the twelve names).
+static const uint8_t s_month_table[16] = {
+    0, 5, 8, 0, 12, 4, 9, 10, 7, 6, 11, 2, 0, 3, 0, 1};
+
+// Likewise for day_hash() and the seven day names.
+static const uint8_t s_day_table[8] = {6, 5, 0, 2, 3, 7, 1, 4};
+
+static const uint16_t s_days_before_month[12] = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+static const uint8_t s_days_in_month[12] = {
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
 // =============================================================================
 // Public code
 
 const char *mu_rfc_1123_str_to_tm(const char *s, struct tm *tm) {
+  fields_t fields;
+
   memset(tm, 0, sizeof(struct tm));
-  if (!(s = parse_tokens(s, &tm->tm_wday, s_days, 3))) return NULL;
-  if (!(s = skip_literal(s, ", "))) return NULL;
-  if (!(s = parse_int_small(s, &tm->tm_mday, 2))) return NULL;
-  if (!(s = skip_literal(s, " "))) return NULL;
-  if (!(s = parse_tokens(s, &tm->tm_mon, s_months, 3))) return NULL;
-  if (!(s = skip_literal(s, " "))) return NULL;
-  if (!(s = parse_int_large(s, &tm->tm_year, 4))) return NULL;
+  if (!(s = parse_fields(s, &fields))) return NULL;
+  tm->tm_wday = fields.wday;
+  tm->tm_mday = fields.mday;
+  tm->tm_mon = fields.mon;
   // want year - 1900
-  tm->tm_year -= TM_YEAR_OFFSET;
-  if (!(s = skip_literal(s, " "))) return NULL;
-  if (!(s = parse_int_small(s, &tm->tm_hour, 2))) return NULL;
-  if (!(s = skip_literal(s, ":"))) return NULL;
-  if (!(s = parse_int_small(s, &tm->tm_min, 2))) return NULL;
-  if (!(s = skip_literal(s, ":"))) return NULL;
-  if (!(s = parse_int_small(s, &tm->tm_sec, 2))) return NULL;
-  if (!(s = skip_literal(s, " GMT"))) return NULL;
+  tm->tm_year = (TM_FIELD_LARGE)fields.year - TM_YEAR_OFFSET;
+  tm->tm_hour = fields.hour;
+  tm->tm_min = fields.min;
+  tm->tm_sec = fields.sec;
+  return s;
+}
+
+const char *mu_rfc_1123_str_to_epoch(const char *s, uint32_t *epoch) {
+  fields_t fields;
+  uint8_t days_in_month;
+  uint32_t days;
+
+  if (!(s = parse_fields(s, &fields))) return NULL;
+  if (fields.year < EPOCH_YEAR || fields.year > EPOCH_MAX_YEAR) return NULL;
+  days_in_month = s_days_in_month[fields.mon];
+  if (fields.mon == 1 && is_leap_year(fields.year)) {
+    days_in_month += 1;
+  }
+  if (fields.mday < 1 || fields.mday > days_in_month) return NULL;
+  // allow a leap second
+  if (fields.hour > 23 || fields.min > 59 || fields.sec > 60) return NULL;
+  days = days_since_epoch(fields.year, fields.mon, fields.mday);
+  if ((days + EPOCH_WDAY) % 7 != fields.wday) return NULL;
+
+  *epoch = days * SECONDS_PER_DAY + fields.hour * 3600ul + fields.min * 60ul +
+           fields.sec;
   return s;
 }
 
@@ -140,56 +210,151 @@ char *mu_rfc_1123_tm_to_str(const struct tm *tm, char *s, int maxlen) {
   return s;
 }
 
+char *mu_rfc_1123_epoch_to_str(uint32_t epoch, char *s, int maxlen) {
+  if (maxlen < MU_RFC_1123_MAX_LEN) {
+    return NULL;
+  }
+  render_date(s, epoch / SECONDS_PER_DAY);
+  render_time(s, epoch % SECONDS_PER_DAY);
+  return s;
+}
+
+mu_rfc_1123_cache_t *mu_rfc_1123_cache_init(mu_rfc_1123_cache_t *cache) {
+  cache->epoch = 0;
+  cache->valid = false;
+  cache->str[0] = '\0';
+  return cache;
+}
+
+const char *mu_rfc_1123_cache_format(mu_rfc_1123_cache_t *cache,
+                                     uint32_t epoch) {
+  uint32_t prev = cache->epoch;
+
+  if (cache->valid && epoch == prev) {
+    return cache->str;
+  }
+  if (!cache->valid || (epoch / SECONDS_PER_DAY != prev / SECONDS_PER_DAY)) {
+    mu_rfc_1123_epoch_to_str(epoch, cache->str, MU_RFC_1123_MAX_LEN);
+    cache->valid = true;
+  } else {
+    // Same day: rewrite only the fields that changed.
+    if (epoch / 60 != prev / 60) {
+      if (epoch / 3600 != prev / 3600) {
+        put_2_digits(&cache->str[17], (epoch % SECONDS_PER_DAY) / 3600);
+      }
+      put_2_digits(&cache->str[20], (epoch / 60) % 60);
+    }
+    put_2_digits(&cache->str[23], epoch % 60);
+  }
+  cache->epoch = epoch;
+  return cache->str;
+}
+
 // =============================================================================
 // Local (static) code
 
-static const char *parse_tokens(const char *s, TM_FIELD_SMALL *dst, const char *tokens, int token_len) {
-  size_t tokens_length = strlen(tokens);
-  for (size_t i = 0; i < tokens_length; i += token_len) {
-    if (strncmp(s, &tokens[i], token_len) == 0) {
-      *dst = i / token_len;
-      return s + token_len;
+static const char *parse_fields(const char *s, fields_t *fields) {
+  int wday, mon;
+
+  for (int i = 0; i < RFC_1123_LEN; i++) {
+    char ch = s[i];
+    char expect = s_layout[i];
+    if (expect == '0') {
+      if ((uint8_t)(ch - '0') > 9) return NULL;
+    } else if (expect == '_') {
+      if (ch == '\0') return NULL;
+    } else if (ch != expect) {
+      return NULL;
     }
   }
-  // ran off end without a match
-  return NULL;
-}
-
-static const char *parse_int_small(const char *s, TM_FIELD_SMALL *dst, int n_digits) {
-	*dst = 0;
-
-	for (int i = 0; i < n_digits; i++) {
-		char ch = s[i];
-		if ((ch >= '0') && (ch <= '9')) {
-			*dst = (*dst * 10) + (ch - '0');
-			} else {
-			return NULL;
-		}
-	}
-	return s + n_digits;
-}
-
-static const char *parse_int_large(const char *s, TM_FIELD_LARGE *dst, int n_digits) {
-	*dst = 0;
-
-	for (int i = 0; i < n_digits; i++) {
-		char ch = s[i];
-		if ((ch >= '0') && (ch <= '9')) {
-			*dst = (*dst * 10) + (ch - '0');
-			} else {
-			return NULL;
-		}
-	}
-	return s + n_digits;
-}
-
-static const char *skip_literal(const char *s, const char *literal) {
-  int literal_len = strlen(literal);
-  if (strncmp(s, literal, literal_len) == 0) {
-    return s + literal_len;
-  } else {
+  if ((wday = lookup_token(&s[0], s_days, s_day_table, day_hash(&s[0]))) < 0) {
     return NULL;
   }
+  if ((mon = lookup_token(&s[8], s_months, s_month_table, month_hash(&s[8]))) <
+      0) {
+    return NULL;
+  }
+
+#define DIGIT(_i) ((uint8_t)(s[_i] - '0'))
+  fields->wday = wday;
+  fields->mday = DIGIT(5) * 10 + DIGIT(6);
+  fields->mon = mon;
+  fields->year =
+      DIGIT(12) * 1000 + DIGIT(13) * 100 + DIGIT(14) * 10 + DIGIT(15);
+  fields->hour = DIGIT(17) * 10 + DIGIT(18);
+  fields->min = DIGIT(20) * 10 + DIGIT(21);
+  fields->sec = DIGIT(23) * 10 + DIGIT(24);
+#undef DIGIT
+  return s + RFC_1123_LEN;
+}
+
+static int lookup_token(const char *s,
+                        const char *tokens,
+                        const uint8_t *hash_table,
+                        uint8_t hash) {
+  int index = hash_table[hash] - 1;
+  // the hash only narrows it down to one candidate: confirm the match
+  if (index < 0 || strncmp(s, &tokens[index * 3], 3) != 0) {
+    return -1;
+  }
+  return index;
+}
+
+static uint8_t month_hash(const char *s) {
+  return ((((uint8_t)s[0] << 3) + (uint8_t)s[1] + (uint8_t)s[2]) >> 1) & 0x0f;
+}
+
+static uint8_t day_hash(const char *s) {
+  return (((uint8_t)s[0] + (uint8_t)s[1] + ((uint8_t)s[2] << 3)) >> 2) & 0x07;
+}
+
+static bool is_leap_year(uint16_t year) {
+  return (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+}
+
+static uint32_t days_since_epoch(uint16_t year, uint8_t mon, uint8_t mday) {
+  // leap days in the years before `year`, less those before 1970
+  uint32_t y = year - 1;
+  uint32_t leap_days = (y / 4 - y / 100 + y / 400) - 477;
+  uint32_t days = (uint32_t)(year - EPOCH_YEAR) * 365 + leap_days +
+                  s_days_before_month[mon] + mday - 1;
+
+  if (mon > 1 && is_leap_year(year)) {
+    days += 1;
+  }
+  return days;
+}
+
+static void render_date(char *s, uint32_t days) {
+  // Civil date from a day count (after Howard Hinnant's civil_from_days),
+  // computed in eras of 400 years counted from 1 Mar 0000.
+  uint32_t z = days + 719468;
+  uint32_t era = z / 146097;
+  uint32_t doe = z - era * 146097; // day of era [0, 146096]
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100); // from 1 Mar
+  uint32_t mp = (5 * doy + 2) / 153;                 // month from March
+  uint32_t mday = doy - (153 * mp + 2) / 5 + 1;      // [1, 31]
+  uint32_t mon = (mp < 10) ? mp + 2 : mp - 10;       // [0, 11]
+  uint32_t year = yoe + era * 400 + (mon <= 1);
+
+  memcpy(s, "Xxx, 00 Xxx 0000 00:00:00 GMT", MU_RFC_1123_MAX_LEN);
+  memcpy(&s[0], &s_days[((days + EPOCH_WDAY) % 7) * 3], 3);
+  put_2_digits(&s[5], mday);
+  memcpy(&s[8], &s_months[mon * 3], 3);
+  put_2_digits(&s[12], year / 100);
+  put_2_digits(&s[14], year % 100);
+}
+
+static void render_time(char *s, uint32_t second_of_day) {
+  put_2_digits(&s[17], second_of_day / 3600);
+  put_2_digits(&s[20], (second_of_day / 60) % 60);
+  put_2_digits(&s[23], second_of_day % 60);
+}
+
+static void put_2_digits(char *s, uint8_t v) {
+  s[0] = '0' + v / 10;
+  s[1] = '0' + v % 10;
 }
 
 // =============================================================================
@@ -232,9 +397,52 @@ int main(void) {
   ASSERT(mu_rfc_1123_str_to_tm("Tue, 18 Jun 2019 16:06:21 GMx", &tm1) == NULL);
   ASSERT(mu_rfc_1123_str_to_tm("Tue, 18 Jun 2019 16x06:21 GMT", &tm1) == NULL);
 
+  ASSERT(mu_rfc_1123_str_to_tm("Tue, 18 Jun 2019 16:06:2", &tm1) == NULL);
+
+  uint32_t epoch;
+  ASSERT((s = mu_rfc_1123_str_to_epoch(s2, &epoch)) == s2 + strlen(s2));
+  ASSERT(epoch == 1560873981);
+  ASSERT(mu_rfc_1123_str_to_epoch("Thu, 01 Jan 1970 00:00:00 GMT", &epoch));
+  ASSERT(epoch == 0);
+  ASSERT(mu_rfc_1123_str_to_epoch("Sat, 29 Feb 2020 12:00:00 GMT", &epoch));
+  ASSERT(epoch == 1582977600);
+  ASSERT(mu_rfc_1123_str_to_epoch("Thu, 31 Dec 2105 23:59:59 GMT", &epoch));
+  ASSERT(epoch == 4291747199);
+  ASSERT(mu_rfc_1123_str_to_epoch("Fri, 01 Mar 2019 12:00:00 GMT", &epoch));
+  ASSERT(epoch == 1551441600);
+  // wrong weekday, bad day of month, out of range fields and years
+  ASSERT(mu_rfc_1123_str_to_epoch("Wed, 18 Jun 2019 16:06:21 GMT", &epoch) == NULL);
+  ASSERT(mu_rfc_1123_str_to_epoch("Fri, 29 Feb 2019 12:00:00 GMT", &epoch) == NULL);
+  ASSERT(mu_rfc_1123_str_to_epoch("Tue, 18 Jun 2019 24:06:21 GMT", &epoch) == NULL);
+  ASSERT(mu_rfc_1123_str_to_epoch("Tue, 18 Jun 2019 16:60:21 GMT", &epoch) == NULL);
+  ASSERT(mu_rfc_1123_str_to_epoch("Wed, 31 Dec 1969 23:59:59 GMT", &epoch) == NULL);
+  ASSERT(mu_rfc_1123_str_to_epoch("Tue, 18 jun 2019 16:06:21 GMT", &epoch) == NULL);
+
   ASSERT((s = mu_rfc_1123_str_to_tm(s2, &tm1)) != NULL); // reset tm1
   ASSERT((s = mu_rfc_1123_tm_to_str(&tm1, s1, MU_RFC_1123_MAX_LEN)) != NULL);
   ASSERT(strcmp(s, s2) == 0);
+
+  ASSERT(mu_rfc_1123_epoch_to_str(1560873981, s1, MU_RFC_1123_MAX_LEN) == s1);
+  ASSERT(strcmp(s1, s2) == 0);
+  ASSERT(mu_rfc_1123_epoch_to_str(0, s1, MU_RFC_1123_MAX_LEN) == s1);
+  ASSERT(strcmp(s1, "Thu, 01 Jan 1970 00:00:00 GMT") == 0);
+  ASSERT(mu_rfc_1123_epoch_to_str(1582977600, s1, MU_RFC_1123_MAX_LEN) == s1);
+  ASSERT(strcmp(s1, "Sat, 29 Feb 2020 12:00:00 GMT") == 0);
+  ASSERT(mu_rfc_1123_epoch_to_str(0, s1, MU_RFC_1123_MAX_LEN - 1) == NULL);
+
+  mu_rfc_1123_cache_t cache;
+  mu_rfc_1123_cache_init(&cache);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560873981), s2) == 0);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560873981), s2) == 0);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560873982),
+                "Tue, 18 Jun 2019 16:06:22 GMT") == 0);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560874020),
+                "Tue, 18 Jun 2019 16:07:00 GMT") == 0);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560877200),
+                "Tue, 18 Jun 2019 17:00:00 GMT") == 0);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560873981), s2) == 0);
+  ASSERT(strcmp(mu_rfc_1123_cache_format(&cache, 1560902400),
+                "Wed, 19 Jun 2019 00:00:00 GMT") == 0);
   printf("... mu_rfc_1123 unit test complete.\n");
 }
 
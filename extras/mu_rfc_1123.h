@@ -32,6 +32,8 @@ extern "C" {
 // =============================================================================
 // Includes
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <time.h>  // for struct tm
 
 // =============================================================================
@@ -39,6 +41,16 @@ extern "C" {
 
 #define MU_RFC_1123_MAX_LEN 30  // includes null terminator
 
+/**
+ * @brief State for mu_rfc_1123_cache_format(): the most recently rendered
+ * time and its string.
+ */
+typedef struct {
+  uint32_t epoch;                 // time rendered in str
+  bool valid;                     // false until the first render
+  char str[MU_RFC_1123_MAX_LEN];  // null terminated RFC 1123 string
+} mu_rfc_1123_cache_t;
+
 // =============================================================================
 // Declarations
 
@@ -62,6 +74,24 @@ extern "C" {
  */
 const char *mu_rfc_1123_str_to_tm(const char *s, struct tm *tm);
 
+/**
+ * @brief Parse a date in RFC 1123 format directly into seconds since
+ * 1 Jan 1970 00:00:00 GMT, without going through struct tm and mktime().
+ *
+ * Accepts the same strict layout as mu_rfc_1123_str_to_tm() and additionally
+ * rejects out of range fields (a seconds field of 60 is allowed for leap
+ * seconds), a day of the week that does not match the date, and years
+ * outside 1970 to 2105 (the range of a uint32_t).
+ *
+ * On success, returns a pointer to the first character following "GMT" and
+ * sets *epoch.  On any error, returns NULL and *epoch is not modified.
+ *
+ * @param s Pointer to string to be parsed
+ * @param epoch Receives the number of seconds since the epoch.
+ * @return Pointer to character following "GMT" on success, NULL otherwise.
+ */
+const char *mu_rfc_1123_str_to_epoch(const char *s, uint32_t *epoch);
+
 /**
  * @brief Print the date and time in RFC 1123 format.
  *
@@ -76,6 +106,42 @@ const char *mu_rfc_1123_str_to_tm(const char *s, struct tm *tm);
  */
 char *mu_rfc_1123_tm_to_str(const struct tm *tm, char *s, int maxlen);
 
+/**
+ * @brief Print seconds since 1 Jan 1970 00:00:00 GMT in RFC 1123 format,
+ * without going through struct tm or printf.
+ *
+ * @param epoch Seconds since the epoch.
+ * @param s String buffer to receive the results
+ * @param maxlen Capacity of the string buffer: at least MU_RFC_1123_MAX_LEN.
+ * @return s, or NULL if maxlen is too small.
+ */
+char *mu_rfc_1123_epoch_to_str(uint32_t epoch, char *s, int maxlen);
+
+/**
+ * @brief Initialize a formatting cache.
+ */
+mu_rfc_1123_cache_t *mu_rfc_1123_cache_init(mu_rfc_1123_cache_t *cache);
+
+/**
+ * @brief Return the RFC 1123 string for epoch, reusing the previous result.
+ *
+ * Servers emit a Date header with every response, and the time rarely moves
+ * by more than a second between calls.  The cache keeps the last string and
+ * rewrites only the fields that changed: just the seconds within the same
+ * minute, the minutes and seconds within the same hour and so on, rendering
+ * the date part only when the day changes.  Asking again for the same second
+ * costs nothing, so a Date header becomes a memcpy() of the result.
+ *
+ * The returned string belongs to the cache and changes with the next call.
+ * A cache must not be shared between interrupt and foreground levels.
+ *
+ * @param cache The cache.
+ * @param epoch Seconds since the epoch.
+ * @return The null terminated RFC 1123 string for epoch.
+ */
+const char *mu_rfc_1123_cache_format(mu_rfc_1123_cache_t *cache,
+                                     uint32_t epoch);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,21 +34,32 @@ extern "C" {
 
 #include "mu_config.h"
 
+#include "core/mu_arena.h"
+#include "core/mu_atomic.h"
 #include "core/mu_bvec.h"
 #include "core/mu_cirq.h"
+#include "core/mu_co.h"
 #include "core/mu_dlist.h"
 #include "core/mu_fsm.h"
+#include "core/mu_hmap.h"
 #include "core/mu_list.h"
 #include "core/mu_log.h"
+#include "core/mu_log_token.h"
+#include "core/mu_mpsc.h"
+#include "core/mu_pheap.h"
+#include "core/mu_pool.h"
 #include "core/mu_pstore.h"
 #include "core/mu_queue.h"
 #include "core/mu_sched.h"
+#include "core/mu_sort.h"
 #include "core/mu_spsc.h"
 #include "core/mu_str.h"
+#include "core/mu_str_chain.h"
 #include "core/mu_strbuf.h"
 #include "core/mu_task.h"
 #include "core/mu_thunk.h"
 #include "core/mu_timer.h"
+#include "core/mu_trace.h"
 #include "core/mu_vect.h"
 #include "core/mu_version.h"
 
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Host-side companion to core/mu_log_token.h.
+
+Build a token table from a linked image:
+
+    mu_log_tokens.py table app.elf > tokens.csv
+
+Decode messages (one per line, hex or base64) read from stdin:
+
+    mu_log_tokens.py decode tokens.csv --format base64 < capture.txt
+
+Lines that cannot be decoded are passed through unchanged, so a capture may
+mix tokenized messages with ordinary text.
+"""
+
+import argparse
+import base64
+import binascii
+import csv
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+SECTION = '.mu_log_tokens'
+HASH_LENGTH = 80  # must match MU_LOG_TOKEN_HASH_LENGTH
+HASH_K = 65599
+
+CONVERSION = re.compile(
+    r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<prec>\*|\d*))?'
+    r'(?P<length>hh|h|ll|l|j|z|t|L)?(?P<conv>[diouxXcsfFeEgGaAp%])')
+
+
+def token_of(fmt):
+    """The 65599 hash of a format string, as computed by MU_LOG_TOKEN()."""
+    data = fmt.encode('utf-8')
+    h = len(data)
+    k = HASH_K
+    for c in data[:HASH_LENGTH]:
+        h = (h + c * k) & 0xffffffff
+        k = (k * HASH_K) & 0xffffffff
+    return h
+
+
+def read_section(elf, objcopy):
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, 'tokens.bin')
+        subprocess.run([objcopy, '--dump-section', SECTION + '=' + out, elf,
+                        os.path.join(tmp, 'discard.elf')], check=True)
+        with open(out, 'rb') as f:
+            return f.read()
+
+
+def cmd_table(args):
+    data = read_section(args.elf, args.objcopy)
+    writer = csv.writer(sys.stdout)
+    seen = {}
+    for raw in data.split(b'\0'):
+        if not raw:
+            continue  # alignment padding
+        fmt = raw.decode('utf-8', errors='replace')
+        token = token_of(fmt)
+        if token in seen and seen[token] != fmt:
+            print('warning: token %08x collides: %r and %r' %
+                  (token, seen[token], fmt), file=sys.stderr)
+        if token not in seen:
+            seen[token] = fmt
+            writer.writerow(['%08x' % token, fmt])
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise EOFError
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        value, shift = 0, 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7f) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        return (value >> 1) ^ -(value & 1)  # undo ZigZag
+
+    def float(self):
+        if self.pos + 4 > len(self.data):
+            raise EOFError
+        (f,) = struct.unpack_from('<f', self.data, self.pos)
+        self.pos += 4
+        return f
+
+    def string(self):
+        header = self.byte()
+        n = header & 0x7f
+        s = bytes(self.byte() for _ in range(n)).decode('utf-8', 'replace')
+        return s + ('...' if header & 0x80 else '')
+
+
+def format_message(fmt, reader, long_bits):
+    out = []
+    last = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        conv = m.group('conv')
+        if conv == '%':
+            out.append('%')
+            continue
+        try:
+            width = m.group('width') or ''
+            if width == '*':
+                width = str(reader.varint())
+            prec = m.group('prec')
+            if prec == '*':
+                prec = str(reader.varint())
+            spec = '%' + m.group('flags') + width
+            if prec is not None:
+                spec += '.' + prec
+            length = m.group('length') or ''
+            if conv in 'diouxXc':
+                value = reader.varint()
+                bits = 64 if length in ('ll', 'j') or \
+                    (length in ('l', 'z', 't') and long_bits == 64) else 32
+                if conv in 'ouxX':
+                    value &= (1 << bits) - 1
+                if conv == 'c':
+                    out.append(chr(value & 0xff))
+                else:
+                    out.append((spec + {'i': 'd', 'u': 'd'}.get(conv, conv)) %
+                               value)
+            elif conv == 'p':
+                out.append('0x%x' % (reader.varint() & (1 << 64) - 1))
+            elif conv == 's':
+                out.append((spec + 's') % reader.string())
+            else:
+                value = reader.float()
+                if conv in 'aA':
+                    out.append(float.hex(value))
+                else:
+                    out.append((spec + conv.replace('F', 'f')) % value)
+        except EOFError:
+            out.append('<truncated>')
+            return ''.join(out)
+    out.append(fmt[last:])
+    return ''.join(out)
+
+
+def decode_line(line, fmt, table, long_bits):
+    text = line.strip()
+    try:
+        data = (base64.b64decode(text, validate=True) if fmt == 'base64'
+                else bytes.fromhex(text))
+    except (ValueError, binascii.Error):
+        return None
+    if len(data) < 4:
+        return None
+    (token,) = struct.unpack_from('<I', data)
+    if token not in table:
+        return '<unknown token %08x>' % token
+    return format_message(table[token], Reader(data[4:]), long_bits)
+
+
+def cmd_decode(args):
+    table = {}
+    with open(args.table, newline='') as f:
+        for row in csv.reader(f):
+            if len(row) == 2:
+                table[int(row[0], 16)] = row[1]
+    for line in sys.stdin:
+        text = decode_line(line, args.format, table, args.long_bits)
+        sys.stdout.write((text + '\n') if text is not None else line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='command', required=True)
+    p = sub.add_parser('table', help='extract the token table from an ELF')
+    p.add_argument('elf')
+    p.add_argument('--objcopy', default='objcopy',
+                   help='objcopy for the target, e.g. arm-none-eabi-objcopy')
+    p.set_defaults(fn=cmd_table)
+    p = sub.add_parser('decode', help='decode messages read from stdin')
+    p.add_argument('table')
+    p.add_argument('--format', choices=('hex', 'base64'), default='hex')
+    p.add_argument('--long-bits', type=int, choices=(32, 64), default=32,
+                   help='size of long on the target (default 32)')
+    p.set_defaults(fn=cmd_decode)
+    args = parser.parse_args()
+    args.fn(args)
+
+
+if __name__ == '__main__':
+    main()